@@ -4,6 +4,8 @@
 #include "stdrot.h"
 #include "visitor.h"
 #include "interpreter.h"
+#include "parallel.h"
+#include "tasks.h"
 #include "lib/mem.h"
 #include <stdbool.h>
 #include <math.h>
@@ -13,33 +15,21 @@
 #include <stdio.h>
 #include <string.h>
 
-JumpBuffer *jump_buffer = {0};
+_Thread_local Runtime *current_runtime = NULL;
 
-HashMap *function_map = NULL;
-static HashMap *static_variable_map = NULL;
-static HashMap *struct_registry = NULL;
-static StructDef *struct_registry_list = NULL;
-ReturnValue current_return_value;
-Arena arena;
-
-TypeModifiers current_modifiers = {false, false, false, false, false, false, false, false};
-extern VarType current_var_type;
-
-Scope *current_scope;
+_Thread_local TypeModifiers current_modifiers = {false, false, false, false, false, false, false, false};
+_Thread_local VarType current_var_type = NONE;
 
 /* Include the symbol table functions */
 extern void yyerror(const char *s);
-extern void cleanup(void);
 extern TypeModifiers get_variable_modifiers(const String name);
-extern int yylineno;
 static int get_function_return_pointer_level(const String name);
 String evaluate_expression_string(ASTNode *node);
 
-/* Helper to build a namespaced static key */
-static String make_static_key(const String func_name, const String var_name)
+/* Helper to build a namespaced static key in buf[MAX_BUFFER_LEN] */
+static String make_static_key(char *buf, const String func_name, const String var_name)
 {
-    static char buf[MAX_BUFFER_LEN];
-    size_t len = (size_t)snprintf(buf, sizeof(buf),
+    size_t len = (size_t)snprintf(buf, MAX_BUFFER_LEN,
                                   "%s::%s",
                                   func_name.data ? func_name.data : "__global",
                                   var_name.data);
@@ -158,15 +148,14 @@ bool set_multi_array_variable(const String name, int dimensions[], int num_dimen
     size_t element_size = get_type_size_for_descriptor(type, var->pointer_level, mods);
     if (element_size == 0)
         element_size = sizeof(int);
-
-    var->value.array_data = safe_malloc_array(total, element_size);
-    if (var->value.array_data == NULL)
+    if (is_packed_bool_array(var))
     {
-        return false;
+        total = BOOL_ARRAY_WORDS(total);
+        element_size = sizeof(uint64_t);
     }
 
-    memset(var->value.array_data, 0, total * element_size);
-    return true;
+    var->value.array_data = safe_aligned_array(total, element_size);
+    return var->value.array_data != NULL;
 }
 
 ASTNode *create_struct_def_node(String name, StructField *fields) {
@@ -205,7 +194,7 @@ ASTNode *create_multi_array_declaration_node(String name, int dimensions[], int
     ASTNode *node = ARENA_ALLOC_ASTNODE();
     if (!node) {
         yyerror("Memory allocation failed");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     
     node->type = NODE_ARRAY_ACCESS;
@@ -243,7 +232,7 @@ ASTNode *create_multi_array_access_node(String name, ASTNode *indices[], int num
     ASTNode *node = ARENA_ALLOC_ASTNODE();
     if (!node) {
         yyerror("Memory allocation failed");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     
     node->type = NODE_ARRAY_ACCESS;
@@ -314,7 +303,7 @@ size_t calculate_array_offset(Variable *var, int indices[], int num_indices) {
             sprintf(error_msg, "Array index out of bounds: dimension %d (index=%d, size=%d)", 
                     i + 1, indices[i], var->array_dimensions.dimensions[i]);
             yyerror(error_msg);
-            exit(EXIT_FAILURE);
+            runtime_exit(EXIT_FAILURE);
         }
         
         // Calculate the multiplier for this dimension
@@ -372,16 +361,17 @@ void *evaluate_struct_member_address(ASTNode *node) {
     return (char *)var->value.array_data + fld->offset;
 }
 
-// Evaluate a multi-dimensional array access node
-void *evaluate_multi_array_access(ASTNode *node) {
+// Resolve a multi-dimensional array access node to its array and the
+// row-major offset of the element
+Variable *resolve_array_element(ASTNode *node, size_t *offset) {
     // Validate the node structure
     if (!node) {
         yyerror("Invalid array access node: null node");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     if (node->type != NODE_ARRAY_ACCESS) {
         yyerror("Invalid node type for array access");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     
     // CRITICAL: Store the array name in a local copy IMMEDIATELY
@@ -392,14 +382,14 @@ void *evaluate_multi_array_access(ASTNode *node) {
     const String original_array_name = node->data.array.name;
     if (!original_array_name.data) {
         yyerror("Invalid array access node: missing array name");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
 
     size_t name_len = original_array_name.len;
 
     if (name_len == 0 || name_len >= sizeof(array_name_buffer)) {
         yyerror("Invalid array name in array access");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
 
     memcpy(array_name_buffer, original_array_name.data, name_len);
@@ -413,7 +403,7 @@ void *evaluate_multi_array_access(ASTNode *node) {
     int num_indices = node->data.array.num_dimensions;
     if (num_indices <= 0) {
         yyerror("Invalid number of array indices");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     
     // Get the variable using the preserved array name
@@ -422,13 +412,13 @@ void *evaluate_multi_array_access(ASTNode *node) {
         char error_msg[MAX_BUFFER_LEN];
         snprintf(error_msg, sizeof(error_msg), "Variable '%.100s' is not defined", array_name.data);
         yyerror(error_msg);
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     if (!var->is_array) {
         char error_msg[MAX_BUFFER_LEN];
         snprintf(error_msg, sizeof(error_msg), "Variable '%.100s' is not an array", array_name.data);
         yyerror(error_msg);
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     
     // Extract the indices - evaluate them AFTER we've preserved the array name
@@ -441,7 +431,7 @@ void *evaluate_multi_array_access(ASTNode *node) {
             char error_msg[MAX_BUFFER_LEN];
             snprintf(error_msg, sizeof(error_msg), "Missing index %d for array '%.100s'", i, array_name.data);
             yyerror(error_msg);
-            exit(EXIT_FAILURE);
+            runtime_exit(EXIT_FAILURE);
         }
         // Evaluate the index expression - this should return an integer value
         // Make sure we're not accidentally treating the index as an array access
@@ -456,9 +446,12 @@ void *evaluate_multi_array_access(ASTNode *node) {
     }
     
     // Calculate the offset
-    size_t offset = calculate_array_offset(var, indices, num_indices);
-    
-    // Return a pointer to the element
+    *offset = calculate_array_offset(var, indices, num_indices);
+    return var;
+}
+
+// Pointer to element `offset` of an array that is not bit-packed
+void *array_element_address(Variable *var, size_t offset) {
     switch (var->var_type) {
         case VAR_INT:
             return (int*)var->value.array_data + offset;
@@ -474,10 +467,21 @@ void *evaluate_multi_array_access(ASTNode *node) {
             return (char*)var->value.array_data + offset;
         default:
             yyerror("Unknown variable type");
-            exit(EXIT_FAILURE);
+            runtime_exit(EXIT_FAILURE);
     }
 }
 
+// Evaluate a multi-dimensional array access node to the element's address
+void *evaluate_multi_array_access(ASTNode *node) {
+    size_t offset;
+    Variable *var = resolve_array_element(node, &offset);
+    if (is_packed_bool_array(var)) {
+        yyerror("Cannot take the address of a cap array element");
+        runtime_exit(EXIT_FAILURE);
+    }
+    return array_element_address(var, offset);
+}
+
 bool set_int_variable(const String name, int value, TypeModifiers mods)
 {
     return set_variable(name, &value, VAR_INT, mods);
@@ -506,34 +510,27 @@ bool set_array_variable(String name, int length, TypeModifiers mods, VarType typ
         switch (type)
         {
         case VAR_INT:
-            var->value.array_data = SAFE_MALLOC_ARRAY(int, length);
-            if (length)
-                memset(var->value.array_data, 0, length * sizeof(int));
+            var->value.array_data = SAFE_ALIGNED_ARRAY(int, length);
             break;
         case VAR_SHORT:
-            var->value.array_data = SAFE_MALLOC_ARRAY(short, length);
-            if (length)
-                memset(var->value.array_data, 0, length * sizeof(short));
+            var->value.array_data = SAFE_ALIGNED_ARRAY(short, length);
             break;
         case VAR_FLOAT:
-            var->value.array_data = SAFE_MALLOC_ARRAY(float, length);
-            if (length)
-                memset(var->value.array_data, 0, length * sizeof(float));
+            var->value.array_data = SAFE_ALIGNED_ARRAY(float, length);
             break;
         case VAR_DOUBLE:
-            var->value.array_data = SAFE_MALLOC_ARRAY(double, length);
-            if (length)
-                memset(var->value.array_data, 0, length * sizeof(double));
+            var->value.array_data = SAFE_ALIGNED_ARRAY(double, length);
             break;
         case VAR_BOOL:
-            var->value.array_data = SAFE_MALLOC_ARRAY(bool, length);
-            if (length)
-                memset(var->value.array_data, 0, length * sizeof(bool));
+            if (is_packed_bool_array(var))
+            {
+                var->value.array_data = SAFE_ALIGNED_ARRAY(uint64_t, BOOL_ARRAY_WORDS(length));
+                break;
+            }
+            var->value.array_data = SAFE_ALIGNED_ARRAY(bool, length);
             break;
         case VAR_CHAR:
-            var->value.array_data = SAFE_MALLOC_ARRAY(char, length);
-            if (length)
-                memset(var->value.array_data, 0, length * sizeof(char));
+            var->value.array_data = SAFE_ALIGNED_ARRAY(char, length);
             break;
         default:
             break;
@@ -592,24 +589,22 @@ TypeModifiers get_current_modifiers(void)
 
 bool check_and_mark_identifier(ASTNode *node, const String contextErrorMessage)
 {
-    if (!node->already_checked)
-    {
-        node->already_checked = true;
-        node->is_valid_symbol = false;
-
-        // Do the table lookup
-        Variable *var = get_variable(node->data.name);
-        if (var != NULL)
-            node->is_valid_symbol = true;
+    /* Runs of a compiled program share its AST and may be on other threads,
+     * so only a successful lookup is remembered, and atomically */
+    if (__atomic_load_n(&node->already_checked, __ATOMIC_ACQUIRE))
+        return true;
 
-        if (!node->is_valid_symbol)
-        {
-            yylineno = yylineno - 2;
-            yyerror(contextErrorMessage.data);
-        }
+    // Do the table lookup
+    if (get_variable(node->data.name) == NULL)
+    {
+        current_runtime->line_number -= 2;
+        yyerror(contextErrorMessage.data);
+        return false;
     }
 
-    return node->is_valid_symbol;
+    __atomic_store_n(&node->is_valid_symbol, true, __ATOMIC_RELAXED);
+    __atomic_store_n(&node->already_checked, true, __ATOMIC_RELEASE);
+    return true;
 }
 
 void execute_switch_statement(ASTNode *node)
@@ -657,7 +652,7 @@ static ASTNode *create_node(NodeType type, VarType var_type, TypeModifiers modif
     if (!node)
     {
         yyerror("Error: Memory allocation failed for ASTNode.\n");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
     node->type = type;
     node->var_type = var_type;
@@ -665,7 +660,7 @@ static ASTNode *create_node(NodeType type, VarType var_type, TypeModifiers modif
     node->already_checked = false;
     node->is_valid_symbol = false;
     node->pointer_level = 0;
-    node->line_number = yylineno;
+    node->line_number = current_runtime->line_number;
     return node;
 }
 
@@ -705,7 +700,7 @@ ASTNode *create_array_access_node(String name, ASTNode *index)
     if (!node)
     {
         yyerror("Memory allocation failed");
-        exit(EXIT_FAILURE);
+        runtime_exit(EXIT_FAILURE);
     }
 
     node->type = NODE_ARRAY_ACCESS;
@@ -816,6 +811,23 @@ ASTNode *create_for_statement_node(ASTNode *init, ASTNode *cond, ASTNode *incr,
     return node;
 }
 
+ASTNode *create_squad_statement_node(ASTNode *init, ASTNode *cond, ASTNode *incr, ASTNode *body, Reduction *reductions)
+{
+    ASTNode *node = create_for_statement_node(init, cond, incr, body);
+    node->data.for_stmt.squad = true;
+    node->data.for_stmt.reductions = reductions;
+    return node;
+}
+
+Reduction *create_reduction(ReductionOp op, String name, Reduction *next)
+{
+    Reduction *reduction = ARENA_ALLOC(Reduction);
+    reduction->op = op;
+    reduction->name = ARENA_STRDUP(name);
+    reduction->next = next;
+    return reduction;
+}
+
 ASTNode *create_while_statement_node(ASTNode *cond, ASTNode *body)
 {
     ASTNode *node = create_node(NODE_WHILE_STATEMENT, NONE, current_modifiers);
@@ -861,7 +873,7 @@ void *handle_identifier(ASTNode *node, const String contextErrorMessage, int pro
     Variable *var = get_variable(name);
     if (var != NULL)
     {
-        static Value promoted_value;
+        Value *promoted = &current_runtime->promoted_value;
         if (var->pointer_level > 0)
         {
             if (promote != 0)
@@ -879,18 +891,18 @@ void *handle_identifier(ASTNode *node, const String contextErrorMessage, int pro
             case VAR_DOUBLE:
                 return &var->value.dvalue;
             case VAR_FLOAT:
-                promoted_value.dvalue = (double)var->value.fvalue;
-                return &promoted_value;
+                promoted->dvalue = (double)var->value.fvalue;
+                return promoted;
             case VAR_INT:
-                promoted_value.dvalue = (double)var->value.ivalue;
-                return &promoted_value;
+                promoted->dvalue = (double)var->value.ivalue;
+                return promoted;
             case VAR_CHAR:
             case VAR_SHORT:
-                promoted_value.dvalue = (double)var->value.svalue;
-                return &promoted_value;
+                promoted->dvalue = (double)var->value.svalue;
+                return promoted;
             case VAR_BOOL:
-                promoted_value.dvalue = (double)var->value.ivalue;
-                return &promoted_value;
+                promoted->dvalue = (double)var->value.ivalue;
+                return promoted;
             case VAR_STRING:
                 return &var->value.strvalue;
             default:
@@ -903,20 +915,20 @@ void *handle_identifier(ASTNode *node, const String contextErrorMessage, int pro
             switch (var->var_type)
             {
             case VAR_DOUBLE:
-                promoted_value.fvalue = (float)var->value.dvalue;
-                return &promoted_value.fvalue;
+                promoted->fvalue = (float)var->value.dvalue;
+                return &promoted->fvalue;
             case VAR_FLOAT:
                 return &var->value.fvalue;
             case VAR_INT:
-                promoted_value.fvalue = (float)var->value.ivalue;
-                return &promoted_value.fvalue;
+                promoted->fvalue = (float)var->value.ivalue;
+                return &promoted->fvalue;
             case VAR_CHAR:
             case VAR_SHORT:
-                promoted_value.fvalue = (float)var->value.svalue;
-                return &promoted_value.fvalue;
+                promoted->fvalue = (float)var->value.svalue;
+                return &promoted->fvalue;
             case VAR_BOOL:
-                promoted_value.fvalue = (float)var->value.ivalue;
-                return &promoted_value.fvalue;
+                promoted->fvalue = (float)var->value.ivalue;
+                return &promoted->fvalue;
             case VAR_STRING:
                 return &var->value.strvalue;
             default:
@@ -980,6 +992,8 @@ int get_expression_pointer_level(ASTNode *node)
         }
         return get_expression_pointer_level(node->data.unary.operand);
     case NODE_FUNC_CALL:
+        if (stdrot_bind_call(node))
+            return 0;
         return get_function_return_pointer_level(node->data.func_call.function_name);
     case NODE_OPERATION:
         switch (node->data.op.op)
@@ -1114,6 +1128,9 @@ VarType get_expression_type(ASTNode *node)
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return stdrot_call_type(node);
+
         // Look up the function in the symbol table
         const String func_name = node->data.func_call.function_name;
         Function *func = get_function(func_name);
@@ -1838,7 +1855,11 @@ float evaluate_expression_float(ASTNode *node)
             yyerror("Cannot use pointer in float context");
             return 0.0f;
         }
-        return *(float*)evaluate_multi_array_access(node);
+        size_t offset;
+        Variable *var = resolve_array_element(node, &offset);
+        if (is_packed_bool_array(var))
+            return (float)bool_array_get(var, offset);
+        return *(float*)array_element_address(var, offset);
     }
     case NODE_FLOAT:
         return node->data.fvalue;
@@ -1902,6 +1923,8 @@ float evaluate_expression_float(ASTNode *node)
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return (float)stdrot_eval_call_real(node);
         float *res = (float *)handle_function_call(node);
         if (res != NULL)
         {
@@ -1950,7 +1973,11 @@ double evaluate_expression_double(ASTNode *node)
             yyerror("Cannot use pointer in double context");
             return 0.0;
         }
-        return *(double*)evaluate_multi_array_access(node);
+        size_t offset;
+        Variable *var = resolve_array_element(node, &offset);
+        if (is_packed_bool_array(var))
+            return (double)bool_array_get(var, offset);
+        return *(double*)array_element_address(var, offset);
     }
     case NODE_DOUBLE:
         return node->data.dvalue;
@@ -2014,6 +2041,8 @@ double evaluate_expression_double(ASTNode *node)
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return stdrot_eval_call_real(node);
         double *res = (double *)handle_function_call(node);
         if (res != NULL)
         {
@@ -2235,10 +2264,16 @@ short evaluate_expression_short(ASTNode *node)
             yyerror("Cannot use pointer in integer context");
             return 0;
         }
-        return *(short*)evaluate_multi_array_access(node);
+        size_t offset;
+        Variable *var = resolve_array_element(node, &offset);
+        if (is_packed_bool_array(var))
+            return (short)bool_array_get(var, offset);
+        return *(short*)array_element_address(var, offset);
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return (short)stdrot_eval_call_integer(node);
         short *res = (short *)handle_function_call(node);
         if (res != NULL)
         {
@@ -2372,10 +2407,16 @@ int evaluate_expression_int(ASTNode *node)
             yyerror("Cannot use pointer in integer context");
             return 0;
         }
-        return *(int*)evaluate_multi_array_access(node);
+        size_t offset;
+        Variable *var = resolve_array_element(node, &offset);
+        if (is_packed_bool_array(var))
+            return (int)bool_array_get(var, offset);
+        return *(int*)array_element_address(var, offset);
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return (int)stdrot_eval_call_integer(node);
         int *res = (int *)handle_function_call(node);
         if (res != NULL)
         {
@@ -2417,43 +2458,43 @@ void *handle_function_call(ASTNode *node)
         node->data.func_call.function_name,
         node->data.func_call.arguments);
     void *return_value = NULL;
-    if (current_return_value.has_value)
+    if (current_runtime->return_value.has_value)
     {
-        switch (current_return_value.type)
+        switch (current_runtime->return_value.type)
         {
         case VAR_INT:
-            if (current_return_value.pointer_level > 0)
+            if (current_runtime->return_value.pointer_level > 0)
             {
                 return_value = SAFE_MALLOC(uintptr_t);
-                *(uintptr_t *)return_value = current_return_value.value.pvalue;
+                *(uintptr_t *)return_value = current_runtime->return_value.value.pvalue;
                 break;
             }
             return_value = SAFE_MALLOC(int);
-            *(int *)return_value = current_return_value.value.ivalue;
+            *(int *)return_value = current_runtime->return_value.value.ivalue;
             break;
         case VAR_FLOAT:
             return_value = SAFE_MALLOC(float);
-            *(float *)return_value = current_return_value.value.fvalue;
+            *(float *)return_value = current_runtime->return_value.value.fvalue;
             break;
         case VAR_DOUBLE:
             return_value = SAFE_MALLOC(double);
-            *(double *)return_value = current_return_value.value.dvalue;
+            *(double *)return_value = current_runtime->return_value.value.dvalue;
             break;
         case VAR_BOOL:
             return_value = SAFE_MALLOC(bool);
-            *(bool *)return_value = current_return_value.value.bvalue;
+            *(bool *)return_value = current_runtime->return_value.value.bvalue;
             break;
         case VAR_CHAR:
             return_value = SAFE_MALLOC(char);
-            *(char *)return_value = current_return_value.value.ivalue;
+            *(char *)return_value = current_runtime->return_value.value.ivalue;
             break;
         case VAR_SHORT:
             return_value = SAFE_MALLOC(short);
-            *(short *)return_value = current_return_value.value.svalue;
+            *(short *)return_value = current_runtime->return_value.value.svalue;
             break;
         case VAR_STRING: 
             return_value = SAFE_MALLOC(String *);
-            *(String *)return_value = safe_strdup(&current_return_value.value.strvalue);
+            *(String *)return_value = safe_strdup(&current_runtime->return_value.value.strvalue);
             break;
         case VAR_STRUCT:
             /* struct return not yet supported; fall through to NULL */
@@ -2565,10 +2606,16 @@ bool evaluate_expression_bool(ASTNode *node)
         if (get_expression_pointer_level(node) > 0) {
             return *(uintptr_t*)evaluate_multi_array_access(node) != (uintptr_t)0;
         }
-        return *(bool*)evaluate_multi_array_access(node);
+        size_t offset;
+        Variable *var = resolve_array_element(node, &offset);
+        if (is_packed_bool_array(var))
+            return bool_array_get(var, offset);
+        return *(bool*)array_element_address(var, offset);
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return stdrot_eval_call_real(node) != 0.0;
         bool *res = (bool *)handle_function_call(node);
         if (res != NULL)
         {
@@ -2702,7 +2749,7 @@ void check_const_assignment(const String name)
 {
     if (is_const_variable(name))
     {
-        yylineno = yylineno - 2;
+        current_runtime->line_number -= 2;
         yyerror("Cannot modify const variable");
         ragequit(EXIT_FAILURE);
     }
@@ -2749,6 +2796,8 @@ bool is_expression(ASTNode *node, VarType type)
     }
     case NODE_FUNC_CALL:
     {
+        if (stdrot_bind_call(node))
+            return stdrot_call_type(node) == type;
         return get_function_return_type(node->data.func_call.function_name) == type;
     }
     case NODE_STRUCT_ACCESS: {
@@ -2768,12 +2817,12 @@ bool is_expression(ASTNode *node, VarType type)
 
 Function *get_function(const String name)
 {
-    if (!function_map || !name.data) {
+    if (!current_runtime->function_map || !name.data) {
         return NULL;
     }
     
     size_t name_len = name.len;
-    Function **func_ptr = (Function **)hm_get(function_map, name.data, name_len);
+    Function **func_ptr = (Function **)hm_get(current_runtime->function_map, name.data, name_len);
     if (func_ptr) {
         return *func_ptr;
     }
@@ -2864,6 +2913,19 @@ void execute_assignment(ASTNode *node)
             }
         }
     }
+    else if (target->type == NODE_ARRAY_ACCESS && target_pointer_level == 0)
+    {
+        size_t offset;
+        Variable *var = resolve_array_element(target, &offset);
+        if (is_packed_bool_array(var))
+        {
+            bool_array_set(var, offset, evaluate_expression_bool(value_node));
+            return;
+        }
+        write_value_to_address(array_element_address(var, offset), target_type,
+                               target_pointer_level, value_node, mods);
+        return;
+    }
 
     void *address = evaluate_lvalue_address(target);
     write_value_to_address(address, target_type, target_pointer_level, value_node, mods);
@@ -2886,13 +2948,14 @@ void execute_statement(ASTNode *node)
         /* Check if it's static and already initialized */
         if (node->modifiers.is_static) {
             String func_name = {NULL, 0};
-            Scope *s = current_scope;
+            Scope *s = current_runtime->scope;
             while (s) {
                 if (s->is_function_scope) { func_name= s->function_name; break; }
                 s = s->parent;
             }
-            String static_key = make_static_key(func_name, name);
-            Variable *existing = hm_get(static_variable_map, static_key.data, MAX_BUFFER_LEN);
+            char key_buf[MAX_BUFFER_LEN];
+            String static_key = make_static_key(key_buf, func_name, name);
+            Variable *existing = hm_get(current_runtime->static_variable_map, static_key.data, static_key.len);
             if (existing) {
                 SAFE_FREE(var);
                 break; /* Already initialized — skip assignment entirely */
@@ -2936,14 +2999,16 @@ void execute_statement(ASTNode *node)
         break;
     case NODE_FUNC_CALL: {
         // Set execution context with current line number
-        extern ExecutionContext g_exec_context;
-        g_exec_context.line_number = node->line_number;
-        g_exec_context.function_name = node->data.func_call.function_name;
+        current_runtime->exec_context.line_number = node->line_number;
+        current_runtime->exec_context.function_name = node->data.func_call.function_name;
         
         // Use the stdrot built-in function system
-        if (is_builtin_function(node->data.func_call.function_name))
+        StdrotFn builtin = stdrot_bind_call(node);
+        if (builtin)
         {
-            execute_builtin_function(node->data.func_call.function_name, node->data.func_call.arguments);
+            execute_func_call(builtin, stdrot_call_flags(node),
+                              node->data.func_call.function_name,
+                              node->data.func_call.arguments, node->data.func_call.format);
         }
         else
         {
@@ -2971,7 +3036,7 @@ void execute_statement(ASTNode *node)
                 .data = "%s\n",
                 .len = sizeof("%s\n") - 1
             };
-            yapping(s, expr->data.name);
+            yapping(s, expr->data.name.data);
         }
         else
         {
@@ -2993,7 +3058,7 @@ void execute_statement(ASTNode *node)
                 .data = "%s\n",
                 .len = sizeof("%s\n") - 1
             };
-            baka(s, expr->data.name);
+            baka(s, expr->data.name.data);
         }
         else
         {
@@ -3038,7 +3103,7 @@ void execute_statement(ASTNode *node)
         if (!func)
         {
             yyerror("Failed to create function");
-            exit(1);
+            runtime_exit(1);
         }
         break;
     }
@@ -3072,6 +3137,12 @@ void execute_statements(ASTNode *node)
 
 void execute_for_statement(ASTNode *node)
 {
+    if (node->data.for_stmt.squad)
+    {
+        execute_squad_loop(node);
+        return;
+    }
+
     PUSH_JUMP_BUFFER();
     if (setjmp(CURRENT_JUMP_BUFFER()) == 0)
     {
@@ -3084,6 +3155,7 @@ void execute_for_statement(ASTNode *node)
 
         while (1)
         {
+            TASKS_CHECK_CANCELLED();
             // Evaluate condition
             enter_scope();
             if (node->data.for_stmt.cond)
@@ -3119,6 +3191,7 @@ void execute_while_statement(ASTNode *node)
     enter_scope();
     while (evaluate_expression(node->data.while_stmt.cond) && setjmp(CURRENT_JUMP_BUFFER()) == 0)
     {
+        TASKS_CHECK_CANCELLED();
         enter_scope();
         execute_statement(node->data.while_stmt.body);
         exit_scope();
@@ -3133,6 +3206,7 @@ void execute_do_while_statement(ASTNode *node)
     enter_scope();
     do
     {
+        TASKS_CHECK_CANCELLED();
         enter_scope();
         execute_statement(node->data.while_stmt.body);
         exit_scope();
@@ -3231,7 +3305,7 @@ ASTNode *create_default_node(VarType var_type)
     }
     default:
         yyerror("Unsupported type for default node");
-        exit(1);
+        runtime_exit(1);
     }
 }
 
@@ -3242,7 +3316,7 @@ ExpressionList *create_expression_list(ASTNode *expr)
     if (!list)
     {
         yyerror("Failed to allocate memory for expression list");
-        exit(1);
+        runtime_exit(1);
     }
     list->expr = expr;
     list->next = list;
@@ -3256,7 +3330,7 @@ ExpressionList *append_expression_list(ExpressionList *list, ASTNode *expr)
     if (!new_node)
     {
         yyerror("Failed to allocate memory for expression list");
-        exit(1);
+        runtime_exit(1);
     }
     new_node->expr = expr;
 
@@ -3377,6 +3451,10 @@ void populate_multi_array_variable(String name, ExpressionList *list, int dimens
                 break;
             }
             case VAR_BOOL: {
+                if (is_packed_bool_array(var)) {
+                    bool_array_set(var, index, evaluate_expression_bool(current->expr));
+                    break;
+                }
                 bool *array = (bool*)var->value.array_data;
                 array[index] = evaluate_expression_bool(current->expr);
                 break;
@@ -3406,11 +3484,6 @@ void free_statement_list(StatementList *list)
     }
 }
 
-void free_ast()
-{
-    arena_free(&arena);
-}
-
 Scope *create_scope(Scope *parent)
 {
     Scope *scope = SAFE_MALLOC(Scope);
@@ -3418,7 +3491,7 @@ Scope *create_scope(Scope *parent)
     {
         yyerror("Failed to allocate memory for scope");
         SAFE_FREE(scope);
-        exit(1);
+        runtime_exit(1);
     }
     scope->variables = hm_new();
     scope->parent = parent;
@@ -3428,19 +3501,20 @@ Scope *create_scope(Scope *parent)
 Variable *get_variable(const String name)
 {
     /* Check static store first */
-    if (static_variable_map) {
+    if (current_runtime->static_variable_map) {
         String func_name = {NULL, 0};
-        Scope *s = current_scope;
+        Scope *s = current_runtime->scope;
         while (s) {
             if (s->is_function_scope) { func_name = s->function_name; break; }
             s = s->parent;
         }
-        String static_key = make_static_key(func_name, name);
-        Variable *var = hm_get(static_variable_map, static_key.data, static_key.len);
+        char key_buf[MAX_BUFFER_LEN];
+        String static_key = make_static_key(key_buf, func_name, name);
+        Variable *var = hm_get(current_runtime->static_variable_map, static_key.data, static_key.len);
         if (var) { return var; }
     }
 
-    Scope *scope = current_scope;
+    Scope *scope = current_runtime->scope;
     while (scope)
     {
         Variable *var = hm_get(scope->variables, name.data, name.len);
@@ -3459,15 +3533,15 @@ Variable *get_variable(const String name)
 
 void exit_scope()
 {
-    if (!current_scope)
+    if (!current_runtime->scope)
     {
         yyerror("No scope to exit");
-        exit(1);
+        runtime_exit(1);
     }
-    Scope *parent = current_scope->parent;
-    hm_free(current_scope->variables);
-    SAFE_FREE(current_scope);
-    current_scope = parent;
+    Scope *parent = current_runtime->scope->parent;
+    hm_free(current_runtime->scope->variables);
+    SAFE_FREE(current_runtime->scope);
+    current_runtime->scope = parent;
 }
 
 void free_scope(Scope *scope)
@@ -3478,9 +3552,217 @@ void free_scope(Scope *scope)
     free_scope(scope->parent);
     SAFE_FREE(scope);
 }
+
+FILE *runtime_stderr(void)
+{
+    return current_runtime && current_runtime->exec_context.err ? current_runtime->exec_context.err : stderr;
+}
+
+Runtime *runtime_new(void)
+{
+    Runtime *runtime = SAFE_MALLOC(Runtime);
+    if (!runtime)
+    {
+        yyerror("Failed to allocate memory for runtime");
+        runtime_exit(1);
+    }
+    runtime->scope = create_scope(NULL);
+    runtime->line_number = 1;
+    runtime->exec_context.out = stdout;
+    runtime->exec_context.err = stderr;
+    return runtime;
+}
+
+/* Deep copy of a variable parsing declared: arrays and gang blobs get their
+ * own storage, so a run can never write into the program it came from */
+static void copy_variable(Variable *dst, const Variable *src, const Runtime *program)
+{
+    *dst = *src;
+    if (src->struct_name.data)
+        dst->struct_name = safe_strdup(&src->struct_name);
+
+    if (src->is_array)
+    {
+        dst->value.array_data = safe_aligned_array_dup(src->value.array_data);
+    }
+    else if (src->var_type == VAR_STRING && src->pointer_level == 0 && src->value.strvalue.data)
+    {
+        dst->value.strvalue = safe_strdup(&src->value.strvalue);
+    }
+    else if (src->var_type == VAR_STRUCT && src->value.array_data)
+    {
+        StructDef *def = program->struct_registry
+            ? hm_get(program->struct_registry, src->struct_name.data, src->struct_name.len)
+            : NULL;
+        dst->value.array_data = NULL;
+        if (def)
+        {
+            dst->value.array_data = malloc(def->total_size);
+            if (dst->value.array_data)
+                memcpy(dst->value.array_data, src->value.array_data, def->total_size);
+        }
+    }
+}
+
+static HashMap *copy_variables(const HashMap *variables, const Runtime *program)
+{
+    HashMap *copy = hm_new();
+    for (size_t i = 0; i < variables->capacity; i++)
+    {
+        HashMapNode *node = variables->nodes[i];
+        if (!node)
+            continue;
+        Variable var;
+        copy_variable(&var, node->value, program);
+        hm_put(copy, node->key, node->key_size, &var, sizeof(Variable));
+    }
+    return copy;
+}
+
+static Scope *copy_scope(const Scope *scope, const Runtime *program)
+{
+    if (!scope)
+        return NULL;
+    Scope *copy = create_scope(copy_scope(scope->parent, program));
+    hm_free(copy->variables);
+    copy->variables = copy_variables(scope->variables, program);
+    copy->is_function_scope = scope->is_function_scope;
+    copy->function_name = scope->function_name;
+    return copy;
+}
+
+/* A fresh runtime for one run of a compiled program: its own copy of what
+ * parsing declared, sharing the gang definitions, with everything else
+ * (functions, statics created while running, builtin objects) empty */
+Runtime *runtime_clone(const Runtime *program)
+{
+    Runtime *runtime = SAFE_MALLOC(Runtime);
+    if (!runtime)
+    {
+        yyerror("Failed to allocate memory for runtime");
+        runtime_exit(1);
+    }
+    runtime->scope = copy_scope(program->scope, program);
+    if (program->static_variable_map)
+        runtime->static_variable_map = copy_variables(program->static_variable_map, program);
+    runtime->struct_registry = program->struct_registry;
+    runtime->struct_registry_list = program->struct_registry_list;
+    runtime->borrows_structs = true;
+    runtime->line_number = program->line_number;
+    runtime->exec_context.out = stdout;
+    runtime->exec_context.err = stderr;
+    return runtime;
+}
+
+void runtime_free(Runtime *runtime)
+{
+    if (!runtime)
+        return;
+
+    /* The free_* helpers work on the current runtime */
+    Runtime *previous = current_runtime;
+    current_runtime = runtime;
+
+    free_scope(runtime->scope);
+    runtime->scope = NULL;
+    free_function_table();
+    free_static_variable_map();
+    if (!runtime->borrows_structs)
+        free_struct_registry();
+    CLEAN_JUMP_BUFFER();
+    stdrot_release_context(&runtime->exec_context);
+    arena_free(&runtime->arena);
+
+    current_runtime = previous == runtime ? NULL : previous;
+    SAFE_FREE(runtime);
+}
+
+Runtime *runtime_worker(const Runtime *program)
+{
+    Runtime *runtime = SAFE_MALLOC(Runtime);
+    if (!runtime)
+    {
+        yyerror("Failed to allocate memory for runtime");
+        runtime_exit(1);
+    }
+    runtime->scope = program->scope;
+    runtime->function_map = program->function_map;
+    runtime->static_variable_map = program->static_variable_map;
+    runtime->struct_registry = program->struct_registry;
+    runtime->struct_registry_list = program->struct_registry_list;
+    runtime->borrows_structs = true;
+    runtime->line_number = program->line_number;
+    runtime->exec_context.out = program->exec_context.out;
+    runtime->exec_context.err = program->exec_context.err;
+    /* Only STDROT_THREAD_SAFE builtins run on a worker, and they never add
+     * handles, so the program's table can be shared */
+    runtime->exec_context.handles = program->exec_context.handles;
+    return runtime;
+}
+
+void runtime_worker_free(Runtime *runtime)
+{
+    if (!runtime)
+        return;
+
+    Runtime *previous = current_runtime;
+    current_runtime = runtime;
+    CLEAN_JUMP_BUFFER();
+    current_runtime = previous == runtime ? NULL : previous;
+    SAFE_FREE(runtime);
+}
+
+Runtime *runtime_task(const Runtime *program)
+{
+    Runtime *runtime = SAFE_MALLOC(Runtime);
+    if (!runtime)
+    {
+        yyerror("Failed to allocate memory for runtime");
+        runtime_exit(1);
+    }
+    runtime->scope = create_scope(NULL);
+    runtime->function_map = program->function_map;
+    runtime->struct_registry = program->struct_registry;
+    runtime->struct_registry_list = program->struct_registry_list;
+    runtime->borrows_structs = true;
+    runtime->tasks = program->tasks;
+    runtime->line_number = program->line_number;
+    runtime->exec_context.out = program->exec_context.out;
+    runtime->exec_context.err = program->exec_context.err;
+    runtime->exec_context.read = program->exec_context.read;
+    runtime->exec_context.read_data = program->exec_context.read_data;
+    return runtime;
+}
+
+void runtime_task_free(Runtime *runtime)
+{
+    if (!runtime)
+        return;
+
+    Runtime *previous = current_runtime;
+    current_runtime = runtime;
+    free_scope(runtime->scope);
+    free_static_variable_map();
+    CLEAN_JUMP_BUFFER();
+    stdrot_release_context(&runtime->exec_context);
+    arena_free(&runtime->arena);
+    current_runtime = previous == runtime ? NULL : previous;
+    SAFE_FREE(runtime);
+}
+
+void runtime_exit(int status)
+{
+    if (current_runtime && current_runtime->exit_jump)
+    {
+        current_runtime->exit_status = status;
+        longjmp(*current_runtime->exit_jump, 1);
+    }
+    exit(status);
+}
+
 void enter_scope()
 {
-    current_scope = create_scope(current_scope);
+    current_runtime->scope = create_scope(current_runtime->scope);
 }
 Variable *variable_new(String name)
 {
@@ -3488,7 +3770,7 @@ Variable *variable_new(String name)
     if (!var)
     {
         yyerror("Failed to allocate memory for variable");
-        exit(1);
+        runtime_exit(1);
     }
     memset(var, 0, sizeof(Variable));
     var->name = name;
@@ -3498,42 +3780,43 @@ Variable *variable_new(String name)
 
 void add_variable_to_scope(const String name, Variable *var)
 {
-    if (!current_scope) {
+    if (!current_runtime->scope) {
         yyerror("No scope to add variable to");
-        exit(1);
+        runtime_exit(1);
     }
 
     /* Static variables go to the static store, not the scope */
     if (var->modifiers.is_static) {
-        if (!static_variable_map)
-            static_variable_map = hm_new();
+        if (!current_runtime->static_variable_map)
+            current_runtime->static_variable_map = hm_new();
 
         /* Find nearest function scope to namespace the key */
         String func_name = {NULL, 0};
-        Scope *s = current_scope;
+        Scope *s = current_runtime->scope;
         while (s) {
             if (s->is_function_scope) { func_name = s->function_name; break; }
             s = s->parent;
         }
 
-        String static_key = make_static_key(func_name, name);
-        Variable *existing = hm_get(static_variable_map, static_key.data, static_key.len);
+        char key_buf[MAX_BUFFER_LEN];
+        String static_key = make_static_key(key_buf, func_name, name);
+        Variable *existing = hm_get(current_runtime->static_variable_map, static_key.data, static_key.len);
         if (!existing)
-            hm_put(static_variable_map, static_key.data, static_key.len, var, sizeof(Variable));
+            hm_put(current_runtime->static_variable_map, static_key.data, static_key.len, var, sizeof(Variable));
 
         return;  /* <-- always return here, never fall through to normal scope */
     }
 
     /* Normal (non-static) path — unchanged from your original */
     size_t name_len = name.len;
-    Variable *existing = hm_get(current_scope->variables, name.data, name_len);
+    Variable *existing = hm_get(current_runtime->scope->variables, name.data, name_len);
     if (existing) {
         yyerror("Variable already exists in current scope");
         SAFE_FREE(var);
-        exit(1);
+        runtime_exit(1);
     }
 
-    hm_put(current_scope->variables, name.data, name_len, var, sizeof(Variable));
+    hm_put(current_runtime->scope->variables, name.data, name_len, var, sizeof(Variable));
 }
 
 ASTNode *create_return_node(ASTNode *expr)
@@ -3571,11 +3854,11 @@ Function *create_function_ex(String name, VarType return_type, int return_pointe
     func->body = body;
 
     /* Initialize hash map if needed and add function for O(1) lookups */
-    if (!function_map) {
-        function_map = hm_new();
+    if (!current_runtime->function_map) {
+        current_runtime->function_map = hm_new();
     }
     size_t name_len = name.len;
-    hm_put(function_map, name.data, name_len, &func, sizeof(Function *));
+    hm_put(current_runtime->function_map, name.data, name_len, &func, sizeof(Function *));
 
     return func;
 }
@@ -3585,87 +3868,99 @@ Function *create_function(String name, VarType return_type, Parameter *params, A
     return create_function_ex(name, return_type, 0, params, body);
 }
 
-void execute_function_call(const String name, ArgumentList *args)
+/* Runs func in the function scope just entered for it */
+static void run_function_body(Function *func)
 {
-    /* Use optimized O(1) hash map lookup instead of O(n) linked list search */
-    Function *func = get_function(name);
-
-    if (!func)
-    {
-        yyerror("Undefined function");
-        return;
-    }
-
-    enter_function_scope(func, args);
-    current_return_value.type = func->return_type;
-    current_return_value.pointer_level = func->return_pointer_level;
-    current_return_value.has_value = false;
+    TASKS_CHECK_CALL(func->name.data);
+    current_runtime->return_value.type = func->return_type;
+    current_runtime->return_value.pointer_level = func->return_pointer_level;
+    current_runtime->return_value.has_value = false;
 
     PUSH_JUMP_BUFFER();
     if (setjmp(CURRENT_JUMP_BUFFER()) == 0)
     {
         /* Use visitor pattern instead of old AST execution for function bodies */
-        extern Interpreter* current_interpreter;
-        if (current_interpreter) {
-            ast_accept(func->body, (Visitor*)current_interpreter);
+        if (current_runtime->interpreter) {
+            ast_accept(func->body, (Visitor*)current_runtime->interpreter);
         } else {
             /* Fallback to old system if no current interpreter */
             execute_statement(func->body);
         }
         
         // If we reach here without an explicit return, clean up function scope
-        if (current_scope && current_scope->is_function_scope) {
+        if (current_runtime->scope && current_runtime->scope->is_function_scope) {
             exit_scope(); // exit function scope
         }
     }
     POP_JUMP_BUFFER();
 }
 
+void execute_function_call(const String name, ArgumentList *args)
+{
+    /* Use optimized O(1) hash map lookup instead of O(n) linked list search */
+    Function *func = get_function(name);
+
+    if (!func)
+    {
+        yyerror("Undefined function");
+        return;
+    }
+
+    enter_function_scope(func, args);
+    run_function_body(func);
+}
+
+void call_function_values(Function *func, const Value *args, int argc)
+{
+    enter_function_scope_values(func, args, argc);
+    run_function_body(func);
+}
+
 void handle_return_statement(ASTNode *expr)
 {
-    current_return_value.has_value = true;
+    current_runtime->return_value.has_value = true;
     if (expr)
     {
-        if (current_return_value.pointer_level > 0)
+        if (current_runtime->return_value.pointer_level > 0)
         {
-            current_return_value.value.pvalue = evaluate_expression_pointer(expr);
+            current_runtime->return_value.value.pvalue = evaluate_expression_pointer(expr);
         }
         else
         {
-        switch (current_return_value.type)
+        switch (current_runtime->return_value.type)
         {
         case VAR_INT:
-            current_return_value.value.ivalue = evaluate_expression_int(expr);
+            current_runtime->return_value.value.ivalue = evaluate_expression_int(expr);
             break;
         case VAR_FLOAT:
-            current_return_value.value.fvalue = evaluate_expression_float(expr);
+            current_runtime->return_value.value.fvalue = evaluate_expression_float(expr);
             break;
         case VAR_DOUBLE:
-            current_return_value.value.dvalue = evaluate_expression_double(expr);
+            current_runtime->return_value.value.dvalue = evaluate_expression_double(expr);
             break;
         case VAR_BOOL:
-            current_return_value.value.bvalue = evaluate_expression_bool(expr);
+            current_runtime->return_value.value.bvalue = evaluate_expression_bool(expr);
             break;
         case VAR_SHORT:
-            current_return_value.value.svalue = evaluate_expression_short(expr);
+            current_runtime->return_value.value.svalue = evaluate_expression_short(expr);
             break;
         case NONE:
             /* void/skibidi return type: ignore expression value */
             break;
         default:
             yyerror("Unsupported return type");
-            exit(1);
+            runtime_exit(1);
         }
         }
     }
     // Clean up all scopes until we reach the function scope
-    while (current_scope && !current_scope->is_function_scope)
+    while (current_runtime->scope && !current_runtime->scope->is_function_scope)
     {
         exit_scope();
     }
 
     // skibidi main function do not have jump buffer
-    if (jump_buffer){
+    if (current_runtime->jump_buffer){
         exit_scope(); // exit current function scope
         LONGJMP();
     }
@@ -3723,24 +4018,24 @@ ASTNode *create_function_def_node(String name, VarType return_type, Parameter *p
 
 void free_static_variable_map(void)
 {
-    if (static_variable_map) {
-        hm_free(static_variable_map);
-        static_variable_map = NULL;
+    if (current_runtime->static_variable_map) {
+        hm_free(current_runtime->static_variable_map);
+        current_runtime->static_variable_map = NULL;
     }
 }
 
 void free_function_table(void)
 {
-    if (!function_map) {
+    if (!current_runtime->function_map) {
         return;
     }
     
     /* Iterate through hash map and free all functions */
-    for (size_t i = 0; i < function_map->capacity; i++)
+    for (size_t i = 0; i < current_runtime->function_map->capacity; i++)
     {
-        if (function_map->nodes[i])
+        if (current_runtime->function_map->nodes[i])
         {
-            Function **func_ptr = (Function **)function_map->nodes[i]->value;
+            Function **func_ptr = (Function **)current_runtime->function_map->nodes[i]->value;
             if (func_ptr && *func_ptr)
             {
                 Function *f = *func_ptr;
@@ -3750,7 +4045,7 @@ void free_function_table(void)
                 
                 // DO NOT free f->parameters or f->body here,
                 // because those pointers belong to the AST and
-                // are already freed in free_ast(root).
+                // are freed with the program's arena.
                 
                 SAFE_FREE(f);
             }
@@ -3758,21 +4053,24 @@ void free_function_table(void)
     }
     
     /* Free the hash map using shallow free */
-    hm_free_shallow(function_map);
-    function_map = NULL;
+    hm_free_shallow(current_runtime->function_map);
+    current_runtime->function_map = NULL;
 }
 
-void reverse_parameter_list(Parameter **head)
+int function_parameters(const Function *func, Parameter *params[MAX_ARGUMENTS])
 {
-    Parameter *prev = NULL, *current = *head, *next = NULL;
-    while (current)
-    {
-        next = current->next;
-        current->next = prev;
-        prev = current;
-        current = next;
-    }
-    *head = prev;
+    // The parser builds the list last parameter first. Put it in order in
+    // a local array: the list belongs to the AST, which runs share.
+    int param_count = 0;
+    for (Parameter *p = func->parameters; p && param_count < MAX_ARGUMENTS; p = p->next)
+        params[param_count++] = p;
+    for (int i = 0; i < param_count / 2; i++)
+    {
+        Parameter *swap = params[i];
+        params[i] = params[param_count - 1 - i];
+        params[param_count - 1 - i] = swap;
+    }
+    return param_count;
 }
 
 void enter_function_scope(Function *func, ArgumentList *args)
@@ -3780,20 +4078,18 @@ void enter_function_scope(Function *func, ArgumentList *args)
     ArgumentList *curr_arg = args;
     Value arg_values[MAX_ARGUMENTS];
     int arg_count = 0;
-
-    // Reverse the parameter list
-    reverse_parameter_list(&func->parameters);
-    Parameter *curr_param = func->parameters;
+    Parameter *params[MAX_ARGUMENTS];
+    int param_count = function_parameters(func, params);
 
     // Evaluate argument values before creating the scope
-    while (curr_arg && curr_param)
+    while (curr_arg && arg_count < param_count)
     {
+        Parameter *curr_param = params[arg_count];
         arg_values[arg_count].pointer_level = curr_param->pointer_level;
         if (curr_param->pointer_level > 0)
         {
             arg_values[arg_count].pvalue = evaluate_expression_pointer(curr_arg->expr);
             curr_arg = curr_arg->next;
-            curr_param = curr_param->next;
             arg_count++;
             continue;
         }
@@ -3826,26 +4122,37 @@ void enter_function_scope(Function *func, ArgumentList *args)
         }
 
         curr_arg = curr_arg->next;
-        curr_param = curr_param->next;
         arg_count++;
     }
 
-    if (curr_arg || curr_param)
+    if (curr_arg || arg_count < param_count)
+    {
+        yyerror("Mismatched number of arguments and parameters");
+        return;
+    }
+
+    enter_function_scope_values(func, arg_values, arg_count);
+}
+
+void enter_function_scope_values(Function *func, const Value *arg_values, int arg_count)
+{
+    Parameter *params[MAX_ARGUMENTS];
+    if (function_parameters(func, params) != arg_count)
     {
         yyerror("Mismatched number of arguments and parameters");
         return;
     }
 
     // Create function scope after evaluating arguments
-    Scope *scope = create_scope(current_scope);
-    current_scope = scope;
-    current_scope->is_function_scope = true;
-    current_scope->function_name = func->name;
-    curr_param = func->parameters; // Reset parameter list after reversing
+    Scope *scope = create_scope(current_runtime->scope);
+    current_runtime->scope = scope;
+    current_runtime->scope->is_function_scope = true;
+    current_runtime->scope->function_name = func->name;
 
     // Assign evaluated values to function parameters
     for (int i = 0; i < arg_count; i++)
     {
+        Parameter *curr_param = params[i];
         Variable *var = variable_new(curr_param->name);
         var->var_type = curr_param->type;
         var->pointer_level = curr_param->pointer_level;
@@ -3861,7 +4168,6 @@ void enter_function_scope(Function *func, ArgumentList *args)
                 bound->pointer_level = curr_param->pointer_level;
                 bound->value.pvalue = arg_values[i].pvalue;
             }
-            curr_param = curr_param->next;
             continue;
         }
 
@@ -3892,30 +4198,28 @@ void enter_function_scope(Function *func, ArgumentList *args)
         case NONE:
             break;
         }
-        curr_param = curr_param->next;
     }
-    reverse_parameter_list(&func->parameters);
 }
 
 void register_struct_def(StructDef *def) {
-    if (!struct_registry) struct_registry = hm_new();
+    if (!current_runtime->struct_registry) current_runtime->struct_registry = hm_new();
     size_t len = def->name.len;
-    hm_put(struct_registry, def->name.data, len, def, sizeof(StructDef));
-    def->next_def = struct_registry_list;
-    struct_registry_list = def;
+    hm_put(current_runtime->struct_registry, def->name.data, len, def, sizeof(StructDef));
+    def->next_def = current_runtime->struct_registry_list;
+    current_runtime->struct_registry_list = def;
 }
 
 StructDef *get_struct_def(const String name) {
-    if (!struct_registry || !name.data) return NULL;
-    return (StructDef *)hm_get(struct_registry, name.data, name.len);
+    if (!current_runtime->struct_registry || !name.data) return NULL;
+    return (StructDef *)hm_get(current_runtime->struct_registry, name.data, name.len);
 }
 
 void free_struct_registry(void) {
-    if (struct_registry) {
-        hm_free_shallow(struct_registry);
-        struct_registry = NULL;
+    if (current_runtime->struct_registry) {
+        hm_free_shallow(current_runtime->struct_registry);
+        current_runtime->struct_registry = NULL;
     }
-    StructDef *def = struct_registry_list;
+    StructDef *def = current_runtime->struct_registry_list;
     while (def) {
         StructField *f = def->fields;
         while (f) {
@@ -3929,7 +4233,7 @@ void free_struct_registry(void) {
         SAFE_FREE(def);
         def = nxt;
     }
-    struct_registry_list = NULL;
+    current_runtime->struct_registry_list = NULL;
 }
 
 StructField *find_struct_field(StructDef *def, const String name) {
@@ -7,6 +7,7 @@
 #include "lib/arena.h"
 #include "lib/mem.h"
 #include "lib/string_value.h"
+#include "stdrot/stdrot_api.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -107,6 +108,24 @@ typedef struct Parameter
     struct Parameter *next;
 } Parameter;
 
+/* One entry of a squad loop's combo(...): every chunk of iterations
+ * accumulates into its own copy of name, and the copies are combined
+ * with op in chunk order afterwards */
+typedef enum
+{
+    REDUCE_SUM,
+    REDUCE_PRODUCT,
+    REDUCE_MIN,
+    REDUCE_MAX,
+} ReductionOp;
+
+typedef struct Reduction
+{
+    ReductionOp op;
+    String name;
+    struct Reduction *next;
+} Reduction;
+
 typedef struct Function
 {
     String  name;
@@ -157,6 +176,33 @@ typedef struct
     String struct_name;   /* non-NULL when var_type == VAR_STRUCT */
 } Variable;
 
+/* cap arrays are bit-packed: element i is bit i % 64 of the 64-bit word
+ * i / 64, and the bits past the last element are always zero. Elements
+ * have no address of their own, so they are read and written through
+ * these helpers instead of evaluate_multi_array_access(). */
+#define BOOL_ARRAY_WORDS(length) (((size_t)(length) + 63) / 64)
+
+static inline bool is_packed_bool_array(const Variable *var)
+{
+    return var->is_array && var->var_type == VAR_BOOL && var->pointer_level == 0;
+}
+
+static inline bool bool_array_get(const Variable *var, size_t index)
+{
+    const uint64_t *words = var->value.array_data;
+    return (words[index / 64] >> (index % 64)) & 1u;
+}
+
+static inline void bool_array_set(Variable *var, size_t index, bool value)
+{
+    uint64_t *words = var->value.array_data;
+    uint64_t bit = (uint64_t)1 << (index % 64);
+    if (value)
+        words[index / 64] |= bit;
+    else
+        words[index / 64] &= ~bit;
+}
+
 typedef union
 {
     VarType type;
@@ -319,6 +365,8 @@ struct ASTNode
             ASTNode *cond;
             ASTNode *incr;
             ASTNode *body;
+            bool squad;            /* iterations run on the thread pool */
+            Reduction *reductions; /* combo(...) of a squad loop */
         } for_stmt;
         struct
         {
@@ -329,6 +377,9 @@ struct ASTNode
         {
             String function_name;
             ArgumentList *arguments;
+            StdrotFn builtin_fn; /* bound once, NULL for user functions */
+            unsigned builtin_flags; /* StdrotEntry.flags of builtin_fn */
+            const StdrotFormat *format; /* precompiled literal format, if any */
         } func_call;
         StatementList *statements;
         IfStatementNode if_stmt;
@@ -360,12 +411,59 @@ typedef struct Scope
     String function_name;    
 } Scope;
 
-/* Global variable declarations */
-extern TypeModifiers current_modifiers;
-extern Scope *current_scope;
-extern HashMap *function_map;
-extern ReturnValue current_return_value;
-extern JumpBuffer *jump_buffer;
+/* Execution state of one program. A thread runs at most one program at a
+ * time, the one current_runtime points at, so independent programs can run
+ * concurrently on separate threads.
+ *
+ * Parsing fills a runtime too: besides the AST it declares arrays and gang
+ * variables and registers gang definitions. A compiled program keeps that
+ * runtime untouched, and each run executes in a runtime_clone() of it. */
+typedef struct Runtime
+{
+    Arena arena;                   /* AST nodes and strings */
+    int line_number;               /* lexer line, what yyerror() reports */
+    Scope *scope;                  /* innermost execution scope */
+    JumpBuffer *jump_buffer;       /* targets for break and bussin */
+    HashMap *function_map;         /* user-defined functions by name */
+    HashMap *static_variable_map;  /* "function::name" -> static variable */
+    HashMap *struct_registry;      /* gang definitions by name */
+    StructDef *struct_registry_list;
+    ReturnValue return_value;      /* value of the last bussin */
+    struct Interpreter *interpreter;
+    ExecutionContext exec_context; /* builtin call in progress */
+    Value promoted_value;          /* scratch result of handle_identifier() */
+    struct TaskGroup *tasks;       /* tasks the program spawned, see tasks.h */
+    jmp_buf *exit_jump;            /* where runtime_exit() lands, if set */
+    int exit_status;
+    bool borrows_structs;          /* struct registry belongs to the program */
+} Runtime;
+
+extern _Thread_local Runtime *current_runtime;
+
+Runtime *runtime_new(void);
+Runtime *runtime_clone(const Runtime *program);
+void runtime_free(Runtime *runtime);
+
+/* A runtime for a thread helping to run a squad loop of program: it
+ * executes on top of program's current scope and shares its statics, gang
+ * definitions and builtin handles, all of which it only reads */
+Runtime *runtime_worker(const Runtime *program);
+void runtime_worker_free(Runtime *runtime);
+
+/* A runtime for a task of program (see tasks.h): it starts with an empty
+ * scope and its own statics and builtin objects, and shares the program's
+ * functions, gang definitions and I/O */
+Runtime *runtime_task(const Runtime *program);
+void runtime_task_free(Runtime *runtime);
+
+/* Where the current program's diagnostics go: stderr unless it was run
+ * with a BrIO that takes them */
+FILE *runtime_stderr(void);
+
+/* Ends the current program with status. With exit_jump set this longjmps
+ * back to whoever started the program (see br_run()); otherwise it exits. */
+__attribute__((noreturn)) void runtime_exit(int status);
+
 /* Function prototypes */
 bool set_int_variable(const String name, int value, TypeModifiers mods);
 bool set_array_variable(String name, int length, TypeModifiers mods, VarType type);
@@ -378,6 +476,7 @@ TypeModifiers get_current_modifiers(void);
 Variable *get_variable(const String name);
 Scope *create_scope(Scope *parent);
 void enter_function_scope(Function *func, ArgumentList *args);
+void enter_function_scope_values(Function *func, const Value *args, int argc);
 void exit_scope();
 void enter_scope();
 void free_scope(Scope *scope);
@@ -404,6 +503,8 @@ ASTNode *create_declaration_node_ex(String name, ASTNode *expr, int pointer_leve
 ASTNode *create_operation_node(OperatorType op, ASTNode *left, ASTNode *right);
 ASTNode *create_unary_operation_node(OperatorType op, ASTNode *operand);
 ASTNode *create_for_statement_node(ASTNode *init, ASTNode *cond, ASTNode *incr, ASTNode *body);
+ASTNode *create_squad_statement_node(ASTNode *init, ASTNode *cond, ASTNode *incr, ASTNode *body, Reduction *reductions);
+Reduction *create_reduction(ReductionOp op, String name, Reduction *next);
 ASTNode *create_while_statement_node(ASTNode *cond, ASTNode *body);
 ASTNode *create_do_while_statement_node(ASTNode *cond, ASTNode *body);
 ASTNode *create_function_call_node(String func_name, ArgumentList *args);
@@ -425,10 +526,12 @@ ExpressionList *create_expression_list(ASTNode *expr);
 ExpressionList *append_expression_list(ExpressionList *list, ASTNode *expr);
 void free_expression_list(ExpressionList *list);
 void populate_multi_array_variable(String name, ExpressionList *list, int dimensions[], int num_dimensions);
-void free_ast(void);
 
 /* Evaluation and execution functions */
 void *evaluate_array_access(ASTNode *node);
+void *evaluate_multi_array_access(ASTNode *node);
+Variable *resolve_array_element(ASTNode *node, size_t *offset);
+void *array_element_address(Variable *var, size_t offset);
 double evaluate_expression_double(ASTNode *node);
 float evaluate_expression_float(ASTNode *node);
 int evaluate_expression_int(ASTNode *node);
@@ -467,6 +570,11 @@ Function *create_function_ex(String name, VarType return_type, int return_pointe
 Parameter *create_parameter(String name, VarType type, Parameter *next, TypeModifiers mods);
 Parameter *create_parameter_ex(String name, VarType type, int pointer_level, Parameter *next, TypeModifiers mods);
 void execute_function_call(const String name, ArgumentList *args);
+/* Calls func with arguments already evaluated for its parameters, in order;
+ * its bussin value is left in current_runtime->return_value */
+void call_function_values(Function *func, const Value *args, int argc);
+/* Fills params with func's parameters in order and returns how many */
+int function_parameters(const Function *func, Parameter *params[MAX_ARGUMENTS]);
 ASTNode *create_function_def_node(String name, VarType return_type, Parameter *params, ASTNode *body);
 ASTNode *create_function_def_node_ex(String name, VarType return_type, int return_pointer_level, Parameter *params, ASTNode *body);
 void handle_return_statement(ASTNode *expr);
@@ -485,13 +593,16 @@ ASTNode *create_struct_access_node(ASTNode *object, String member);
 void    *evaluate_struct_member_address(ASTNode *node);
 void populate_struct_variable(const String name, ExpressionList *list);
 
-extern TypeModifiers current_modifiers;
-
-extern Arena arena;
+/* Parser state shared by the grammar actions and the node constructors.
+ * Each thread parses one program at a time, so these are per thread. */
+extern _Thread_local TypeModifiers current_modifiers;
+extern _Thread_local VarType current_var_type;
 
-#define ARENA_ALLOC(type) arena_alloc(&arena, sizeof(type))
+/* Nodes and strings live in the arena of the runtime that creates them:
+ * the program's own for the AST, a run's for values made while running */
+#define ARENA_ALLOC(type) arena_alloc(&current_runtime->arena, sizeof(type))
 #define ARENA_ALLOC_ASTNODE() arena_alloc_astnode()
-#define ARENA_STRDUP(str) arena_strdup(&arena, str)
+#define ARENA_STRDUP(str) arena_strdup(&current_runtime->arena, str)
 
 /* Macros for assigning specific fields to a node */
 #define SET_DATA_INT(node, value) ((node)->data.ivalue = (value))
@@ -537,6 +648,9 @@ extern Arena arena;
     {                                                                  \
         (node)->data.func_call.function_name = ARENA_STRDUP(func_name); \
         (node)->data.func_call.arguments = (args);                     \
+        (node)->data.func_call.builtin_fn = NULL;                      \
+        (node)->data.func_call.builtin_flags = 0;                      \
+        (node)->data.func_call.format = NULL;                          \
     } while (0)
 
 /* Macros for handling jump buffer */
@@ -544,41 +658,41 @@ extern Arena arena;
     do                                            \
     {                                             \
         JumpBuffer *jb = SAFE_MALLOC(JumpBuffer); \
-        jb->next = jump_buffer;                   \
-        jump_buffer = jb;                         \
+        jb->next = current_runtime->jump_buffer;  \
+        current_runtime->jump_buffer = jb;        \
     } while (0)
 
-#define POP_JUMP_BUFFER()                \
-    do                                   \
-    {                                    \
-        JumpBuffer *jb = jump_buffer;    \
-        jump_buffer = jump_buffer->next; \
-        SAFE_FREE(jb);                   \
+#define POP_JUMP_BUFFER()                              \
+    do                                                 \
+    {                                                  \
+        JumpBuffer *jb = current_runtime->jump_buffer; \
+        current_runtime->jump_buffer = jb->next;       \
+        SAFE_FREE(jb);                                 \
     } while (0)
 
-#define LONGJMP()                                \
-    do                                           \
-    {                                            \
-        if (jump_buffer != NULL)                 \
-        {                                        \
-            longjmp(jump_buffer->data, 1);       \
-        }                                        \
-        else                                     \
-        {                                        \
-            yyerror("No jump buffer available"); \
-            exit(1);                             \
-        }                                        \
+#define LONGJMP()                                           \
+    do                                                      \
+    {                                                       \
+        if (current_runtime->jump_buffer != NULL)           \
+        {                                                   \
+            longjmp(current_runtime->jump_buffer->data, 1); \
+        }                                                   \
+        else                                                \
+        {                                                   \
+            yyerror("No jump buffer available");            \
+            exit(1);                                        \
+        }                                                   \
     } while (0)
 
-#define CURRENT_JUMP_BUFFER() (jump_buffer->data)
+#define CURRENT_JUMP_BUFFER() (current_runtime->jump_buffer->data)
 
-#define CLEAN_JUMP_BUFFER() \
-    do                      \
-    {                       \
-        while (jump_buffer) \
-        {                    \
-            POP_JUMP_BUFFER(); \
-        }                    \
+#define CLEAN_JUMP_BUFFER()                  \
+    do                                       \
+    {                                        \
+        while (current_runtime->jump_buffer) \
+        {                                    \
+            POP_JUMP_BUFFER();               \
+        }                                    \
     } while (0)
 
 #define VART_TO_NODET(var_type) \
@@ -0,0 +1,616 @@
+/* batch.c - In-process batch runner for test manifests, see batch.h */
+
+#define _GNU_SOURCE /* close_range */
+
+#include "batch.h"
+#include "brainrot.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <libgen.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} Buffer;
+
+typedef struct {
+    char *name;
+    Buffer expected;
+    Buffer input;
+    size_t input_read;
+    Buffer out;
+    Buffer err;
+    Buffer actual; /* what was compared against expected */
+    int status;
+    double seconds;
+    bool timed_out;
+    bool matched; /* the output was right, if not the status */
+    bool passed;
+} Case;
+
+typedef struct {
+    Case *cases;
+    size_t count;
+    size_t next; /* the next case a worker takes */
+    const char *cases_dir;
+    bool isolate;
+    double timeout; /* seconds, 0 for none */
+} Batch;
+
+static bool append(Buffer *buf, const char *data, size_t len)
+{
+    if (buf->len + len + 1 > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 256;
+        while (buf->len + len + 1 > capacity) capacity *= 2;
+        char *grown = realloc(buf->data, capacity);
+        if (!grown) return false;
+        buf->data = grown;
+        buf->capacity = capacity;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+    return true;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* The whole file at path into buf; false with errno set if it cannot */
+static bool read_file(const char *path, Buffer *buf)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    char chunk[8192];
+    size_t n;
+    bool ok = true;
+    while (ok && (n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        ok = append(buf, chunk, n);
+    }
+    ok = ok && !ferror(file);
+    fclose(file);
+    if (ok && !buf->data) ok = append(buf, "", 0);
+    return ok;
+}
+
+/* ── Manifest ────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    const char *p;
+    const char *end;
+} Json;
+
+static void skip_space(Json *json)
+{
+    while (json->p < json->end && isspace((unsigned char)*json->p)) json->p++;
+}
+
+static bool expect(Json *json, char c)
+{
+    skip_space(json);
+    if (json->p == json->end || *json->p != c) return false;
+    json->p++;
+    return true;
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool parse_hex4(Json *json, unsigned *code)
+{
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = json->p < json->end ? hex_digit(*json->p++) : -1;
+        if (digit < 0) return false;
+        *code = *code << 4 | (unsigned)digit;
+    }
+    return true;
+}
+
+static bool append_utf8(Buffer *buf, unsigned code)
+{
+    char bytes[4];
+    size_t len;
+    if (code < 0x80) {
+        bytes[0] = (char)code;
+        len = 1;
+    } else if (code < 0x800) {
+        bytes[0] = (char)(0xC0 | code >> 6);
+        bytes[1] = (char)(0x80 | (code & 0x3F));
+        len = 2;
+    } else if (code < 0x10000) {
+        bytes[0] = (char)(0xE0 | code >> 12);
+        bytes[1] = (char)(0x80 | (code >> 6 & 0x3F));
+        bytes[2] = (char)(0x80 | (code & 0x3F));
+        len = 3;
+    } else {
+        bytes[0] = (char)(0xF0 | code >> 18);
+        bytes[1] = (char)(0x80 | (code >> 12 & 0x3F));
+        bytes[2] = (char)(0x80 | (code >> 6 & 0x3F));
+        bytes[3] = (char)(0x80 | (code & 0x3F));
+        len = 4;
+    }
+    return append(buf, bytes, len);
+}
+
+static bool parse_string(Json *json, Buffer *out)
+{
+    if (!expect(json, '"') || !append(out, "", 0)) return false;
+    while (json->p < json->end && *json->p != '"') {
+        char c = *json->p++;
+        if (c != '\\') {
+            if (!append(out, &c, 1)) return false;
+            continue;
+        }
+        if (json->p == json->end) return false;
+        unsigned code;
+        switch (*json->p++) {
+        case '"': code = '"'; break;
+        case '\\': code = '\\'; break;
+        case '/': code = '/'; break;
+        case 'b': code = '\b'; break;
+        case 'f': code = '\f'; break;
+        case 'n': code = '\n'; break;
+        case 'r': code = '\r'; break;
+        case 't': code = '\t'; break;
+        case 'u': {
+            if (!parse_hex4(json, &code)) return false;
+            unsigned low;
+            if (code >= 0xD800 && code < 0xDC00 && json->end - json->p >= 6 && json->p[0] == '\\' &&
+                json->p[1] == 'u') {
+                json->p += 2;
+                if (!parse_hex4(json, &low) || low < 0xDC00 || low > 0xDFFF) return false;
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        if (!append_utf8(out, code)) return false;
+    }
+    return expect(json, '"');
+}
+
+/* The cases of a manifest: one JSON object of names to expected output */
+static bool parse_manifest(const char *path, const Buffer *text, Batch *batch)
+{
+    Json json = { text->data, text->data + text->len };
+    size_t capacity = 0;
+    bool ok = expect(&json, '{');
+    skip_space(&json);
+    if (ok && json.p < json.end && *json.p == '}') {
+        json.p++;
+    } else {
+        while (ok) {
+            if (batch->count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                Case *grown = realloc(batch->cases, capacity * sizeof(Case));
+                if (!grown) break;
+                batch->cases = grown;
+            }
+            Case *c = &batch->cases[batch->count];
+            memset(c, 0, sizeof(Case));
+            Buffer name = {0};
+            ok = parse_string(&json, &name) && expect(&json, ':') && parse_string(&json, &c->expected);
+            c->name = name.data;
+            batch->count++;
+            if (!ok || expect(&json, '}')) break;
+            ok = expect(&json, ',');
+        }
+        skip_space(&json);
+        ok = ok && json.p == json.end;
+    }
+    if (!ok) {
+        fprintf(stderr, "Error: %s is not a JSON object of strings (at byte %zu)\n", path,
+                (size_t)(json.p - text->data));
+    }
+    return ok;
+}
+
+/* ── Running ─────────────────────────────────────────────────────────────── */
+
+static size_t write_output(void *user, const char *data, size_t len)
+{
+    return append(&((Case *)user)->out, data, len) ? len : 0;
+}
+
+static size_t write_errors(void *user, const char *data, size_t len)
+{
+    return append(&((Case *)user)->err, data, len) ? len : 0;
+}
+
+static size_t read_input(void *user, char *buf, size_t len)
+{
+    Case *c = user;
+    size_t left = c->input.len - c->input_read;
+    size_t n = len < left ? len : left;
+    if (n == 0) return 0;
+    memcpy(buf, c->input.data + c->input_read, n);
+    c->input_read += n;
+    return n;
+}
+
+/* data without its leading and trailing whitespace, like Python's strip() */
+static const char *strip(const char *data, size_t *len)
+{
+    if (!data) {
+        *len = 0;
+        return "";
+    }
+    while (*len > 0 && isspace((unsigned char)*data)) {
+        data++;
+        (*len)--;
+    }
+    while (*len > 0 && isspace((unsigned char)data[*len - 1])) (*len)--;
+    return data;
+}
+
+/* Compares a finished case the way tests/test_brainrot.py does */
+static bool check(Case *c)
+{
+    size_t out_len = c->out.len, err_len = c->err.len, expected_len = c->expected.len;
+    const char *out = strip(c->out.data, &out_len);
+    const char *err = strip(c->err.data, &err_len);
+    const char *expected = strip(c->expected.data, &expected_len);
+    bool expects_error = strstr(c->expected.data, "Error:") != NULL;
+
+    if (out_len == 0) {
+        append(&c->actual, err, err_len);
+    } else {
+        append(&c->actual, out, out_len);
+        if (strstr(c->expected.data, "Stderr:")) {
+            append(&c->actual, "\nStderr:\n", 9);
+            append(&c->actual, err, err_len);
+        }
+    }
+    if (!c->actual.data) append(&c->actual, "", 0);
+
+    c->matched = c->actual.len == expected_len && memcmp(c->actual.data, expected, expected_len) == 0;
+    return c->matched && !c->timed_out && (expects_error || c->status == 0);
+}
+
+static bool write_fd(int fd, const char *data, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static size_t write_child_output(void *user, const char *data, size_t len)
+{
+    (void)user;
+    return write_fd(STDOUT_FILENO, data, len) ? len : 0;
+}
+
+static size_t write_child_errors(void *user, const char *data, size_t len)
+{
+    (void)user;
+    return write_fd(STDERR_FILENO, data, len) ? len : 0;
+}
+
+/* Runs program in a child process writing to pipes, collects its output
+ * and diagnostics, and kills it once the batch's timeout has passed since
+ * start. Returns its exit status. */
+static int run_isolated(const Batch *batch, Case *c, BrProgram *program, double start)
+{
+    int out[2], err[2];
+    if (pipe(out) != 0) {
+        out[0] = out[1] = -1;
+    } else if (pipe(err) != 0) {
+        close(out[0]);
+        close(out[1]);
+        out[0] = out[1] = -1;
+    }
+    pid_t child = out[0] >= 0 ? fork() : -1;
+    if (child < 0) {
+        const char *reason = strerror(errno);
+        append(&c->err, "Error: cannot start a child process: ", 37);
+        append(&c->err, reason, strlen(reason));
+        append(&c->err, "\n", 1);
+        if (out[0] >= 0) {
+            close(out[0]);
+            close(out[1]);
+            close(err[0]);
+            close(err[1]);
+        }
+        return 1;
+    }
+    if (child == 0) {
+        dup2(out[1], STDOUT_FILENO);
+        dup2(err[1], STDERR_FILENO);
+        /* The pipes of the cases other workers are running must not stay
+         * open in here, or they would not see the end of their output */
+        close_range(3, ~0U, 0);
+        BrIO io = { .write = write_child_output, .read = read_input, .user = c, .write_error = write_child_errors };
+        _exit(br_run(program, &io));
+    }
+    close(out[1]);
+    close(err[1]);
+
+    struct pollfd fds[2] = { { .fd = out[0], .events = POLLIN }, { .fd = err[0], .events = POLLIN } };
+    Buffer *into[2] = { &c->out, &c->err };
+    while (fds[0].fd >= 0 || fds[1].fd >= 0) {
+        int wait_ms = -1;
+        if (batch->timeout > 0) {
+            double left = start + batch->timeout - now();
+            if (left <= 0) {
+                kill(child, SIGKILL);
+                c->timed_out = true;
+                break;
+            }
+            wait_ms = (int)(left * 1000) + 1;
+        }
+        if (poll(fds, 2, wait_ms) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].fd < 0 || !fds[i].revents) continue;
+            char chunk[8192];
+            ssize_t n = read(fds[i].fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                append(into[i], chunk, (size_t)n);
+            } else if (n == 0 || errno != EINTR) {
+                close(fds[i].fd);
+                fds[i].fd = -1;
+            }
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        if (fds[i].fd >= 0) close(fds[i].fd);
+    }
+
+    int status;
+    while (waitpid(child, &status, 0) < 0) {
+        if (errno != EINTR) return 1;
+    }
+    char message[80];
+    if (c->timed_out) {
+        int len = snprintf(message, sizeof(message), "Error: timed out after %g s\n", batch->timeout);
+        append(&c->err, message, (size_t)len);
+        return 128 + SIGKILL;
+    }
+    if (WIFSIGNALED(status)) {
+        int len = snprintf(message, sizeof(message), "Error: the program was killed by signal %d\n", WTERMSIG(status));
+        append(&c->err, message, (size_t)len);
+        return 128 + WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
+
+static void run_case(const Batch *batch, Case *c)
+{
+    double start = now();
+    BrIO io = { .write = write_output, .read = read_input, .user = c, .write_error = write_errors };
+
+    size_t path_len = strlen(batch->cases_dir) + strlen(c->name) + sizeof("/.brainrot");
+    char *path = malloc(path_len);
+    Buffer source = {0};
+    if (!path) {
+        append(&c->err, "Error: out of memory\n", 21);
+        c->status = 1;
+    } else {
+        snprintf(path, path_len, "%s/%s.input", batch->cases_dir, c->name);
+        if (!read_file(path, &c->input)) c->input.len = 0;
+        snprintf(path, path_len, "%s/%s.brainrot", batch->cases_dir, c->name);
+        if (!read_file(path, &source)) {
+            const char *reason = strerror(errno);
+            append(&c->err, "Cannot open source file: ", 25);
+            append(&c->err, reason, strlen(reason));
+            append(&c->err, "\n", 1);
+            c->status = 1;
+        } else {
+            BrProgram *program = br_compile_io(source.data, source.len, &io);
+            if (!program) c->status = 1;
+            else c->status = batch->isolate ? run_isolated(batch, c, program, start) : br_run(program, &io);
+            br_free(program);
+        }
+    }
+    free(path);
+    free(source.data);
+
+    c->passed = check(c);
+    c->seconds = now() - start;
+}
+
+static void *batch_worker(void *arg)
+{
+    Batch *batch = arg;
+    for (;;) {
+        size_t i = __atomic_fetch_add(&batch->next, 1, __ATOMIC_RELAXED);
+        if (i >= batch->count) return NULL;
+        run_case(batch, &batch->cases[i]);
+    }
+}
+
+/* ── Reports ─────────────────────────────────────────────────────────────── */
+
+static void json_string(FILE *out, const char *data, size_t len)
+{
+    fputc('"', out);
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)data[i];
+        switch (c) {
+        case '"': fputs("\\\"", out); break;
+        case '\\': fputs("\\\\", out); break;
+        case '\n': fputs("\\n", out); break;
+        case '\r': fputs("\\r", out); break;
+        case '\t': fputs("\\t", out); break;
+        default:
+            if (c < 0x20) fprintf(out, "\\u%04x", c);
+            else fputc(c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void report_json(FILE *out, const char *manifest, const Batch *batch, size_t failed, double seconds)
+{
+    fputs("{\"manifest\": ", out);
+    json_string(out, manifest, strlen(manifest));
+    fprintf(out, ", \"tests\": %zu, \"passed\": %zu, \"failed\": %zu, \"time\": %.3f, \"cases\": [",
+            batch->count, batch->count - failed, failed, seconds);
+    for (size_t i = 0; i < batch->count; i++) {
+        const Case *c = &batch->cases[i];
+        fputs(i ? ",\n  {\"name\": " : "\n  {\"name\": ", out);
+        json_string(out, c->name, strlen(c->name));
+        fprintf(out, ", \"passed\": %s, \"status\": %d, \"time\": %.6f", c->passed ? "true" : "false", c->status,
+                c->seconds);
+        if (c->timed_out) fputs(", \"timed_out\": true", out);
+        if (!c->passed) {
+            fputs(", \"expected\": ", out);
+            json_string(out, c->expected.data, c->expected.len);
+            fputs(", \"actual\": ", out);
+            json_string(out, c->actual.data, c->actual.len);
+        }
+        fputc('}', out);
+    }
+    fputs("\n]}\n", out);
+}
+
+static void xml_text(FILE *out, const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)data[i];
+        switch (c) {
+        case '&': fputs("&amp;", out); break;
+        case '<': fputs("&lt;", out); break;
+        case '>': fputs("&gt;", out); break;
+        case '"': fputs("&quot;", out); break;
+        default:
+            /* XML 1.0 has no way to write the other control characters */
+            fputc(c < 0x20 && c != '\n' && c != '\r' && c != '\t' ? '?' : c, out);
+        }
+    }
+}
+
+static void report_junit(FILE *out, const char *manifest, const Batch *batch, size_t failed, double seconds)
+{
+    char *copy = strdup(manifest);
+    const char *suite = copy ? basename(copy) : manifest;
+    fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuite name=\"", out);
+    xml_text(out, suite, strlen(suite));
+    fprintf(out, "\" tests=\"%zu\" failures=\"%zu\" time=\"%.3f\">\n", batch->count, failed, seconds);
+    for (size_t i = 0; i < batch->count; i++) {
+        const Case *c = &batch->cases[i];
+        fputs("  <testcase classname=\"", out);
+        xml_text(out, suite, strlen(suite));
+        fputs("\" name=\"", out);
+        xml_text(out, c->name, strlen(c->name));
+        fprintf(out, "\" time=\"%.6f\"", c->seconds);
+        if (c->passed) {
+            fputs("/>\n", out);
+            continue;
+        }
+        if (c->timed_out) {
+            fprintf(out, ">\n    <failure message=\"timed out after %g s\">Expected:\n", batch->timeout);
+        } else if (c->matched) {
+            fprintf(out, ">\n    <failure message=\"exited with status %d\">Expected:\n", c->status);
+        } else {
+            fputs(">\n    <failure message=\"output did not match\">Expected:\n", out);
+        }
+        xml_text(out, c->expected.data, c->expected.len);
+        fputs("\nActual:\n", out);
+        xml_text(out, c->actual.data, c->actual.len);
+        fputs("</failure>\n  </testcase>\n", out);
+    }
+    fputs("</testsuite>\n", out);
+    free(copy);
+}
+
+int batch_run(const char *manifest_path, const char *cases_dir, int threads, BatchReport report, bool isolate,
+              double timeout)
+{
+    Buffer text = {0};
+    if (!read_file(manifest_path, &text)) {
+        fprintf(stderr, "Error: cannot read %s: %s\n", manifest_path, strerror(errno));
+        return 1;
+    }
+    Batch batch = {0};
+    char *default_dir = NULL;
+    bool ok = parse_manifest(manifest_path, &text, &batch);
+    free(text.data);
+
+    if (ok && !cases_dir) {
+        /* tests/expected_results.json -> tests/../test_cases */
+        char *copy = strdup(manifest_path);
+        const char *dir = copy ? dirname(copy) : ".";
+        size_t len = strlen(dir) + sizeof("/../test_cases");
+        default_dir = malloc(len);
+        if (default_dir) snprintf(default_dir, len, "%s/../test_cases", dir);
+        free(copy);
+        cases_dir = default_dir;
+        ok = default_dir != NULL;
+    }
+
+    size_t failed = 0;
+    if (ok) {
+        batch.cases_dir = cases_dir;
+        batch.isolate = isolate || timeout > 0;
+        batch.timeout = timeout;
+        if (threads <= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            threads = cpus > 0 ? (int)cpus : 1;
+        }
+        if ((size_t)threads > batch.count) threads = batch.count > 0 ? (int)batch.count : 1;
+
+        double start = now();
+        pthread_t *workers = calloc((size_t)threads, sizeof(pthread_t));
+        int started = 0;
+        while (workers && started < threads - 1 && pthread_create(&workers[started], NULL, batch_worker, &batch) == 0) {
+            started++;
+        }
+        /* The calling thread is the last worker */
+        batch_worker(&batch);
+        for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+        free(workers);
+        double seconds = now() - start;
+
+        for (size_t i = 0; i < batch.count; i++) failed += !batch.cases[i].passed;
+        if (report == BATCH_REPORT_JUNIT) report_junit(stdout, manifest_path, &batch, failed, seconds);
+        else report_json(stdout, manifest_path, &batch, failed, seconds);
+        fflush(stdout);
+        fprintf(stderr, "%zu passed, %zu failed in %.2fs on %d threads\n", batch.count - failed, failed, seconds,
+                threads);
+    }
+
+    for (size_t i = 0; i < batch.count; i++) {
+        Case *c = &batch.cases[i];
+        free(c->name);
+        free(c->expected.data);
+        free(c->input.data);
+        free(c->out.data);
+        free(c->err.data);
+        free(c->actual.data);
+    }
+    free(batch.cases);
+    free(default_dir);
+    return ok && failed == 0 ? 0 : 1;
+}
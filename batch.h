@@ -0,0 +1,39 @@
+/* batch.h – In-process batch runner for test manifests
+ *
+ *     brainrot --batch tests/expected_results.json --threads=8 --report=junit
+ *
+ * A manifest is a JSON object mapping case names to their expected output,
+ * like tests/expected_results.json. Case <name> is the script
+ * <cases>/<name>.brainrot, read with <cases>/<name>.input as its input if
+ * that file exists and with no input otherwise. <cases> defaults to the
+ * test_cases directory next to the manifest's directory.
+ *
+ * Cases run on worker threads inside this process, each compiled and run
+ * through the embedding API in a runtime of its own, with its output and
+ * diagnostics captured in memory. A case passes under the same rules as
+ * tests/test_brainrot.py: its trimmed output (or its diagnostics, if it
+ * printed nothing) must match the expected output, and it must exit with 0
+ * unless an error is expected.
+ *
+ * With isolate, or a timeout, each case still compiles in this process but
+ * runs in a forked child, so that a crash only fails that case. A case
+ * still running timeout seconds after it started is killed and fails.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+
+typedef enum {
+    BATCH_REPORT_JSON,
+    BATCH_REPORT_JUNIT,
+} BatchReport;
+
+/* Runs every case of the manifest at manifest_path on threads threads (one
+ * per CPU if 0), writes the report to stdout and a summary to stderr.
+ * cases_dir may be NULL for the default. Returns 0 if every case passed. */
+int batch_run(const char *manifest_path, const char *cases_dir, int threads, BatchReport report, bool isolate,
+              double timeout);
+
+#endif /* BATCH_H */
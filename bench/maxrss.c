@@ -0,0 +1,46 @@
+/* maxrss.c - Runs a command and reports its peak resident set size
+ *
+ *     bench/maxrss bench/brainrot bench/fib.brainrot
+ *
+ * Prints "maxrss_kb <n>" to stderr once the command has exited, and exits
+ * with its status. bench/run.py measures through this instead of waiting on
+ * the workload itself: a child's ru_maxrss starts from the high-water mark
+ * of the process that forked it, and a Python parent's would dwarf most
+ * workloads'.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s command [argument...]\n", argv[0]);
+        return 2;
+    }
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 2;
+    }
+    if (child == 0) {
+        execvp(argv[1], argv + 1);
+        perror(argv[1]);
+        _exit(127);
+    }
+
+    int status;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) < 0) {
+        perror("wait4");
+        return 2;
+    }
+    fprintf(stderr, "maxrss_kb %ld\n", usage.ru_maxrss);
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
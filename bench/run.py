@@ -0,0 +1,150 @@
+"""Runs the bench/*.brainrot workloads and reports their cost as JSON.
+
+    python3 bench/run.py --binary bench/brainrot --runs 10 --output bench/results.json
+    python3 bench/run.py --binary bench/brainrot --compare bench/baseline.json --threshold 5
+
+Each workload runs once to warm the page cache and then --runs times. The
+report gives the median and 95th percentile wall time, the peak resident set
+size if the bench/maxrss launcher is built, and the instructions retired if
+`perf` is installed (null otherwise). With --compare, the run is checked
+against a saved report and the script exits with 1 if any workload got
+slower, used more memory, or executed more instructions, by more than
+--threshold percent.
+"""
+
+import argparse
+import json
+import math
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+bench_dir = os.path.dirname(os.path.abspath(__file__))
+
+
+def run_once(binary, script, launcher):
+    """Wall seconds and peak RSS in KiB (None without the launcher) of one run.
+    The RSS comes from the launcher: the ru_maxrss of a child of this script
+    would include the Python interpreter's own peak."""
+    command = [launcher, binary, script] if launcher else [binary, script]
+    start = time.perf_counter()
+    result = subprocess.run(command, stdin=subprocess.DEVNULL, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    seconds = time.perf_counter() - start
+    lines = result.stderr.decode().splitlines()
+    rss = None
+    if launcher and lines and lines[-1].startswith("maxrss_kb "):
+        rss = int(lines.pop().split()[1])
+    if result.returncode != 0:
+        sys.exit(f"{os.path.basename(script)} exited with {result.returncode}:\n" + "\n".join(lines))
+    return seconds, rss
+
+
+def count_instructions(binary, script):
+    """User-space instructions retired by one run, or None without perf"""
+    if not shutil.which("perf"):
+        return None
+    with tempfile.NamedTemporaryFile("r", suffix=".csv") as counters:
+        result = subprocess.run(["perf", "stat", "-x", ",", "-e", "instructions:u", "-o", counters.name,
+                                 binary, script], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        if result.returncode != 0:
+            return None
+        for line in counters.read().splitlines():
+            fields = line.split(",")
+            if len(fields) > 2 and fields[2].startswith("instructions") and fields[0].isdigit():
+                return int(fields[0])
+    return None
+
+
+def percentile(values, fraction):
+    """Nearest-rank percentile"""
+    ordered = sorted(values)
+    return ordered[max(0, math.ceil(fraction * len(ordered)) - 1)]
+
+
+def measure(binary, names, runs, launcher):
+    benchmarks = {}
+    for name in names:
+        script = os.path.join(bench_dir, f"{name}.brainrot")
+        run_once(binary, script, launcher)
+        samples = [run_once(binary, script, launcher) for _ in range(runs)]
+        times = [seconds * 1000 for seconds, _ in samples]
+        rss = [kib for _, kib in samples if kib is not None]
+        benchmarks[name] = {
+            "median_ms": round(statistics.median(times), 3),
+            "p95_ms": round(percentile(times, 0.95), 3),
+            "min_ms": round(min(times), 3),
+            "instructions": count_instructions(binary, script),
+            "peak_rss_kb": max(rss) if rss else None,
+        }
+        print(f"{name:16} median {benchmarks[name]['median_ms']:9.2f} ms  "
+              f"p95 {benchmarks[name]['p95_ms']:9.2f} ms  "
+              f"rss {benchmarks[name]['peak_rss_kb'] or '-':>7} KiB", file=sys.stderr)
+    return benchmarks
+
+
+def compare(baseline, benchmarks, threshold):
+    """Prints the change of every workload; returns the names that regressed"""
+    regressed = []
+    for name, now in benchmarks.items():
+        before = baseline.get(name)
+        if not before:
+            print(f"{name:16} (not in the baseline)", file=sys.stderr)
+            continue
+        changes = [("time", before["median_ms"], now["median_ms"])]
+        for metric, key in [("instructions", "instructions"), ("peak rss kb", "peak_rss_kb")]:
+            if before.get(key) and now.get(key):
+                changes.append((metric, before[key], now[key]))
+        verdict = "ok"
+        for metric, old, new in changes:
+            change = (new - old) / old * 100 if old else 0.0
+            print(f"{name:16} {metric:12} {old:>14} -> {new:>14}  {change:+6.1f}%", file=sys.stderr)
+            if change > threshold:
+                verdict = "REGRESSION"
+        if verdict != "ok":
+            regressed.append(name)
+            print(f"{name:16} {verdict}", file=sys.stderr)
+    return regressed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--binary", default=os.path.join(bench_dir, "brainrot"))
+    parser.add_argument("--launcher", default=os.path.join(bench_dir, "maxrss"),
+                        help="runs each workload and reports its peak RSS (bench/maxrss.c)")
+    parser.add_argument("--runs", type=int, default=10)
+    parser.add_argument("--output", help="write the report here instead of stdout")
+    parser.add_argument("--compare", metavar="BASELINE", help="a report to check this run against")
+    parser.add_argument("--threshold", type=float, default=5.0, help="allowed regression in percent")
+    parser.add_argument("names", nargs="*", help="workloads to run (default: all)")
+    args = parser.parse_args()
+
+    names = args.names or sorted(file[:-len(".brainrot")] for file in os.listdir(bench_dir)
+                                 if file.endswith(".brainrot"))
+    binary = os.path.abspath(args.binary)
+    launcher = os.path.abspath(args.launcher) if os.access(args.launcher, os.X_OK) else None
+    if not launcher:
+        print(f"{args.launcher} is not built: peak RSS is not measured", file=sys.stderr)
+    report = {"binary": binary, "runs": args.runs,
+              "benchmarks": measure(binary, names, max(1, args.runs), launcher)}
+
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        with open(args.output, "w") as file:
+            file.write(text)
+    else:
+        sys.stdout.write(text)
+
+    if args.compare:
+        with open(args.compare) as file:
+            baseline = json.load(file)["benchmarks"]
+        regressed = compare(baseline, report["benchmarks"], args.threshold)
+        if regressed:
+            sys.exit(f"Regressed by more than {args.threshold:g}%: {', '.join(regressed)}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,179 @@
+/* brainrot.c - Embedding API, see brainrot.h */
+
+#define _GNU_SOURCE /* fopencookie */
+
+#include "brainrot.h"
+#include "ast.h"
+#include "interpreter.h"
+#include "semantic_analyzer.h"
+#include "stdrot.h"
+#include "tasks.h"
+
+#include <pthread.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+/* From lang.l: parses source into *root using the current runtime */
+int parse_program(const char *source, size_t len, ASTNode **root);
+
+struct BrProgram {
+    Runtime *globals; /* what parsing declared, plus the AST arena */
+    ASTNode *root;
+};
+
+static pthread_once_t stdrot_once = PTHREAD_ONCE_INIT;
+
+/* Parses and analyzes into the current runtime. Errors that end the program
+ * while parsing land here too. */
+static bool compile(const char *source, size_t len, ASTNode **root)
+{
+    jmp_buf exit_jump;
+    volatile bool compiled = false;
+    current_runtime->exit_jump = &exit_jump;
+    if (setjmp(exit_jump) == 0) {
+        if (parse_program(source, len, root) != 0) {
+            fprintf(runtime_stderr(), "Parsing failed\n");
+        } else {
+            compiled = semantic_analyze(*root);
+        }
+    }
+    current_runtime->exit_jump = NULL;
+    return compiled;
+}
+
+/* Runs root in the current runtime. ragequit, failed bets and runtime errors
+ * unwind to here. Returns false if the program ended that way. */
+static bool execute(ASTNode *root)
+{
+    jmp_buf exit_jump;
+    Interpreter *volatile interp = NULL;
+    volatile bool finished = false;
+    current_runtime->exit_jump = &exit_jump;
+    if (setjmp(exit_jump) == 0) {
+        interp = interpreter_new();
+        interpret(root, interp);
+        finished = true;
+    }
+    current_runtime->exit_jump = NULL;
+    interpreter_free(interp);
+    return finished;
+}
+
+static ssize_t write_output(void *cookie, const char *data, size_t len)
+{
+    const BrIO *io = cookie;
+    size_t written = io->write(io->user, data, len);
+    return written < len ? -1 : (ssize_t)written;
+}
+
+static ssize_t write_errors(void *cookie, const char *data, size_t len)
+{
+    const BrIO *io = cookie;
+    size_t written = io->write_error(io->user, data, len);
+    return written < len ? -1 : (ssize_t)written;
+}
+
+/* The stream behind one of io's callbacks, or fallback without one. NULL,
+ * after reporting it, if it cannot be opened. Diagnostics are unbuffered,
+ * like stderr. */
+static FILE *open_stream(const BrIO *io, bool errors, FILE *fallback)
+{
+    if (!io || !(errors ? io->write_error : io->write)) {
+        return fallback;
+    }
+    cookie_io_functions_t functions = { .write = errors ? write_errors : write_output };
+    FILE *stream = fopencookie((void *)io, "w", functions);
+    if (!stream) {
+        perror(errors ? "Cannot open program diagnostics" : "Cannot open program output");
+    } else if (errors) {
+        setvbuf(stream, NULL, _IONBF, 0);
+    }
+    return stream;
+}
+
+static void close_stream(FILE *stream)
+{
+    if (stream && stream != stdout && stream != stderr) {
+        fclose(stream);
+    }
+}
+
+BrProgram *br_compile_io(const char *source, size_t len, const BrIO *io)
+{
+    /* The builtin registry is shared by every program */
+    pthread_once(&stdrot_once, stdrot_load);
+
+    FILE *err = open_stream(io, true, stderr);
+    if (!err) {
+        return NULL;
+    }
+    BrProgram *program = SAFE_MALLOC(BrProgram);
+    if (!program) {
+        fprintf(err, "Error: Failed to allocate memory for program\n");
+        close_stream(err);
+        return NULL;
+    }
+
+    Runtime *previous = current_runtime;
+    Runtime *runtime = runtime_new();
+    runtime->exec_context.err = err;
+    current_runtime = runtime;
+    bool compiled = compile(source, len, &program->root);
+    current_runtime = previous;
+    runtime->exec_context.err = stderr;
+    close_stream(err);
+
+    if (!compiled) {
+        runtime_free(runtime);
+        SAFE_FREE(program);
+        return NULL;
+    }
+    program->globals = runtime;
+    return program;
+}
+
+BrProgram *br_compile(const char *source, size_t len)
+{
+    return br_compile_io(source, len, NULL);
+}
+
+int br_run(BrProgram *program, const BrIO *io)
+{
+    FILE *out = open_stream(io, false, stdout);
+    FILE *err = out ? open_stream(io, true, stderr) : NULL;
+    if (!err) {
+        close_stream(out);
+        return 1;
+    }
+
+    Runtime *previous = current_runtime;
+    Runtime *runtime = runtime_clone(program->globals);
+    runtime->exec_context.out = out;
+    runtime->exec_context.err = err;
+    if (io && io->read) {
+        runtime->exec_context.read = io->read;
+        runtime->exec_context.read_data = io->user;
+    }
+    current_runtime = runtime;
+    bool finished = execute(program->root);
+
+    /* Tasks still running share the runtime, so they go first */
+    int status = tasks_finish(runtime, !finished, runtime->exit_status);
+    fflush(out);
+    runtime_free(runtime);
+    current_runtime = previous;
+    close_stream(out);
+    close_stream(err);
+    return status;
+}
+
+void br_free(BrProgram *program)
+{
+    if (!program) {
+        return;
+    }
+    runtime_free(program->globals);
+    SAFE_FREE(program);
+}
@@ -0,0 +1,59 @@
+/* brainrot.h – Embedding API (libbrainrot.a / libbrainrot.so)
+ *
+ * Compiles a program once and runs it as many times as needed inside the
+ * calling process, with no fork, exec or dlopen per run:
+ *
+ *     BrProgram *program = br_compile(source, strlen(source));
+ *     if (program) {
+ *         BrIO io = { .write = collect_output, .user = &buffer };
+ *         int status = br_run(program, &io);
+ *         ...
+ *         br_free(program);
+ *     }
+ *
+ * Every run starts from the state the program had right after compiling,
+ * so runs never see each other's variables or builtin objects. Runs are
+ * independent of the calling thread: separate threads may compile and run
+ * programs at the same time, including the same program.
+ *
+ * ragequit, a failed bet and runtime errors end the run, not the process:
+ * br_run() returns their exit status. Diagnostics go to stderr, or to the
+ * BrIO's write_error.
+ */
+
+#ifndef BRAINROT_H
+#define BRAINROT_H
+
+#include <stddef.h>
+
+typedef struct BrProgram BrProgram;
+
+/* Where a run's output goes and its input comes from. A NULL callback (or
+ * a NULL BrIO) means the process's stdout, stdin or stderr. */
+typedef struct {
+    /* Receives len bytes of output; returns how many it took, and anything
+     * short of len is a write error */
+    size_t (*write)(void *user, const char *data, size_t len);
+    /* Fills buf with up to len bytes of input; returns how many, 0 at the
+     * end of the input */
+    size_t (*read)(void *user, char *buf, size_t len);
+    void *user;
+    /* Receives diagnostics (errors, failed bets, baka), like write */
+    size_t (*write_error)(void *user, const char *data, size_t len);
+} BrIO;
+
+/* Parses and analyzes len bytes of source. Returns NULL, after printing the
+ * errors, if the program does not compile. */
+BrProgram *br_compile(const char *source, size_t len);
+
+/* br_compile(), with the errors going to io's write_error */
+BrProgram *br_compile_io(const char *source, size_t len, const BrIO *io);
+
+/* Runs a compiled program to completion and returns its exit status: 0,
+ * the code given to ragequit, or 1 after an error. */
+int br_run(BrProgram *program, const BrIO *io);
+
+/* Frees a program from br_compile(); it must not be running */
+void br_free(BrProgram *program);
+
+#endif /* BRAINROT_H */
@@ -0,0 +1,77 @@
+/* embed.c - Runs one Brainrot program many times in-process
+ *
+ *   make embed
+ *   gcc -I. -o embed examples/embed.c libbrainrot.a -lm -pthread
+ *   ./embed examples/fizz_buzz.brainrot 1000
+ */
+
+#include "brainrot.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char *data;
+    size_t len, capacity;
+} Buffer;
+
+static size_t collect(void *user, const char *data, size_t len)
+{
+    Buffer *out = user;
+    if (out->len + len > out->capacity) {
+        size_t capacity = out->capacity ? out->capacity * 2 : 4096;
+        while (capacity < out->len + len) {
+            capacity *= 2;
+        }
+        char *grown = realloc(out->data, capacity);
+        if (!grown) {
+            return 0;
+        }
+        out->data = grown;
+        out->capacity = capacity;
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    return len;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <sourcefile> <runs>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (!file) {
+        perror("Cannot open source file");
+        return 1;
+    }
+    static char source[1 << 20];
+    size_t len = fread(source, 1, sizeof(source), file);
+    fclose(file);
+
+    BrProgram *program = br_compile(source, len);
+    if (!program) {
+        return 1;
+    }
+
+    int runs = atoi(argv[2]);
+    Buffer out = {0};
+    BrIO io = { .write = collect, .user = &out };
+    for (int i = 0; i < runs; i++) {
+        out.len = 0;
+        int status = br_run(program, &io);
+        if (status != 0) {
+            fprintf(stderr, "run %d exited with %d\n", i, status);
+            break;
+        }
+    }
+
+    /* Every run prints the same thing; show the last one */
+    fwrite(out.data, 1, out.len, stdout);
+    free(out.data);
+    br_free(program);
+    return 0;
+}
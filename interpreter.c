@@ -3,12 +3,13 @@
 #include "interpreter.h"
 #include "ast.h"
 #include "stdrot.h"
+#include "parallel.h"
+#include "tasks.h"
 #include "lib/mem.h"
 #include <stdio.h>
 
 extern void yyerror(const char *s);
 extern String safe_strdup(const String *str);
-extern void execute_func_call(const String func_name, ArgumentList *args);
 
 /* External functions we need from the original implementation */
 extern Variable *variable_new(String name);
@@ -16,7 +17,6 @@ extern void add_variable_to_scope(const String name, Variable *var);
 extern Variable *get_variable(const String name);
 extern Function *get_function(const String name);
 extern bool is_builtin_function(const String name);
-extern void execute_builtin_function(const String name, ArgumentList *args);
 extern void execute_assignment(ASTNode *node);
 extern void execute_for_statement(ASTNode *node);
 extern void execute_while_statement(ASTNode *node);
@@ -37,8 +37,6 @@ extern void *evaluate_multi_array_access(ASTNode *node);
 extern void *handle_function_call(ASTNode *node);
 extern size_t handle_sizeof(ASTNode *node);
 
-/* Global pointer to current interpreter for function calls */
-Interpreter* current_interpreter = NULL;
 
 /* Create a new interpreter */
 Interpreter* interpreter_new(void) {
@@ -77,9 +75,10 @@ Interpreter* interpreter_new(void) {
     interp->base.visit_statement_list = interpreter_visit_statement_list;
     interp->base.visit_print_statement = interpreter_visit_print_statement;
     interp->base.visit_error_statement = interpreter_visit_error_statement;
+    interp->base.evaluates_initializers = true;
     
     /* Initialize interpreter state */
-    interp->current_scope = current_scope;
+    interp->current_scope = current_runtime->scope;
     interp->return_value.has_value = false;
     interp->should_break = false;
     interp->should_return = false;
@@ -98,13 +97,12 @@ void interpreter_free(Interpreter *interp) {
 void interpret(ASTNode *root, Interpreter *interp) {
     if (!root || !interp) return;
     
-    extern Scope* current_scope;
     
     /* Set global interpreter pointer for function calls */
-    current_interpreter = interp;
+    current_runtime->interpreter = interp;
     
     /* Ensure there's a global scope for the visitor pattern */
-    if (!current_scope) {
+    if (!current_runtime->scope) {
         extern void enter_scope();
         enter_scope();
     }
@@ -113,7 +111,7 @@ void interpret(ASTNode *root, Interpreter *interp) {
     ast_accept(root, (Visitor*)interp);
     
     /* Clear global interpreter pointer */
-    current_interpreter = NULL;
+    current_runtime->interpreter = NULL;
 }
 
 /* Expression visitor implementations */
@@ -211,7 +209,7 @@ void* interpreter_visit_array_access(Visitor *self, ASTNode *node) {
     if (node->data.array.num_dimensions == 0) {
         /* Get the variable to determine expected dimensions */
         Variable *var = get_variable(node->data.array.name);
-        if (!var || !var->is_array) {
+        if (!var || !var->is_array || is_packed_bool_array(var)) {
             return NULL;
         }
         
@@ -232,8 +230,14 @@ void* interpreter_visit_array_access(Visitor *self, ASTNode *node) {
         return evaluate_multi_array_access(&temp_node);
     }
     
-    /* Use the existing array access implementation */
-    return evaluate_multi_array_access(node);
+    /* Use the existing array access implementation; cap arrays are
+     * bit-packed and have no element address to hand back */
+    size_t offset;
+    Variable *var = resolve_array_element(node, &offset);
+    if (is_packed_bool_array(var)) {
+        return NULL;
+    }
+    return array_element_address(var, offset);
 }
 
 void* interpreter_visit_function_call(Visitor *self, ASTNode *node) {
@@ -243,11 +247,12 @@ void* interpreter_visit_function_call(Visitor *self, ASTNode *node) {
     const String func_name = node->data.func_call.function_name;
     ArgumentList *args = node->data.func_call.arguments;
     
-    extern Scope* current_scope;
     
     /* Handle built-in functions */
-    if (is_builtin_function(func_name)) {
-        execute_builtin_function(func_name, args);
+    StdrotFn builtin = stdrot_bind_call(node);
+    if (builtin) {
+        execute_func_call(builtin, stdrot_call_flags(node), func_name, args,
+                          node->data.func_call.format);
     } else {
         /* Handle user-defined functions directly without return value allocation */
         execute_function_call(func_name, args);
@@ -318,7 +323,7 @@ void interpreter_visit_declaration(Visitor *self, ASTNode *node) {
                 StructDef *def = get_struct_def(scope_var->struct_name);
                 if (def) {
                     scope_var->value.array_data = calloc(1, def->total_size);
-                    hm_put(current_scope->variables, name.data, name.len,
+                    hm_put(current_runtime->scope->variables, name.data, name.len,
                         scope_var, sizeof(Variable));
                 }
             }
@@ -396,6 +401,11 @@ void interpreter_visit_if_statement(Visitor *self, ASTNode *node) {
 
 void interpreter_visit_for_statement(Visitor *self, ASTNode *node) {
     if (!node) return;
+
+    if (node->data.for_stmt.squad) {
+        execute_squad_loop(node);
+        return;
+    }
     
     extern void enter_scope();
     extern void exit_scope();
@@ -409,6 +419,7 @@ void interpreter_visit_for_statement(Visitor *self, ASTNode *node) {
         }
         
         while (1) {
+            TASKS_CHECK_CANCELLED();
             enter_scope();
             if (node->data.for_stmt.cond) {
                 int cond_result = evaluate_expression_int(node->data.for_stmt.cond);
@@ -442,6 +453,7 @@ void interpreter_visit_while_statement(Visitor *self, ASTNode *node) {
     PUSH_JUMP_BUFFER();
     enter_scope();
     while (evaluate_expression_int(node->data.while_stmt.cond) && setjmp(CURRENT_JUMP_BUFFER()) == 0) {
+        TASKS_CHECK_CANCELLED();
         enter_scope();
         
         if (node->data.while_stmt.body) {
@@ -465,6 +477,7 @@ void interpreter_visit_do_while_statement(Visitor *self, ASTNode *node) {
     PUSH_JUMP_BUFFER();
     enter_scope();
     do {
+        TASKS_CHECK_CANCELLED();
         /* Enter new scope for each iteration */
         enter_scope();
         
@@ -523,7 +536,7 @@ void interpreter_visit_function_definition(Visitor *self, ASTNode *node) {
     
     if (!func) {
         yyerror("Failed to create function");
-        exit(1);
+        runtime_exit(1);
     }
 }
 
@@ -545,7 +558,9 @@ void interpreter_visit_print_statement(Visitor *self, ASTNode *node) {
     
     ASTNode *expr = node->data.op.left;
     ArgumentList args = {expr, NULL};
-    execute_func_call((String){ .data = "yapping", .len = sizeof("yapping") }, &args);
+    static _Thread_local StdrotFn yapping_fn = NULL;
+    if (!yapping_fn) yapping_fn = stdrot_lookup(STRING_LITERAL("yapping"));
+    execute_func_call(yapping_fn, 0, STRING_LITERAL("yapping"), &args, NULL);
 }
 
 void interpreter_visit_error_statement(Visitor *self, ASTNode *node) {
@@ -554,5 +569,7 @@ void interpreter_visit_error_statement(Visitor *self, ASTNode *node) {
     
     ASTNode *expr = node->data.op.left;
     ArgumentList args = {expr, NULL};
-    execute_func_call((String){ .data = "baka", .len = sizeof("baka") }, &args);
+    static _Thread_local StdrotFn baka_fn = NULL;
+    if (!baka_fn) baka_fn = stdrot_lookup(STRING_LITERAL("baka"));
+    execute_func_call(baka_fn, 0, STRING_LITERAL("baka"), &args, NULL);
 }
@@ -7,7 +7,7 @@
 #include "ast.h"
 
 /* Interpreter visitor - executes the AST */
-typedef struct {
+typedef struct Interpreter {
     Visitor base;                   /* Inherit from Visitor */
     Scope *current_scope;           /* Current execution scope */
     ReturnValue return_value;       /* Function return value */
@@ -1,9 +1,21 @@
 %define parse.error verbose
+%define api.pure full
+%define api.prefix {br_yy}
+%param {yyscan_t scanner}
+%parse-param {ASTNode **root}
+
+%code requires {
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void *yyscan_t;
+#endif
+}
+
 %{
 #include "ast.h"
-#include "visitor.h"
-#include "semantic_analyzer.h"
-#include "interpreter.h"
+#include "brainrot.h"
+#include "server.h"
+#include "batch.h"
 #include "stdrot.h"
 #include "lib/mem.h"
 #include "lib/string_value.h"
@@ -13,24 +25,14 @@
 #include <stdarg.h>
 #include <stdbool.h>
 
-int yylex(void);
-int yylex_destroy(void);
-void yyerror(const char *s);
-void cleanup();
 TypeModifiers get_variable_modifiers(const String name);
-extern TypeModifiers current_modifiers;
-extern VarType current_var_type;
-
-extern int yylineno;
-extern FILE *yyin;
-
-/* Root of the AST */
-ASTNode *root = NULL;
-
-/* Global interpreter for cleanup */
-static Interpreter *global_interpreter = NULL;
 %}
 
+%code {
+int br_yylex(BR_YYSTYPE *yylval_param, yyscan_t scanner);
+static void br_yyerror(yyscan_t scanner, ASTNode **root, const char *s);
+}
+
 
 %union {
     int ival;
@@ -47,6 +49,7 @@ static Interpreter *global_interpreter = NULL;
     ArrayDimensions array_dims;
     Array array;
     Declarator declarator;
+    Reduction *reduction;
 }
 
 /* Define token types */
@@ -68,6 +71,7 @@ static Interpreter *global_interpreter = NULL;
 %token <fval> FLOAT_LITERAL
 %token <dval> DOUBLE_LITERAL
 %token SLORP
+%token SQUAD COMBO
 %token DOT
 %type <node>  struct_def struct_access
 %type <param> struct_field_list struct_field   /* reuse Parameter as field carrier */
@@ -79,6 +83,7 @@ static Interpreter *global_interpreter = NULL;
 %type <node> declaration
 %type <node> expression
 %type <node> for_statement
+%type <reduction> combo_clause reduction_list reduction
 %type <node> while_statement
 %type <node> do_while_statement
 %type <node> function_call
@@ -105,6 +110,13 @@ static Interpreter *global_interpreter = NULL;
 %type <ival> pointer_stars
 %type <node> assignment_target
 
+/* Names, string literals and initializer lists dropped by a syntax error;
+ * a host that compiles many programs would otherwise leak them on every
+ * failure. Argument lists and other nodes live in the program's arena. */
+%destructor { SAFE_FREE($$.data); } <strval>
+%destructor { SAFE_FREE($$.name.data); } <declarator>
+%destructor { free_expression_list($$); } <expr_list>
+
 %start program
 
 /* Define precedence for operators */
@@ -125,7 +137,7 @@ static Interpreter *global_interpreter = NULL;
 
 program
     : function_def_list skibidi_function
-        { root = create_statement_list($2, $1); }
+        { *root = create_statement_list($2, $1); }
     ;
 
 function_def_list
@@ -321,7 +333,7 @@ declaration:
             var->pointer_level = $3.pointer_level;
             add_variable_to_scope($3.name, var);
             if (!set_multi_array_variable($3.name, $4.dimensions, $4.num_dimensions, get_current_modifiers(), $2)) {
-                yyerror("Failed to create array");
+                yyerror(scanner, root, "Failed to create array");
                 SAFE_FREE($3.name);
                 YYABORT;
             }
@@ -360,8 +372,8 @@ declaration:
                 size_t total_inits = count_expression_list($6);
                 size_t trailing = 1;
                 for (int i = 1; i < dims.num_dimensions; i++) trailing *= (size_t)dims.dimensions[i];
-                if (trailing == 0) { yyerror("Invalid array dimensions"); YYABORT; }
-                if (total_inits % trailing != 0) { yyerror("Initializer count does not match array dimensions"); YYABORT; }
+                if (trailing == 0) { yyerror(scanner, root, "Invalid array dimensions"); YYABORT; }
+                if (total_inits % trailing != 0) { yyerror(scanner, root, "Initializer count does not match array dimensions"); YYABORT; }
                 size_t first = total_inits / trailing;
                 dims.dimensions[0] = (int)first;
             }
@@ -442,7 +454,7 @@ dimensions:
     | dimensions LBRACKET INT_LITERAL RBRACKET
         {
             if ($1.num_dimensions >= MAX_DIMENSIONS) {
-                yyerror("Maximum array dimensions exceeded");
+                yyerror(scanner, root, "Maximum array dimensions exceeded");
                 YYABORT;
             }
             $$.dimensions[$1.num_dimensions] = $3;
@@ -529,6 +541,58 @@ for_statement:
         {
             $$ = create_for_statement_node($3, $5, $7, $10);
         }
+    | SQUAD FLEX LPAREN init_expr SEMICOLON condition SEMICOLON increment RPAREN combo_clause LBRACE statements RBRACE
+        {
+            $$ = create_squad_statement_node($4, $6, $8, $12, $10);
+        }
+    ;
+
+combo_clause:
+      /* empty */
+        { $$ = NULL; }
+    | COMBO LPAREN reduction_list RPAREN
+        { $$ = $3; }
+    ;
+
+reduction_list:
+      reduction
+        { $$ = $1; }
+    | reduction_list COMMA reduction
+        {
+            Reduction *last = $1;
+            while (last->next)
+                last = last->next;
+            last->next = $3;
+            $$ = $1;
+        }
+    ;
+
+reduction:
+      PLUS COLON IDENTIFIER
+        {
+            $$ = create_reduction(REDUCE_SUM, $3, NULL);
+            SAFE_FREE($3.data);
+        }
+    | TIMES COLON IDENTIFIER
+        {
+            $$ = create_reduction(REDUCE_PRODUCT, $3, NULL);
+            SAFE_FREE($3.data);
+        }
+    | IDENTIFIER COLON IDENTIFIER
+        {
+            if (strcmp($1.data, "min") == 0) {
+                $$ = create_reduction(REDUCE_MIN, $3, NULL);
+            } else if (strcmp($1.data, "max") == 0) {
+                $$ = create_reduction(REDUCE_MAX, $3, NULL);
+            } else {
+                yyerror(scanner, root, "combo operator must be +, *, min or max");
+                SAFE_FREE($1.data);
+                SAFE_FREE($3.data);
+                YYABORT;
+            }
+            SAFE_FREE($1.data);
+            SAFE_FREE($3.data);
+        }
     ;
 
 while_statement:
@@ -677,7 +741,7 @@ multi_dimension_access:
     | multi_dimension_access LBRACKET expression RBRACKET
         {
             if ($1.num_dimensions >= MAX_DIMENSIONS) {
-                yyerror("Too many array indices");
+                yyerror(scanner, root, "Too many array indices");
                 YYABORT;
             }
             $$ = $1;
@@ -740,95 +804,169 @@ struct_access:
     ;
 %%
 
-int main(int argc, char *argv[]) {
-    /* Register cleanup function to be called on exit */
-    atexit(cleanup);
-    atexit(stdrot_unload);
-    
-    if (argc != 2) {
-        fprintf(stderr, "Usage: %s <sourcefile>\n", argv[0]);
-        return 1;
-    }
+#ifndef BRAINROT_LIBRARY
 
-    FILE *source = fopen(argv[1], "r");
+/* Reads the whole file, so the parser can scan it from memory */
+static char *read_source(const char *path, size_t *len)
+{
+    FILE *source = fopen(path, "rb");
     if (!source) {
         perror("Cannot open source file");
-        return 1;
+        return NULL;
     }
 
-    yyin = source;
-    current_scope = create_scope(NULL);
+    size_t capacity = 1 << 16, used = 0;
+    char *text = malloc(capacity);
+    size_t n;
+    while (text && (n = fread(text + used, 1, capacity - used, source)) > 0) {
+        used += n;
+        if (used == capacity) {
+            char *grown = realloc(text, capacity *= 2);
+            if (!grown) free(text);
+            text = grown;
+        }
+    }
+    if (!text || ferror(source)) {
+        perror("Cannot read source file");
+        free(text);
+        text = NULL;
+    }
+    fclose(source);
+    *len = used;
+    return text;
+}
 
-    /* Phase 0: Load standard library (needed for semantic analysis) */
-    stdrot_load();
+int main(int argc, char *argv[]) {
+    /* Unloads the standard library once everything else is done */
+    atexit(stdrot_unload);
 
-    /* Phase 1: Parse the source code to build AST */
-    if (yyparse() != 0) {
-        fprintf(stderr, "Parsing failed\n");
-        return 1;
+    OutputBufferMode output_mode = OUTPUT_BUFFER_AUTO;
+    const char *source_path = NULL;
+    const char *serve_socket = NULL;
+    const char *client_socket = NULL;
+    bool isolate = false;
+    bool fork_server = false;
+    const char *batch_manifest = NULL;
+    const char *batch_cases = NULL;
+    int batch_threads = 0;
+    BatchReport batch_report = BATCH_REPORT_JSON;
+    double batch_timeout = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            serve_socket = argv[++i];
+        } else if (strcmp(argv[i], "--client") == 0 && i + 1 < argc) {
+            client_socket = argv[++i];
+        } else if (strcmp(argv[i], "--isolate") == 0) {
+            isolate = true;
+        } else if (strcmp(argv[i], "--fork-server") == 0) {
+            fork_server = true;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_manifest = argv[++i];
+        } else if (strncmp(argv[i], "--cases=", 8) == 0) {
+            batch_cases = argv[i] + 8;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            batch_threads = atoi(argv[i] + 10);
+            if (batch_threads <= 0) {
+                fprintf(stderr, "Invalid thread count '%s'\n", argv[i] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--timeout=", 10) == 0) {
+            char *end;
+            batch_timeout = strtod(argv[i] + 10, &end);
+            if (end == argv[i] + 10 || *end || !(batch_timeout > 0)) {
+                fprintf(stderr, "Invalid timeout '%s'\n", argv[i] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--report=", 9) == 0) {
+            const char *report = argv[i] + 9;
+            if (strcmp(report, "json") == 0) {
+                batch_report = BATCH_REPORT_JSON;
+            } else if (strcmp(report, "junit") == 0) {
+                batch_report = BATCH_REPORT_JUNIT;
+            } else {
+                fprintf(stderr, "Unknown report format '%s' (expected json or junit)\n", report);
+                return 1;
+            }
+        } else if (strncmp(argv[i], "--output-buffer=", 16) == 0) {
+            const char *mode = argv[i] + 16;
+            if (strcmp(mode, "line") == 0) {
+                output_mode = OUTPUT_BUFFER_LINE;
+            } else if (strcmp(mode, "block") == 0) {
+                output_mode = OUTPUT_BUFFER_BLOCK;
+            } else if (strcmp(mode, "none") == 0) {
+                output_mode = OUTPUT_BUFFER_NONE;
+            } else {
+                fprintf(stderr, "Unknown output buffer mode '%s' (expected line, block or none)\n", mode);
+                return 1;
+            }
+        } else if (!source_path) {
+            source_path = argv[i];
+        } else {
+            source_path = NULL;
+            break;
+        }
     }
 
-    /* Phase 2: Semantic Analysis and Type Checking */
-    if (!semantic_analyze(root)) {
+    if (serve_socket && !source_path && !client_socket) {
+        return server_listen(serve_socket);
+    }
+    if (batch_manifest && !source_path) {
+        return batch_run(batch_manifest, batch_cases, batch_threads, batch_report, isolate, batch_timeout);
+    }
+    if (!source_path || serve_socket || batch_manifest || (isolate && !client_socket) ||
+        (fork_server && client_socket)) {
+        fprintf(stderr,
+                "Usage: %s [--output-buffer=line|block|none] <sourcefile>\n"
+                "       %s --serve <socket>\n"
+                "       %s --client <socket> [--isolate] <sourcefile>\n"
+                "       %s --fork-server <sourcefile> < jobs\n"
+                "       %s --batch <manifest> [--cases=DIR] [--threads=N] [--report=json|junit]\n"
+                "              [--isolate] [--timeout=SECONDS]\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0]);
         return 1;
     }
+    if (client_socket) {
+        return server_request(client_socket, source_path, isolate);
+    }
+
+    /* Must happen before anything is written to stdout */
+    stdrot_configure_output(output_mode);
 
-    /* Phase 3: Execution */
-    global_interpreter = interpreter_new();
-    if (!global_interpreter) {
-        fprintf(stderr, "Failed to create interpreter\n");
+    size_t source_len;
+    char *source = read_source(source_path, &source_len);
+    if (!source) {
         return 1;
     }
 
-    interpret(root, global_interpreter);
-    interpreter_free(global_interpreter);
-    global_interpreter = NULL;
-
-    /* Note: cleanup and stdrot_unload are called via atexit */
-    
-    return 0;
-}
+    /* Parse and analyze, then execute with the process's stdin and stdout */
+    BrProgram *program = br_compile(source, source_len);
+    free(source);
+    if (!program) {
+        return 1;
+    }
 
-void yyerror(const char *s) {
-    fprintf(stderr, "Error: %s at line %d\n", s, yylineno - 1);
+    /* Jobs are forked off here, after the one parse they all share */
+    int status = fork_server ? server_fork_jobs(program, stdin, stdout) : br_run(program, NULL);
+    br_free(program);
+    return status;
 }
 
-void cleanup() {
-    static bool cleaned = false;
-    if (cleaned) return;  // Prevent double cleanup
-    cleaned = true;
-    
-    // Free the global interpreter if it exists
-    if (global_interpreter) {
-        interpreter_free(global_interpreter);
-        global_interpreter = NULL;
-    }
-    
-    // Close input file if still open
-    if (yyin && yyin != stdin) {
-        fclose(yyin);
-        yyin = NULL;
-    }
-    
-    // Free the AST
-    free_ast();
-    
-    // Free the scope
-    if (current_scope) {
-        free_scope(current_scope);
-        current_scope = NULL;
-    }
-
-    free_function_table();
+#endif /* BRAINROT_LIBRARY */
 
-    free_static_variable_map();
+/* Bison renamed yyerror to br_yyerror for the parser's own reports; the
+ * rest of the interpreter calls this one-argument yyerror() */
+#undef yyerror
 
-    free_struct_registry();
+void yyerror(const char *s) {
+    fflush(current_runtime ? current_runtime->exec_context.out : stdout);
+    fprintf(runtime_stderr(), "Error: %s at line %d\n", s, current_runtime ? current_runtime->line_number - 1 : 0);
+}
 
-    CLEAN_JUMP_BUFFER();
-    
-    // Clean up flex's internal state
-    yylex_destroy();
+static void br_yyerror(yyscan_t scanner, ASTNode **root, const char *s) {
+    (void)scanner;
+    (void)root;
+    yyerror(s);
 }
 
 TypeModifiers get_variable_modifiers(const String name) {
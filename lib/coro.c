@@ -0,0 +1,280 @@
+#include "coro.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/* Stacks are mapped, not allocated, so a coroutine only uses the pages it
+ * touches; the lowest page is left inaccessible to catch overflows. They
+ * are as large as the main thread's (RLIMIT_STACK), CORO_STACK_SIZE when
+ * that is unlimited, or BRAINROT_TASK_STACK MiB. */
+#define CORO_STACK_SIZE ((size_t)8 << 20)
+#define CORO_STACK_MIN ((size_t)256 << 10)
+#define CORO_STACK_MAX ((size_t)1 << 30)
+
+static size_t stack_size, page_size;
+static pthread_once_t stack_size_once = PTHREAD_ONCE_INIT;
+
+static void init_stack_size(void)
+{
+    const char *env = getenv("BRAINROT_TASK_STACK");
+    struct rlimit limit;
+    if (env && strtol(env, NULL, 10) > 0)
+        stack_size = (size_t)strtol(env, NULL, 10) << 20;
+    else if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY)
+        stack_size = (size_t)limit.rlim_cur;
+    else
+        stack_size = CORO_STACK_SIZE;
+    if (stack_size < CORO_STACK_MIN) stack_size = CORO_STACK_MIN;
+    if (stack_size > CORO_STACK_MAX) stack_size = CORO_STACK_MAX;
+    page_size = (size_t)sysconf(_SC_PAGESIZE);
+    stack_size = (stack_size + page_size - 1) / page_size * page_size;
+}
+
+#if defined(__SANITIZE_ADDRESS__)
+#define CORO_ASAN 1
+#endif
+#if defined(__SANITIZE_THREAD__)
+#define CORO_TSAN 1
+#endif
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define CORO_ASAN 1
+#endif
+#if __has_feature(thread_sanitizer)
+#define CORO_TSAN 1
+#endif
+#endif
+
+#ifdef CORO_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+#ifdef CORO_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+#if defined(__x86_64__)
+/* Saves the callee-saved registers on the current stack, stores the stack
+ * pointer in *save_sp and resumes whatever was saved at load_sp. swapcontext()
+ * would also save the signal mask, which costs a system call per switch. */
+void coro_switch(void **save_sp, void *load_sp) __attribute__((visibility("hidden")));
+/* First code a new coroutine runs: calls r13(r12) */
+void coro_trampoline(void) __attribute__((visibility("hidden")));
+
+__asm__(
+    ".text\n"
+    ".globl coro_switch\n"
+    ".hidden coro_switch\n"
+    ".type coro_switch, @function\n"
+    "coro_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size coro_switch, .-coro_switch\n"
+    ".globl coro_trampoline\n"
+    ".hidden coro_trampoline\n"
+    ".type coro_trampoline, @function\n"
+    "coro_trampoline:\n"
+    "    movq %r12, %rdi\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+    ".size coro_trampoline, .-coro_trampoline\n");
+
+#define SWITCH_IN(coro) coro_switch(&(coro)->caller_sp, (coro)->sp)
+#define SWITCH_OUT(coro) coro_switch(&(coro)->sp, (coro)->caller_sp)
+#else
+#include <ucontext.h>
+#define SWITCH_IN(coro) swapcontext(&(coro)->caller, &(coro)->context)
+#define SWITCH_OUT(coro) swapcontext(&(coro)->context, &(coro)->caller)
+#endif
+
+struct Coro
+{
+    coro_fn fn;
+    void *arg;
+    bool done;
+    char *mapping; /* guard page, then the stack */
+    size_t mapping_size;
+#if defined(__x86_64__)
+    void *sp;        /* the coroutine's, while it is switched out */
+    void *caller_sp; /* coro_resume()'s, while the coroutine runs */
+#else
+    ucontext_t context, caller;
+#endif
+#ifdef CORO_ASAN
+    void *fake_stack, *caller_fake_stack;
+    const void *caller_bottom;
+    size_t caller_size;
+#endif
+#ifdef CORO_TSAN
+    void *fiber, *caller_fiber;
+#endif
+};
+
+/* The coroutine the calling thread is running, if any */
+static _Thread_local Coro *running;
+
+/* Tells the sanitizers the stack is about to change. finished means the
+ * coroutine is leaving for good. */
+static void before_switch_out(Coro *coro, bool finished)
+{
+#ifdef CORO_ASAN
+    __sanitizer_start_switch_fiber(finished ? NULL : &coro->fake_stack, coro->caller_bottom, coro->caller_size);
+#endif
+#ifdef CORO_TSAN
+    __tsan_switch_to_fiber(coro->caller_fiber, 0);
+#endif
+    (void)coro;
+    (void)finished;
+}
+
+static void after_switch_in(Coro *coro)
+{
+#ifdef CORO_ASAN
+    __sanitizer_finish_switch_fiber(coro->fake_stack, &coro->caller_bottom, &coro->caller_size);
+#endif
+    (void)coro;
+}
+
+__attribute__((noreturn)) static void coro_main(Coro *coro)
+{
+    after_switch_in(coro);
+    coro->fn(coro->arg);
+    coro->done = true;
+    before_switch_out(coro, true);
+    SWITCH_OUT(coro);
+    abort(); /* a finished coroutine is never resumed */
+}
+
+#if !defined(__x86_64__)
+static void coro_start(void)
+{
+    coro_main(running);
+}
+#endif
+
+/* Prepares coro's stack so that the first switch to it enters coro_main() */
+static void init_stack(Coro *coro, size_t page)
+{
+#if defined(__x86_64__)
+    /* The frame coro_switch() pops: MXCSR and x87 control word, r15, r14,
+     * r13, r12, rbx, rbp, then the return address */
+    uintptr_t top = ((uintptr_t)coro->mapping + coro->mapping_size) & ~(uintptr_t)15;
+    uint64_t *frame = (uint64_t *)top - 8;
+    frame[0] = 0x1F80 | ((uint64_t)0x037F << 32);
+    frame[1] = 0;
+    frame[2] = 0;
+    frame[3] = (uint64_t)(uintptr_t)coro_main;
+    frame[4] = (uint64_t)(uintptr_t)coro;
+    frame[5] = 0;
+    frame[6] = 0;
+    frame[7] = (uint64_t)(uintptr_t)coro_trampoline;
+    coro->sp = frame;
+#else
+    getcontext(&coro->context);
+    coro->context.uc_stack.ss_sp = coro->mapping + page;
+    coro->context.uc_stack.ss_size = coro->mapping_size - page;
+    coro->context.uc_link = NULL;
+    makecontext(&coro->context, coro_start, 0);
+#endif
+    (void)page;
+}
+
+Coro *coro_new(coro_fn fn, void *arg)
+{
+    Coro *coro = calloc(1, sizeof(Coro));
+    if (!coro)
+    {
+        return NULL;
+    }
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    pthread_once(&stack_size_once, init_stack_size);
+    coro->mapping_size = stack_size + page;
+    coro->mapping = mmap(NULL, coro->mapping_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (coro->mapping == MAP_FAILED)
+    {
+        free(coro);
+        return NULL;
+    }
+    mprotect(coro->mapping, page, PROT_NONE);
+    coro->fn = fn;
+    coro->arg = arg;
+
+    init_stack(coro, page);
+#ifdef CORO_TSAN
+    coro->fiber = __tsan_create_fiber(0);
+#endif
+    return coro;
+}
+
+void coro_free(Coro *coro)
+{
+    if (!coro)
+    {
+        return;
+    }
+#ifdef CORO_TSAN
+    __tsan_destroy_fiber(coro->fiber);
+#endif
+    munmap(coro->mapping, coro->mapping_size);
+    free(coro);
+}
+
+size_t coro_stack_left(void)
+{
+    if (!running)
+        return SIZE_MAX;
+    uintptr_t here = (uintptr_t)__builtin_frame_address(0);
+    uintptr_t bottom = (uintptr_t)running->mapping + page_size;
+    return here > bottom ? (size_t)(here - bottom) : 0;
+}
+
+bool coro_resume(Coro *coro)
+{
+    Coro *outer = running;
+    running = coro;
+#ifdef CORO_ASAN
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    __sanitizer_start_switch_fiber(&coro->caller_fake_stack, coro->mapping + page, coro->mapping_size - page);
+#endif
+#ifdef CORO_TSAN
+    coro->caller_fiber = __tsan_get_current_fiber();
+    __tsan_switch_to_fiber(coro->fiber, 0);
+#endif
+    SWITCH_IN(coro);
+#ifdef CORO_ASAN
+    __sanitizer_finish_switch_fiber(coro->caller_fake_stack, NULL, NULL);
+#endif
+    running = outer;
+    return !coro->done;
+}
+
+void coro_yield(void)
+{
+    Coro *coro = running;
+    before_switch_out(coro, false);
+    SWITCH_OUT(coro);
+    after_switch_in(coro);
+}
@@ -0,0 +1,41 @@
+/* coro.h – Stackful coroutines
+ *
+ * A coroutine runs a function on a stack of its own. coro_resume() switches
+ * to it until the function calls coro_yield() or returns, and then comes
+ * back. A switch saves and restores a handful of registers, with no system
+ * call, so coroutines are cheap enough to have thousands of.
+ *
+ * Code running on a coroutine may keep pointers to thread-local storage
+ * across a yield, so a coroutine must always be resumed by the thread that
+ * first resumed it.
+ */
+
+#ifndef CORO_H
+#define CORO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct Coro Coro;
+
+typedef void (*coro_fn)(void *arg);
+
+/* A coroutine that will run fn(arg) when first resumed, or NULL when out
+ * of memory */
+Coro *coro_new(coro_fn fn, void *arg);
+
+/* Frees a coroutine that has finished or was never resumed */
+void coro_free(Coro *coro);
+
+/* Runs coro until it yields or its function returns. Returns false once
+ * the function has returned. */
+bool coro_resume(Coro *coro);
+
+/* From inside a coroutine: switches back to its coro_resume() */
+void coro_yield(void);
+
+/* How many bytes of stack the running coroutine has left, or SIZE_MAX if
+ * the calling thread is not running one */
+size_t coro_stack_left(void);
+
+#endif /* CORO_H */
@@ -5,14 +5,416 @@
  */
 
 #include "input.h"
+#include <stdbool.h>
+#include <unistd.h>
+
+/*
+ * All reads go through one block buffer filled straight from the source
+ * (fd 0 unless input_use() says otherwise), so numbers are parsed in place
+ * instead of one fgets() line at a time. Numeric reads take the next
+ * whitespace-separated token (several values may share a line); string and
+ * char reads keep fgets() line semantics.
+ */
+#define INPUT_BLOCK_SIZE (1 << 16)
+
+struct InputReader
+{
+    input_source source; /* NULL reads fd 0 */
+    void *source_data;
+    char data[INPUT_BLOCK_SIZE];
+    size_t pos;
+    size_t len;
+    bool eof;
+    bool error;
+};
+
+static InputReader stdin_reader;
+/* initial-exec: in libstdrot.so this would otherwise be dynamic TLS, which
+ * each thread allocates on first use (a task's worker, mid-slorp) and which
+ * LeakSanitizer in GCC 12 misreads on current glibc. One pointer fits in the
+ * static TLS glibc keeps spare for dlopen'd libraries. */
+static _Thread_local InputReader *active_reader __attribute__((tls_model("initial-exec")));
+static void (*wait_for_input)(int fd);
+
+InputReader *input_reader_new(input_source source, void *data)
+{
+    InputReader *reader = calloc(1, sizeof(InputReader));
+    if (reader)
+    {
+        reader->source = source;
+        reader->source_data = data;
+    }
+    return reader;
+}
+
+void input_reader_free(InputReader *reader)
+{
+    free(reader);
+}
+
+void input_use(InputReader *reader)
+{
+    active_reader = reader;
+}
+
+void input_set_wait(void (*wait)(int fd))
+{
+    wait_for_input = wait;
+}
+
+static InputReader *current_reader(void)
+{
+    return active_reader ? active_reader : &stdin_reader;
+}
+
+/**
+ * Refills the block buffer, keeping unread bytes at the front.
+ *
+ * @return true if at least one new byte is available
+ */
+static bool reader_fill(InputReader *reader)
+{
+    if (reader->eof || reader->error)
+    {
+        return false;
+    }
+
+    if (reader->pos > 0)
+    {
+        memmove(reader->data, reader->data + reader->pos, reader->len - reader->pos);
+        reader->len -= reader->pos;
+        reader->pos = 0;
+    }
+
+    if (reader->source)
+    {
+        size_t n = reader->source(reader->source_data, reader->data + reader->len,
+                                  sizeof(reader->data) - reader->len);
+        if (n == 0)
+        {
+            reader->eof = true;
+            return false;
+        }
+        reader->len += n;
+        return true;
+    }
+
+    while (reader->len < sizeof(reader->data))
+    {
+        if (wait_for_input)
+        {
+            wait_for_input(STDIN_FILENO);
+        }
+        ssize_t n = read(STDIN_FILENO, reader->data + reader->len, sizeof(reader->data) - reader->len);
+        if (n > 0)
+        {
+            reader->len += (size_t)n;
+            return true;
+        }
+        if (n == 0)
+        {
+            reader->eof = true;
+            return false;
+        }
+        if (errno != EINTR)
+        {
+            reader->error = true;
+            return false;
+        }
+    }
+    return false;
+}
+
+static int reader_peek(InputReader *reader)
+{
+    if (reader->pos == reader->len && !reader_fill(reader))
+    {
+        return EOF;
+    }
+    return (unsigned char)reader->data[reader->pos];
+}
+
+static int reader_getc(InputReader *reader)
+{
+    int c = reader_peek(reader);
+    if (c != EOF)
+    {
+        reader->pos++;
+    }
+    return c;
+}
+
+static bool is_space(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Finds the next whitespace-separated token and makes sure all of it sits
+ * contiguously in the buffer. After the token, trailing blanks and a single
+ * newline are consumed so a following line-based read starts on the next
+ * line, exactly as it did when every value had its own line.
+ *
+ * @param start Set to the first character of the token
+ * @param len Set to the token length
+ * @return input_status indicating success or type of error
+ */
+static input_status reader_token(const char **start, size_t *len)
+{
+    InputReader *reader = current_reader();
+    int c;
+    while ((c = reader_peek(reader)) != EOF && is_space(c))
+    {
+        reader->pos++;
+    }
+    if (c == EOF)
+    {
+        return reader->error ? INPUT_IO_ERROR : INPUT_CONVERSION_ERROR;
+    }
+
+    size_t offset = 0;
+    for (;;)
+    {
+        while (reader->pos + offset < reader->len && !is_space((unsigned char)reader->data[reader->pos + offset]))
+        {
+            offset++;
+        }
+        if (reader->pos + offset < reader->len)
+        {
+            break;
+        }
+        if (offset == sizeof(reader->data))
+        {
+            return INPUT_BUFFER_OVERFLOW;
+        }
+        if (!reader_fill(reader))
+        {
+            if (reader->error)
+            {
+                return INPUT_IO_ERROR;
+            }
+            break;
+        }
+    }
+
+    *start = reader->data + reader->pos;
+    *len = offset;
+    reader->pos += offset;
+
+    while ((c = reader_peek(reader)) == ' ' || c == '\t' || c == '\r')
+    {
+        reader->pos++;
+    }
+    if (c == '\n')
+    {
+        reader->pos++;
+    }
+    return INPUT_SUCCESS;
+}
+
+/**
+ * Parses a decimal integer token with an optional sign.
+ *
+ * @param text Token text (not NUL-terminated)
+ * @param len Token length
+ * @param min Smallest accepted value
+ * @param max Largest accepted value
+ * @param value Pointer to store the result
+ * @return INPUT_SUCCESS, INPUT_CONVERSION_ERROR, or INPUT_INTEGER_OVERFLOW
+ *         when the value does not fit in [min, max]
+ */
+static input_status parse_integer(const char *text, size_t len, long min, long max, long *value)
+{
+    size_t i = 0;
+    bool negative = false;
+
+    if (i < len && (text[i] == '+' || text[i] == '-'))
+    {
+        negative = text[i] == '-';
+        i++;
+    }
+    if (i == len)
+    {
+        return INPUT_CONVERSION_ERROR;
+    }
+
+    unsigned long magnitude = 0;
+    unsigned long limit = negative ? (unsigned long)(-(min + 1)) + 1 : (unsigned long)max;
+    bool overflow = false;
+    for (; i < len; i++)
+    {
+        unsigned digit = (unsigned)(text[i] - '0');
+        if (digit > 9)
+        {
+            return INPUT_CONVERSION_ERROR;
+        }
+        if (!overflow)
+        {
+            magnitude = magnitude * 10 + digit;
+            overflow = magnitude > limit;
+        }
+    }
+
+    if (overflow)
+    {
+        return INPUT_INTEGER_OVERFLOW;
+    }
+
+    if (negative)
+    {
+        *value = magnitude == 0 ? 0 : -(long)(magnitude - 1) - 1;
+    }
+    else
+    {
+        *value = (long)magnitude;
+    }
+    return INPUT_SUCCESS;
+}
+
+/* Powers of ten that are exactly representable as doubles */
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * Parses a floating point token. Plain decimals with at most 19 significant
+ * digits whose mantissa and power of ten are both exact doubles are
+ * converted with one multiply or divide, which is correctly rounded
+ * (Clinger's fast path). Everything else, including hex floats, inf and
+ * nan, is handed to strtod() exactly as before.
+ *
+ * @param text Token text (not NUL-terminated)
+ * @param len Token length
+ * @param value Pointer to store the result
+ * @return INPUT_SUCCESS, INPUT_CONVERSION_ERROR, or INPUT_DOUBLE_OVERFLOW
+ *         when strtod() reports a range error
+ */
+static input_status parse_double(const char *text, size_t len, double *value)
+{
+    size_t i = 0;
+    bool negative = false;
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any_digit = false;
+
+    if (i < len && (text[i] == '+' || text[i] == '-'))
+    {
+        negative = text[i] == '-';
+        i++;
+    }
+    for (; i < len && text[i] >= '0' && text[i] <= '9'; i++)
+    {
+        any_digit = true;
+        if (mantissa == 0 && text[i] == '0')
+        {
+            continue;
+        }
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (uint64_t)(text[i] - '0');
+        }
+        else
+        {
+            exponent++;
+        }
+        digits++;
+    }
+    if (i < len && text[i] == '.')
+    {
+        for (i++; i < len && text[i] >= '0' && text[i] <= '9'; i++)
+        {
+            any_digit = true;
+            if (mantissa == 0 && text[i] == '0')
+            {
+                exponent--;
+                continue;
+            }
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (uint64_t)(text[i] - '0');
+                exponent--;
+            }
+            digits++;
+        }
+    }
+    if (any_digit && i < len && (text[i] == 'e' || text[i] == 'E'))
+    {
+        size_t j = i + 1;
+        bool exp_negative = false;
+        int exp_value = 0;
+        if (j < len && (text[j] == '+' || text[j] == '-'))
+        {
+            exp_negative = text[j] == '-';
+            j++;
+        }
+        if (j < len && text[j] >= '0' && text[j] <= '9')
+        {
+            for (; j < len && text[j] >= '0' && text[j] <= '9'; j++)
+            {
+                if (exp_value < 100000)
+                {
+                    exp_value = exp_value * 10 + (text[j] - '0');
+                }
+            }
+            exponent += exp_negative ? -exp_value : exp_value;
+            i = j;
+        }
+    }
+
+    if (any_digit && i == len && digits <= 19 && mantissa <= (1ULL << 53)
+        && exponent >= -22 && exponent <= 22)
+    {
+        double result = (double)mantissa;
+        result = exponent < 0 ? result / exact_powers_of_ten[-exponent]
+                              : result * exact_powers_of_ten[exponent];
+        *value = negative ? -result : result;
+        return INPUT_SUCCESS;
+    }
+
+    /* Slow path: strtod() on a NUL-terminated copy of the token */
+    char stack_copy[128];
+    char *copy = len < sizeof(stack_copy) ? stack_copy : malloc(len + 1);
+    if (copy == NULL)
+    {
+        return INPUT_CONVERSION_ERROR;
+    }
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+
+    errno = 0;
+    char *endptr;
+    double result = strtod(copy, &endptr);
+    input_status status = INPUT_SUCCESS;
+    if (endptr == copy || *endptr != '\0')
+    {
+        status = INPUT_CONVERSION_ERROR;
+    }
+    else if (errno == ERANGE)
+    {
+        status = INPUT_DOUBLE_OVERFLOW;
+    }
+    else
+    {
+        *value = result;
+    }
+
+    if (copy != stack_copy)
+    {
+        free(copy);
+    }
+    return status;
+}
 
 /**
  * Clears the remaining input in stdin to prevent it from affecting subsequent reads.
  */
 void clear_stdin_buffer(void)
 {
+    InputReader *reader = current_reader();
     int c;
-    while ((c = getchar()) != '\n' && c != EOF)
+    while ((c = reader_getc(reader)) != '\n' && c != EOF)
         ;
 }
 
@@ -68,36 +470,25 @@ input_status input_string(char *buffer, size_t buffer_size, size_t *chars_read)
         return INPUT_BUFFER_OVERFLOW;
     }
 
-    // Clear errno before operation
-    errno = 0;
-
-    // Read input ensuring space for null terminator
-    if (fgets(buffer, (int)buffer_size, stdin) == NULL)
+    // Same contract as fgets(): at most buffer_size - 1 characters, stopping
+    // after a newline, which is stripped
+    InputReader *reader = current_reader();
+    size_t len = 0;
+    int c = EOF;
+    while (len < buffer_size - 1 && (c = reader_getc(reader)) != EOF)
     {
-        if (ferror(stdin))
+        if (c == '\n')
         {
-            clearerr(stdin);
-            return INPUT_IO_ERROR;
+            break;
         }
-        // EOF reached
-        buffer[0] = '\0';
-        *chars_read = 0;
-        return INPUT_SUCCESS;
-    }
-
-    // Check if the input was truncated (no newline found)
-    size_t len = strnlen(buffer, buffer_size);
-    if(len == buffer_size && buffer[len - 1] != '\n')
-    {
-        clear_stdin_buffer();
-        return INPUT_BUFFER_OVERFLOW;
+        buffer[len++] = (char)c;
     }
+    buffer[len] = '\0';
 
-    // Remove trailing newline if present
-    if (len > 0 && buffer[len - 1] == '\n')
+    if (c == EOF && reader->error)
     {
-        buffer[len - 1] = '\0';
-        len--;
+        reader->error = false;
+        return INPUT_IO_ERROR;
     }
 
     *chars_read = len;
@@ -117,30 +508,19 @@ input_status input_int(int *value)
         return INPUT_NULL_PTR;
     }
 
-    char buffer[32]; // Large enough for any integer
-    size_t chars_read;
-
-    input_status status = input_string(buffer, sizeof(buffer), &chars_read);
+    const char *token;
+    size_t len;
+    input_status status = reader_token(&token, &len);
     if (status != INPUT_SUCCESS)
     {
         return status;
     }
 
-    // Clear errno before conversion
-    errno = 0;
-    char *endptr;
-    long result = strtol(buffer, &endptr, 10);
-
-    // Check for conversion errors
-    if (endptr == buffer || *endptr != '\0')
-    {
-        return INPUT_CONVERSION_ERROR;
-    }
-
-    // Check for overflow/underflow
-    if (errno == ERANGE || result > INT_MAX || result < INT_MIN)
+    long result;
+    status = parse_integer(token, len, INT_MIN, INT_MAX, &result);
+    if (status != INPUT_SUCCESS)
     {
-        return INPUT_INTEGER_OVERFLOW;
+        return status;
     }
 
     *value = (int)result;
@@ -160,30 +540,23 @@ input_status input_short(short *value)
         return INPUT_NULL_PTR;
     }
 
-    char buffer[32]; // Large enough for any integer
-    size_t chars_read;
-
-    input_status status = input_string(buffer, sizeof(buffer), &chars_read);
+    const char *token;
+    size_t len;
+    input_status status = reader_token(&token, &len);
     if (status != INPUT_SUCCESS)
     {
         return status;
     }
 
-    // Clear errno before conversion
-    errno = 0;
-    char *endptr;
-    long result = strtol(buffer, &endptr, 10);
-
-    // Check for conversion errors
-    if (endptr == buffer || *endptr != '\0')
+    long result;
+    status = parse_integer(token, len, SHRT_MIN, SHRT_MAX, &result);
+    if (status == INPUT_INTEGER_OVERFLOW)
     {
-        return INPUT_CONVERSION_ERROR;
+        return INPUT_SHORT_OVERFLOW;
     }
-
-    // Check for overflow/underflow
-    if (errno == ERANGE || result > SHRT_MAX || result < SHRT_MIN)
+    if (status != INPUT_SUCCESS)
     {
-        return INPUT_SHORT_OVERFLOW;
+        return status;
     }
 
     *value = (short)result;
@@ -203,30 +576,23 @@ input_status input_float(float *value)
         return INPUT_NULL_PTR;
     }
 
-    char buffer[32]; // Large enough for any float
-    size_t chars_read;
-
-    input_status status = input_string(buffer, sizeof(buffer), &chars_read);
+    const char *token;
+    size_t len;
+    input_status status = reader_token(&token, &len);
     if (status != INPUT_SUCCESS)
     {
         return status;
     }
 
-    // Clear errno before conversion
-    errno = 0;
-    char *endptr;
-    double result = strtod(buffer, &endptr);
-
-    // Check for conversion errors
-    if (endptr == buffer || *endptr != '\0')
+    double result;
+    status = parse_double(token, len, &result);
+    if (status == INPUT_DOUBLE_OVERFLOW)
     {
-        return INPUT_CONVERSION_ERROR;
+        return INPUT_FLOAT_OVERFLOW;
     }
-
-    // Check for overflow/underflow
-    if (errno == ERANGE)
+    if (status != INPUT_SUCCESS)
     {
-        return INPUT_FLOAT_OVERFLOW;
+        return status;
     }
 
     *value = result;
@@ -246,32 +612,79 @@ input_status input_double(double *value)
         return INPUT_NULL_PTR;
     }
 
-    char buffer[64]; // Large enough for any double
-    size_t chars_read;
-
-    input_status status = input_string(buffer, sizeof(buffer), &chars_read);
+    const char *token;
+    size_t len;
+    input_status status = reader_token(&token, &len);
     if (status != INPUT_SUCCESS)
     {
         return status;
     }
 
-    // Clear errno before conversion
-    errno = 0;
-    char *endptr;
-    double result = strtod(buffer, &endptr);
+    return parse_double(token, len, value);
+}
 
-    // Check for conversion errors
-    if (endptr == buffer || *endptr != '\0')
+/**
+ * Reads a boolean token: W or 1 is true, L or 0 is false
+ *
+ * @param value Pointer to store the boolean value
+ * @return input_status indicating success or type of error
+ */
+input_status input_bool(bool *value)
+{
+    if (value == NULL)
+    {
+        return INPUT_NULL_PTR;
+    }
+
+    const char *token;
+    size_t len;
+    input_status status = reader_token(&token, &len);
+    if (status != INPUT_SUCCESS)
+    {
+        return status;
+    }
+
+    if (len != 1)
     {
         return INPUT_CONVERSION_ERROR;
     }
+    if (token[0] == 'W' || token[0] == '1')
+    {
+        *value = true;
+    }
+    else if (token[0] == 'L' || token[0] == '0')
+    {
+        *value = false;
+    }
+    else
+    {
+        return INPUT_CONVERSION_ERROR;
+    }
+    return INPUT_SUCCESS;
+}
 
-    // Check for overflow/underflow
-    if (errno == ERANGE)
+/**
+ * Reads the next non-whitespace character, without line semantics
+ *
+ * @param value Pointer to store the character value
+ * @return input_status indicating success or type of error
+ */
+input_status input_char_token(char *value)
+{
+    if (value == NULL)
     {
-        return INPUT_DOUBLE_OVERFLOW;
+        return INPUT_NULL_PTR;
     }
 
-    *value = result;
+    InputReader *reader = current_reader();
+    int c;
+    while ((c = reader_getc(reader)) != EOF && is_space(c))
+        ;
+    if (c == EOF)
+    {
+        return reader->error ? INPUT_IO_ERROR : INPUT_INVALID_LENGTH;
+    }
+
+    *value = (char)c;
     return INPUT_SUCCESS;
 }
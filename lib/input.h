@@ -7,11 +7,20 @@
  * - Memory leaks
  * - Integer overflows
  * - Format string vulnerabilities
+ *
+ * Input is read from fd 0 in large blocks. Numeric readers take the next
+ * whitespace-separated token, so values may be spread over lines or share
+ * one; input_string() and input_char() read line by line like fgets().
+ * Nothing else should read stdin through stdio while these are in use.
+ *
+ * A thread can read from another source instead by creating a reader for it
+ * and selecting it with input_use().
  */
 
 #ifndef INPUT_H
 #define INPUT_H
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,6 +44,39 @@ typedef enum
     INPUT_INVALID_LENGTH = -10,
 } input_status;
 
+/**
+ * Input source for input_reader_new(): fills buf with up to size bytes and
+ * returns how many, or 0 at the end of the input
+ */
+typedef size_t (*input_source)(void *data, char *buf, size_t size);
+
+typedef struct InputReader InputReader;
+
+/**
+ * Creates a reader with its own buffer that pulls from source
+ *
+ * @return the reader, or NULL when out of memory
+ */
+InputReader *input_reader_new(input_source source, void *data);
+
+/**
+ * Frees a reader from input_reader_new(); NULL is ignored
+ */
+void input_reader_free(InputReader *reader);
+
+/**
+ * Makes the input functions on the calling thread read from reader, or
+ * from fd 0 when reader is NULL
+ */
+void input_use(InputReader *reader);
+
+/**
+ * Sets a function to call before a read from fd 0 that may block; it
+ * returns once fd 0 has input or is at its end. Lets a green thread wait
+ * for input without holding up its worker.
+ */
+void input_set_wait(void (*wait)(int fd));
+
 /**
  * Clears the remaining input in stdin to prevent it from affecting subsequent reads.
  */
@@ -90,4 +132,20 @@ input_status input_float(float *value);
  */
 input_status input_double(double *value);
 
+/**
+ * Reads a boolean token: W or 1 is true, L or 0 is false
+ *
+ * @param value Pointer to store the boolean value
+ * @return input_status indicating success or type of error
+ */
+input_status input_bool(bool *value);
+
+/**
+ * Reads the next non-whitespace character, without line semantics
+ *
+ * @param value Pointer to store the character value
+ * @return input_status indicating success or type of error
+ */
+input_status input_char_token(char *value);
+
 #endif // INPUT_H
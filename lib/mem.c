@@ -1,6 +1,17 @@
 #include "mem.h"
 #include "string_value.h"
 #include <stdint.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Arrays up to this many bytes are recycled through size-class free lists;
+// larger ones get an anonymous mapping of their own
+#define ARRAY_POOL_MAX ((size_t)32 * 1024)
+#define ARRAY_POOL_CLASSES 10 // ARRAY_ALIGNMENT << 0 .. ARRAY_POOL_MAX
+
+// Mappings at least this large start on a transparent huge page boundary
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
 
 /**
  * @brief Retrieves the memory block header from a user pointer
@@ -205,6 +216,207 @@ void *safe_malloc_array(size_t nmemb, size_t size)
     return safe_malloc(nmemb * size);
 }
 
+/* Free pooled array blocks, by size class. A block starts ARRAY_ALIGNMENT
+ * bytes before its data, with the header at the end of that prefix; the
+ * link to the next free block lives at the start of the prefix so the data
+ * itself stays zero while the block waits for reuse. */
+static void *array_pool[ARRAY_POOL_CLASSES];
+static pthread_mutex_t array_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t array_pool_once = PTHREAD_ONCE_INIT;
+
+// A fork() from one thread while another holds the lock would leave the
+// child's pool locked for good
+static void lock_array_pool(void)
+{
+    pthread_mutex_lock(&array_pool_lock);
+}
+
+static void unlock_array_pool(void)
+{
+    pthread_mutex_unlock(&array_pool_lock);
+}
+
+static void init_array_pool(void)
+{
+    pthread_atfork(lock_array_pool, unlock_array_pool, unlock_array_pool);
+}
+
+static size_t array_pool_class(size_t size)
+{
+    size_t cls = 0;
+    while (((size_t)ARRAY_ALIGNMENT << cls) < size)
+    {
+        cls++;
+    }
+    return cls;
+}
+
+static size_t array_mapping_length(size_t size)
+{
+    static size_t page_size;
+    if (page_size == 0)
+    {
+        page_size = (size_t)sysconf(_SC_PAGESIZE);
+    }
+    return (size + ARRAY_ALIGNMENT + page_size - 1) & ~(page_size - 1);
+}
+
+static char *map_array(size_t length)
+{
+    if (length < HUGE_PAGE_SIZE)
+    {
+        void *base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return base == MAP_FAILED ? NULL : base;
+    }
+
+    // Over-map by one huge page, then trim to a huge page boundary so the
+    // kernel can back the array with huge pages from its first byte
+    size_t raw_length = length + HUGE_PAGE_SIZE;
+    char *raw = mmap(NULL, raw_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+    {
+        return NULL;
+    }
+    char *base = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (base > raw)
+    {
+        munmap(raw, (size_t)(base - raw));
+    }
+    size_t tail = (size_t)(raw + raw_length - (base + length));
+    if (tail > 0)
+    {
+        munmap(base + length, tail);
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(base, length, MADV_HUGEPAGE);
+#endif
+    return base;
+}
+
+/**
+ * @brief Allocates zeroed, cache-line aligned storage for an array
+ *
+ * The data is aligned to ARRAY_ALIGNMENT. Arrays up to ARRAY_POOL_MAX bytes
+ * reuse blocks from a per-size-class pool, which safe_free() wipes before
+ * taking them back. Larger arrays are mapped straight from the kernel, so
+ * they start out as untouched zero pages and are never memset; those of a
+ * huge page or more are advised to use transparent huge pages.
+ *
+ * @param nmemb Number of elements to allocate
+ * @param size Size of each element
+ * @return void* Pointer to zeroed storage, or NULL if:
+ *         - nmemb or size is 0
+ *         - nmemb * size would overflow
+ *         - system is out of memory
+ *
+ * @note Release with SAFE_FREE like any other safe_malloc block
+ */
+void *safe_aligned_array(size_t nmemb, size_t size)
+{
+    if (nmemb == 0 || size == 0)
+    {
+        return NULL;
+    }
+
+    // Check multiplication overflow, leaving room for the mapping slack
+    if (nmemb > (MAX_ALLOC_SIZE - 2 * HUGE_PAGE_SIZE) / size)
+    {
+        return handle_malloc_error(nmemb * size);
+    }
+    size_t aligned_size = align_size(nmemb * size);
+
+    char *base;
+    if (aligned_size <= ARRAY_POOL_MAX)
+    {
+        size_t cls = array_pool_class(aligned_size);
+        pthread_once(&array_pool_once, init_array_pool);
+        lock_array_pool();
+        base = array_pool[cls];
+        if (base)
+        {
+            array_pool[cls] = *(void **)base;
+        }
+        unlock_array_pool();
+        if (base == NULL)
+        {
+            size_t capacity = (size_t)ARRAY_ALIGNMENT << cls;
+            base = aligned_alloc(ARRAY_ALIGNMENT, ARRAY_ALIGNMENT + capacity);
+            if (base == NULL)
+            {
+                return handle_malloc_error(aligned_size);
+            }
+            memset(base + ARRAY_ALIGNMENT, 0, capacity);
+        }
+    }
+    else
+    {
+        base = map_array(array_mapping_length(aligned_size));
+        if (base == NULL)
+        {
+            return handle_malloc_error(aligned_size);
+        }
+    }
+
+    mem_block_t *block = (mem_block_t *)(base + ARRAY_ALIGNMENT) - 1;
+    block->guard = ARRAY_MEMORY_GUARD;
+    block->size = aligned_size;
+    return block->data;
+}
+
+/**
+ * @brief Copies a safe_aligned_array() block into a new one
+ *
+ * @param array Storage returned by safe_aligned_array()
+ * @return void* Pointer to the copy, or NULL if array is NULL, was not
+ *         allocated by safe_aligned_array(), or memory ran out
+ *
+ * @note Release with SAFE_FREE like any other safe_malloc block
+ */
+void *safe_aligned_array_dup(const void *array)
+{
+    if (!array)
+    {
+        return NULL;
+    }
+    mem_block_t *block = get_block_ptr(array);
+    if (block->guard != ARRAY_MEMORY_GUARD)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void *copy = safe_aligned_array(block->size, 1);
+    if (copy)
+    {
+        memcpy(copy, array, block->size);
+    }
+    return copy;
+}
+
+// Returns a safe_aligned_array() block to the pool or the kernel
+static void release_aligned_array(mem_block_t *block)
+{
+    char *base = block->data - ARRAY_ALIGNMENT;
+    size_t size = block->size;
+
+    block->guard = 0;
+    block->size = 0;
+    if (size <= ARRAY_POOL_MAX)
+    {
+        // Pooled blocks must come back zeroed
+        memset(block->data, 0, size);
+        size_t cls = array_pool_class(size);
+        lock_array_pool();
+        *(void **)base = array_pool[cls];
+        array_pool[cls] = base;
+        unlock_array_pool();
+    }
+    else
+    {
+        munmap(base, array_mapping_length(size));
+    }
+}
+
 /**
  * @brief Validates if a pointer was allocated by safe_malloc
  *
@@ -222,14 +434,14 @@ int is_safe_malloc_ptr(const void *ptr)
     if (!ptr)
         return 0;
     mem_block_t *block = get_block_ptr(ptr);
-    return block->guard == MEMORY_GUARD;
+    return block->guard == MEMORY_GUARD || block->guard == ARRAY_MEMORY_GUARD;
 }
 
 /**
  * @brief Safely frees memory allocated by safe_malloc
  *
  * Frees memory with additional safety features:
- * - Validates the pointer was allocated by safe_malloc
+ * - Validates the pointer was allocated by safe_malloc or safe_aligned_array
  * - Wipes memory contents before freeing
  * - Sets pointer to NULL after freeing
  * - Handles NULL pointers safely
@@ -248,6 +460,12 @@ void safe_free(void **ptr, const char* file, int line, const char* func)
     }
 
     mem_block_t *block = get_block_ptr(*ptr);
+    if (block && block->guard == ARRAY_MEMORY_GUARD)
+    {
+        release_aligned_array(block);
+        *ptr = NULL;
+        return;
+    }
     if (!block || block->guard != MEMORY_GUARD)
     {
         fprintf(stderr, "Warning: Attempt to free invalid/corrupted pointer, %s, %d, %s\n",
@@ -20,6 +20,12 @@
 // Magic number to detect buffer overruns and validate pointers
 #define MEMORY_GUARD 0xDEADBEEFDEADBEEFULL
 
+// Guard for blocks from safe_aligned_array(), which are released differently
+#define ARRAY_MEMORY_GUARD 0xDEADBEEFA77A7A7AULL
+
+// Alignment of array storage: one cache line, and enough for any vector load
+#define ARRAY_ALIGNMENT 64
+
 typedef struct
 {
     size_t guard; // Memory guard to detect corruption
@@ -36,11 +42,14 @@ void *safe_memcpy(void *dest, const void *src, size_t n);
 String safe_strdup(const String *str);
 int is_safe_malloc_ptr(const void *ptr);
 void *safe_calloc(size_t count, size_t size);
+void *safe_aligned_array(size_t nmemb, size_t size);
+void *safe_aligned_array_dup(const void *array);
 
 // Convenience macro for type-safe allocation
 #define SAFE_MALLOC(type) ((type *)safe_malloc(sizeof(type)))
 #define SAFE_CALLOC(c, type) ((type *)safe_calloc((c), sizeof(type)))
 #define SAFE_MALLOC_ARRAY(type, n) ((type *)safe_malloc_array((n), sizeof(type)))
+#define SAFE_ALIGNED_ARRAY(type, n) ((type *)safe_aligned_array((n), sizeof(type)))
 // Convenience macro for safer free usage
 #define SAFE_FREE(ptr) safe_free((void **)&(ptr), __FILE__, __LINE__, __func__)
 
@@ -0,0 +1,216 @@
+#include "pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Chunks not yet started from one worker's share: the owner takes from
+ * next, thieves take from end */
+typedef struct {
+    pthread_mutex_t lock;
+    size_t next, end;
+} Share;
+
+static struct {
+    pthread_mutex_t run_lock; /* held for the whole of a job */
+    pthread_mutex_t lock;     /* guards everything below */
+    pthread_cond_t start, done;
+    unsigned long generation; /* bumped for every job */
+    int helpers;              /* threads started so far */
+    int workers;              /* workers in the current job, caller included */
+    int busy;                 /* helpers still working on it */
+    pool_task task;
+    void *data;
+    Share shares[POOL_MAX_THREADS];
+} pool = {
+    .run_lock = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .start = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+static pthread_once_t shares_once = PTHREAD_ONCE_INIT;
+
+/* Set while a thread works on a job, so a nested pool_run() runs inline */
+static _Thread_local bool in_pool;
+
+/* fork() waits for the running job, if any. The child has none of the
+ * helpers, so it starts its own when it needs them. */
+static void fork_prepare(void)
+{
+    pthread_mutex_lock(&pool.run_lock);
+    pthread_mutex_lock(&pool.lock);
+}
+
+static void fork_parent(void)
+{
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.run_lock);
+}
+
+static void fork_child(void)
+{
+    pool.helpers = 0;
+    pthread_cond_init(&pool.start, NULL);
+    pthread_cond_init(&pool.done, NULL);
+    fork_parent();
+}
+
+static void init_shares(void)
+{
+    for (int i = 0; i < POOL_MAX_THREADS; i++)
+    {
+        pthread_mutex_init(&pool.shares[i].lock, NULL);
+    }
+    /* Helpers exist from the first job on */
+    pthread_atfork(fork_prepare, fork_parent, fork_child);
+}
+
+int pool_size(void)
+{
+    const char *env = getenv("BRAINROT_THREADS");
+    long n = env ? strtol(env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > POOL_MAX_THREADS) n = POOL_MAX_THREADS;
+    return (int)n;
+}
+
+static bool take_own(Share *share, size_t *chunk)
+{
+    pthread_mutex_lock(&share->lock);
+    bool found = share->next < share->end;
+    if (found)
+    {
+        *chunk = share->next++;
+    }
+    pthread_mutex_unlock(&share->lock);
+    return found;
+}
+
+static bool steal(int worker, int workers, size_t *chunk)
+{
+    for (int i = 1; i < workers; i++)
+    {
+        Share *victim = &pool.shares[(worker + i) % workers];
+        pthread_mutex_lock(&victim->lock);
+        bool found = victim->next < victim->end;
+        if (found)
+        {
+            *chunk = --victim->end;
+        }
+        pthread_mutex_unlock(&victim->lock);
+        if (found)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void work(int worker, int workers)
+{
+    size_t chunk;
+    while (take_own(&pool.shares[worker], &chunk) || steal(worker, workers, &chunk))
+    {
+        pool.task(pool.data, chunk, worker);
+    }
+}
+
+static void *helper_main(void *arg)
+{
+    int worker = (int)(intptr_t)arg;
+    unsigned long seen = 0;
+    in_pool = true;
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;)
+    {
+        while (pool.generation == seen)
+        {
+            pthread_cond_wait(&pool.start, &pool.lock);
+        }
+        seen = pool.generation;
+        int workers = pool.workers;
+        if (worker >= workers)
+        {
+            continue; /* this job is too small to need us */
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        work(worker, workers);
+
+        pthread_mutex_lock(&pool.lock);
+        if (--pool.busy == 0)
+        {
+            pthread_cond_signal(&pool.done);
+        }
+    }
+    return NULL;
+}
+
+/* Makes sure workers - 1 helpers exist; returns how many workers there
+ * really are if a thread could not be started */
+static int start_helpers(int workers)
+{
+    while (pool.helpers < workers - 1)
+    {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        int failed = pthread_create(&thread, &attr, helper_main, (void *)(intptr_t)(pool.helpers + 1));
+        pthread_attr_destroy(&attr);
+        if (failed)
+        {
+            break;
+        }
+        pool.helpers++;
+    }
+    return pool.helpers + 1 < workers ? pool.helpers + 1 : workers;
+}
+
+void pool_run(size_t chunks, pool_task task, void *data)
+{
+    int workers = pool_size();
+    if ((size_t)workers > chunks)
+    {
+        workers = (int)chunks;
+    }
+    if (workers <= 1 || in_pool || pthread_mutex_trylock(&pool.run_lock) != 0)
+    {
+        for (size_t chunk = 0; chunk < chunks; chunk++)
+        {
+            task(data, chunk, 0);
+        }
+        return;
+    }
+
+    pthread_once(&shares_once, init_shares);
+    pthread_mutex_lock(&pool.lock);
+    workers = start_helpers(workers);
+    for (int i = 0; i < workers; i++)
+    {
+        pool.shares[i].next = chunks * i / workers;
+        pool.shares[i].end = chunks * (i + 1) / workers;
+    }
+    pool.task = task;
+    pool.data = data;
+    pool.workers = workers;
+    pool.busy = workers - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.start);
+    pthread_mutex_unlock(&pool.lock);
+
+    in_pool = true;
+    work(0, workers);
+    in_pool = false;
+
+    pthread_mutex_lock(&pool.lock);
+    while (pool.busy > 0)
+    {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.run_lock);
+}
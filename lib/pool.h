@@ -0,0 +1,36 @@
+/* pool.h – Work-stealing thread pool
+ *
+ * pool_run() splits a job into numbered chunks and hands each worker an
+ * equal, contiguous share of them. A worker takes chunks from the front of
+ * its own share; once that is empty it steals from the back of the others,
+ * so a share that turned out slow gets finished by whoever is idle.
+ *
+ * Helper threads are started the first time they are needed and then wait
+ * for the next job for the rest of the process. The calling thread works
+ * too, as worker 0. One job runs at a time: a pool_run() from inside a
+ * chunk, or from another thread while a job is running, runs its chunks
+ * inline on the caller instead of waiting.
+ *
+ * The pool survives fork(): the child gets a pool with no helpers yet.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+#define POOL_MAX_THREADS 16
+
+/* Runs one chunk. worker (0 .. pool_size() - 1) identifies the thread
+ * running it: no two chunks with the same worker run at the same time. */
+typedef void (*pool_task)(void *data, size_t chunk, int worker);
+
+/* Workers a job can use: BRAINROT_THREADS, or the number of online CPUs,
+ * clamped to 1..POOL_MAX_THREADS */
+int pool_size(void);
+
+/* Calls task once for every chunk in 0..chunks - 1 and returns when all
+ * of them have finished. The order chunks run in is unspecified. */
+void pool_run(size_t chunks, pool_task task, void *data);
+
+#endif /* POOL_H */
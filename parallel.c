@@ -0,0 +1,709 @@
+/* parallel.c - squad flex loops and callbacks from builtins, see parallel.h */
+
+#include "parallel.h"
+#include "interpreter.h"
+#include "stdrot.h"
+#include "lib/pool.h"
+
+#include <limits.h>
+#include <math.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern void yyerror(const char *s);
+
+/* One chunk's value of a combo variable */
+typedef union {
+    int ivalue;
+    short svalue;
+    float fvalue;
+    double dvalue;
+} Partial;
+
+typedef struct {
+    ASTNode *loop;
+    SquadShape shape;
+    Runtime *parent;
+    Scope *base;             /* the parent's scope when the loop started */
+    long long start;
+    size_t iterations, chunks;
+    Variable **targets;      /* outer variable of each reduction */
+    size_t reduction_count;
+    Partial *partials;       /* chunks x reduction_count */
+    Runtime *workers[POOL_MAX_THREADS];
+    Interpreter *interpreters[POOL_MAX_THREADS];
+    int failed;              /* set by the first chunk that ends the program */
+    int status;
+} SquadRun;
+
+static bool is_counter(const ASTNode *node, String var)
+{
+    return node && node->type == NODE_IDENTIFIER && strcmp(node->data.name.data, var.data) == 0;
+}
+
+static bool squad_step(const ASTNode *incr, String var, int *step)
+{
+    if (!incr)
+        return false;
+    if (incr->type == NODE_UNARY_OPERATION && is_counter(incr->data.unary.operand, var))
+    {
+        switch (incr->data.unary.op)
+        {
+        case OP_POST_INC:
+        case OP_PRE_INC:
+            *step = 1;
+            return true;
+        case OP_POST_DEC:
+        case OP_PRE_DEC:
+            *step = -1;
+            return true;
+        default:
+            return false;
+        }
+    }
+    /* i = i + k or i = i - k */
+    if (incr->type != NODE_ASSIGNMENT || !is_counter(incr->data.op.left, var))
+        return false;
+    const ASTNode *sum = incr->data.op.right;
+    if (!sum || sum->type != NODE_OPERATION || !is_counter(sum->data.op.left, var))
+        return false;
+    const ASTNode *k = sum->data.op.right;
+    if (!k || k->type != NODE_INT || k->data.ivalue <= 0)
+        return false;
+    if (sum->data.op.op == OP_PLUS)
+        *step = k->data.ivalue;
+    else if (sum->data.op.op == OP_MINUS)
+        *step = -k->data.ivalue;
+    else
+        return false;
+    return true;
+}
+
+bool squad_loop_shape(const ASTNode *loop, SquadShape *shape)
+{
+    const ASTNode *init = loop->data.for_stmt.init;
+    const ASTNode *cond = loop->data.for_stmt.cond;
+    if (!init || !cond)
+        return false;
+
+    if (init->type == NODE_DECLARATION)
+    {
+        if (init->var_type != VAR_INT || init->pointer_level != 0 || init->modifiers.is_static)
+            return false;
+        shape->declares_var = true;
+    }
+    else if (init->type == NODE_ASSIGNMENT && init->data.op.left && init->data.op.left->type == NODE_IDENTIFIER)
+    {
+        shape->declares_var = false;
+    }
+    else
+    {
+        return false;
+    }
+    shape->var = init->data.op.left->data.name;
+    shape->start = init->data.op.right;
+
+    if (cond->type != NODE_OPERATION || !is_counter(cond->data.op.left, shape->var))
+        return false;
+    shape->cmp = cond->data.op.op;
+    shape->bound = cond->data.op.right;
+
+    if (!shape->start || !shape->bound || !squad_step(loop->data.for_stmt.incr, shape->var, &shape->step))
+        return false;
+    switch (shape->cmp)
+    {
+    case OP_LT:
+    case OP_LE:
+        return shape->step > 0;
+    case OP_GT:
+    case OP_GE:
+        return shape->step < 0;
+    default:
+        return false;
+    }
+}
+
+static size_t trip_count(long long start, long long bound, OperatorType cmp, int step)
+{
+    switch (cmp)
+    {
+    case OP_LT:
+        return start < bound ? (size_t)((bound - start + step - 1) / step) : 0;
+    case OP_LE:
+        return start <= bound ? (size_t)((bound - start) / step + 1) : 0;
+    case OP_GT:
+        return start > bound ? (size_t)((start - bound - step - 1) / -step) : 0;
+    case OP_GE:
+        return start >= bound ? (size_t)((start - bound) / -step + 1) : 0;
+    default:
+        return 0;
+    }
+}
+
+static bool is_reducible(const Variable *var)
+{
+    return !var->is_array && var->pointer_level == 0 && !var->modifiers.is_static &&
+           (var->var_type == VAR_INT || var->var_type == VAR_SHORT ||
+            var->var_type == VAR_FLOAT || var->var_type == VAR_DOUBLE);
+}
+
+static Partial identity(ReductionOp op, const Variable *var)
+{
+    bool is_unsigned = var->modifiers.is_unsigned;
+    Partial p;
+    switch (var->var_type)
+    {
+    case VAR_INT:
+        p.ivalue = op == REDUCE_SUM       ? 0
+                   : op == REDUCE_PRODUCT ? 1
+                   : op == REDUCE_MIN     ? (is_unsigned ? -1 : INT_MAX)
+                                          : (is_unsigned ? 0 : INT_MIN);
+        break;
+    case VAR_SHORT:
+        p.svalue = op == REDUCE_SUM       ? 0
+                   : op == REDUCE_PRODUCT ? 1
+                   : op == REDUCE_MIN     ? (is_unsigned ? -1 : SHRT_MAX)
+                                          : (is_unsigned ? 0 : SHRT_MIN);
+        break;
+    case VAR_FLOAT:
+        p.fvalue = op == REDUCE_SUM       ? 0.0f
+                   : op == REDUCE_PRODUCT ? 1.0f
+                   : op == REDUCE_MIN     ? INFINITY
+                                          : -INFINITY;
+        break;
+    default:
+        p.dvalue = op == REDUCE_SUM       ? 0.0
+                   : op == REDUCE_PRODUCT ? 1.0
+                   : op == REDUCE_MIN     ? INFINITY
+                                          : -INFINITY;
+        break;
+    }
+    return p;
+}
+
+static Partial load_partial(const Variable *var)
+{
+    Partial p;
+    switch (var->var_type)
+    {
+    case VAR_INT: p.ivalue = var->value.ivalue; break;
+    case VAR_SHORT: p.svalue = var->value.svalue; break;
+    case VAR_FLOAT: p.fvalue = var->value.fvalue; break;
+    default: p.dvalue = var->value.dvalue; break;
+    }
+    return p;
+}
+
+static void store_partial(Variable *var, Partial p)
+{
+    switch (var->var_type)
+    {
+    case VAR_INT: var->value.ivalue = p.ivalue; break;
+    case VAR_SHORT: var->value.svalue = p.svalue; break;
+    case VAR_FLOAT: var->value.fvalue = p.fvalue; break;
+    default: var->value.dvalue = p.dvalue; break;
+    }
+}
+
+/* Integer sums and products wrap around like the serial loop would on
+ * every compiler we build with, without the undefined behaviour */
+#define COMBINE(op, a, b, wrap, less)                 \
+    ((op) == REDUCE_SUM       ? wrap((a), (b), +)     \
+     : (op) == REDUCE_PRODUCT ? wrap((a), (b), *)     \
+     : (op) == REDUCE_MIN     ? (less((b), (a)) ? (b) : (a)) \
+                              : (less((a), (b)) ? (b) : (a)))
+
+#define WRAP_INT(a, b, o) ((int)((unsigned)(a) o (unsigned)(b)))
+#define WRAP_SHORT(a, b, o) ((short)(unsigned short)((unsigned)(a) o (unsigned)(b)))
+#define PLAIN(a, b, o) ((a) o (b))
+#define LESS(a, b) ((a) < (b))
+#define LESS_UINT(a, b) ((unsigned)(a) < (unsigned)(b))
+#define LESS_USHORT(a, b) ((unsigned short)(a) < (unsigned short)(b))
+
+static void combine(ReductionOp op, Variable *var, Partial p)
+{
+    bool is_unsigned = var->modifiers.is_unsigned;
+    Partial acc = load_partial(var);
+    switch (var->var_type)
+    {
+    case VAR_INT:
+        acc.ivalue = is_unsigned ? COMBINE(op, acc.ivalue, p.ivalue, WRAP_INT, LESS_UINT)
+                                 : COMBINE(op, acc.ivalue, p.ivalue, WRAP_INT, LESS);
+        break;
+    case VAR_SHORT:
+        acc.svalue = is_unsigned ? COMBINE(op, acc.svalue, p.svalue, WRAP_SHORT, LESS_USHORT)
+                                 : COMBINE(op, acc.svalue, p.svalue, WRAP_SHORT, LESS);
+        break;
+    case VAR_FLOAT:
+        acc.fvalue = COMBINE(op, acc.fvalue, p.fvalue, PLAIN, LESS);
+        break;
+    default:
+        acc.dvalue = COMBINE(op, acc.dvalue, p.dvalue, PLAIN, LESS);
+        break;
+    }
+    store_partial(var, acc);
+}
+
+static Variable *declare(String name, VarType type, TypeModifiers modifiers)
+{
+    Variable *var = variable_new(name);
+    var->var_type = type;
+    var->modifiers = modifiers;
+    add_variable_to_scope(name, var);
+    SAFE_FREE(var);
+    return get_variable(name);
+}
+
+/* Runs one chunk's iterations in the current (worker) runtime. Kept out
+ * of execute_chunk() so none of its locals live across the setjmp. */
+__attribute__((noinline)) static void run_chunk(SquadRun *run, size_t chunk)
+{
+    const SquadShape *shape = &run->shape;
+    size_t first = run->iterations * chunk / run->chunks;
+    size_t last = run->iterations * (chunk + 1) / run->chunks;
+    Partial *partials = run->partials + chunk * run->reduction_count;
+
+    enter_scope();
+    const ASTNode *init = run->loop->data.for_stmt.init;
+    declare(shape->var, VAR_INT, shape->declares_var ? init->modifiers : (TypeModifiers){0});
+    size_t r = 0;
+    for (Reduction *reduction = run->loop->data.for_stmt.reductions; reduction; reduction = reduction->next, r++)
+    {
+        Variable *var = declare(reduction->name, run->targets[r]->var_type, run->targets[r]->modifiers);
+        store_partial(var, identity(reduction->op, var));
+    }
+    /* Adding variables may have moved the ones before */
+    Variable *counter = get_variable(shape->var);
+
+    Visitor *visitor = (Visitor *)current_runtime->interpreter;
+    for (size_t i = first; i < last; i++)
+    {
+        counter->value.ivalue = (int)(run->start + (long long)i * shape->step);
+        enter_scope();
+        ast_accept(run->loop->data.for_stmt.body, visitor);
+        exit_scope();
+    }
+
+    r = 0;
+    for (Reduction *reduction = run->loop->data.for_stmt.reductions; reduction; reduction = reduction->next, r++)
+    {
+        partials[r] = load_partial(get_variable(reduction->name));
+    }
+    exit_scope();
+}
+
+/* ragequit and runtime errors inside a chunk end the loop, not the thread */
+static void execute_chunk(SquadRun *run, size_t chunk)
+{
+    jmp_buf exit_jump;
+    current_runtime->exit_jump = &exit_jump;
+    if (setjmp(exit_jump) == 0)
+    {
+        run_chunk(run, chunk);
+    }
+    else
+    {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&run->failed, &expected, 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            run->status = current_runtime->exit_status;
+        while (current_runtime->scope != run->base)
+            exit_scope();
+        CLEAN_JUMP_BUFFER();
+    }
+    current_runtime->exit_jump = NULL;
+}
+
+static void squad_task(void *data, size_t chunk, int worker)
+{
+    SquadRun *run = data;
+    if (__atomic_load_n(&run->failed, __ATOMIC_RELAXED))
+        return;
+
+    Runtime *previous = current_runtime;
+    if (!run->workers[worker])
+    {
+        run->workers[worker] = runtime_worker(run->parent);
+        current_runtime = run->workers[worker];
+        run->interpreters[worker] = interpreter_new();
+        current_runtime->interpreter = run->interpreters[worker];
+    }
+    current_runtime = run->workers[worker];
+    execute_chunk(run, chunk);
+    current_runtime = previous;
+}
+
+static void squad_error(const char *message, String name)
+{
+    char error_msg[MAX_BUFFER_LEN];
+    snprintf(error_msg, sizeof(error_msg), message, name.data);
+    yyerror(error_msg);
+    runtime_exit(1);
+}
+
+void execute_squad_loop(ASTNode *loop)
+{
+    SquadRun run = {0};
+    if (!squad_loop_shape(loop, &run.shape))
+    {
+        yyerror("Invalid squad flex loop");
+        runtime_exit(1);
+    }
+    const SquadShape *shape = &run.shape;
+
+    Variable *counter = NULL;
+    if (!shape->declares_var)
+    {
+        counter = get_variable(shape->var);
+        if (!counter || counter->var_type != VAR_INT || counter->is_array ||
+            counter->pointer_level != 0 || counter->modifiers.is_static)
+            squad_error("squad flex counter '%s' must be a rizz variable", shape->var);
+    }
+
+    for (Reduction *reduction = loop->data.for_stmt.reductions; reduction; reduction = reduction->next)
+    {
+        Variable *var = get_variable(reduction->name);
+        if (!var || !is_reducible(var))
+            squad_error("combo variable '%s' must be a number variable", reduction->name);
+        run.reduction_count++;
+    }
+
+    run.loop = loop;
+    run.parent = current_runtime;
+    run.base = current_runtime->scope;
+    run.start = evaluate_expression_int(shape->start);
+    long long bound = evaluate_expression_int(shape->bound);
+    run.iterations = trip_count(run.start, bound, shape->cmp, shape->step);
+    run.chunks = run.iterations < SQUAD_CHUNKS ? run.iterations : SQUAD_CHUNKS;
+
+    if (run.chunks > 0)
+    {
+        if (run.reduction_count > 0)
+        {
+            run.targets = SAFE_MALLOC_ARRAY(Variable *, run.reduction_count);
+            run.partials = SAFE_MALLOC_ARRAY(Partial, run.chunks * run.reduction_count);
+            size_t r = 0;
+            for (Reduction *reduction = loop->data.for_stmt.reductions; reduction; reduction = reduction->next)
+                run.targets[r++] = get_variable(reduction->name);
+        }
+
+        pool_run(run.chunks, squad_task, &run);
+
+        for (int i = 0; i < POOL_MAX_THREADS; i++)
+        {
+            interpreter_free(run.interpreters[i]);
+            runtime_worker_free(run.workers[i]);
+        }
+        if (!run.failed)
+        {
+            for (size_t chunk = 0; chunk < run.chunks; chunk++)
+            {
+                size_t r = 0;
+                for (Reduction *reduction = loop->data.for_stmt.reductions; reduction; reduction = reduction->next, r++)
+                    combine(reduction->op, run.targets[r], run.partials[chunk * run.reduction_count + r]);
+            }
+        }
+        SAFE_FREE(run.targets);
+        SAFE_FREE(run.partials);
+        if (run.failed)
+            runtime_exit(run.status);
+    }
+
+    /* Leave an outer counter where the serial loop would have */
+    if (counter)
+        counter->value.ivalue = (int)(run.start + (long long)run.iterations * shape->step);
+}
+
+/* ── Brainrot functions called from builtins ─────────────────────────────── */
+
+/* Functions a purity check follows calls into, at most */
+#define PURE_MAX_FUNCTIONS 64
+
+typedef struct {
+    Function *seen[PURE_MAX_FUNCTIONS];
+    int count;
+    const char *problem; /* first reason the function is not pure */
+    String where;        /* function the problem is in */
+} PureCheck;
+
+typedef struct {
+    void (*chunk)(void *data, size_t chunk);
+    void *data;
+    Runtime *parent;
+    Runtime *workers[POOL_MAX_THREADS];
+    Interpreter *interpreters[POOL_MAX_THREADS];
+    int failed;
+    int status;
+} CallbackRun;
+
+/* Reports a misused builtin the way stdrot/args.c does */
+__attribute__((noreturn)) static void callback_error(const char *message, String function)
+{
+    ExecutionContext *ctx = &current_runtime->exec_context;
+    fprintf(ctx->err, "Error: %s: ", ctx->function_name.data ? ctx->function_name.data : "builtin");
+    fprintf(ctx->err, message, function.data);
+    fprintf(ctx->err, " at line %d\n", ctx->line_number);
+    runtime_exit(EXIT_FAILURE);
+}
+
+static bool is_number_type(VarType type)
+{
+    return type == VAR_INT || type == VAR_SHORT || type == VAR_FLOAT ||
+           type == VAR_DOUBLE || type == VAR_BOOL || type == VAR_CHAR;
+}
+
+static void pure_function(PureCheck *check, Function *func);
+
+static void pure_walk(PureCheck *check, Function *func, const ASTNode *node)
+{
+    if (!node || check->problem)
+        return;
+
+    switch (node->type)
+    {
+    case NODE_STATEMENT_LIST:
+        for (StatementList *s = node->data.statements; s; s = s->next)
+            pure_walk(check, func, s->statement);
+        return;
+    case NODE_DECLARATION:
+        /* Statics and gang variables outlive the call */
+        if (node->modifiers.is_static || node->var_type == VAR_STRUCT)
+            check->problem = "'%s' must not declare salty or gang variables";
+        break;
+    case NODE_ARRAY_ACCESS:
+        /* Arrays are allocated once while parsing, so every call would
+         * share one declared in the function */
+        if (node->array_dimensions.num_dimensions > 0)
+        {
+            check->problem = "'%s' must not declare arrays";
+            break;
+        }
+        for (int d = 0; d < node->data.array.num_dimensions; d++)
+            pure_walk(check, func, node->data.array.indices[d]);
+        return;
+    case NODE_FUNC_CALL:
+    {
+        Function *callee = get_function(node->data.func_call.function_name);
+        if (!callee)
+        {
+            check->problem = "'%s' must not call builtins";
+            break;
+        }
+        for (ArgumentList *arg = node->data.func_call.arguments; arg; arg = arg->next)
+            pure_walk(check, func, arg->expr);
+        pure_function(check, callee);
+        return;
+    }
+    case NODE_PRINT_STATEMENT:
+    case NODE_ERROR_STATEMENT:
+        check->problem = "'%s' must not print";
+        break;
+    default:
+        break;
+    }
+    if (check->problem)
+    {
+        check->where = func->name;
+        return;
+    }
+
+    switch (node->type)
+    {
+    case NODE_DECLARATION:
+    case NODE_ASSIGNMENT:
+    case NODE_OPERATION:
+    case NODE_RETURN:
+        pure_walk(check, func, node->data.op.left);
+        pure_walk(check, func, node->data.op.right);
+        break;
+    case NODE_UNARY_OPERATION:
+        pure_walk(check, func, node->data.unary.operand);
+        break;
+    case NODE_STRUCT_ACCESS:
+        pure_walk(check, func, node->data.struct_access.object);
+        break;
+    case NODE_IF_STATEMENT:
+        pure_walk(check, func, node->data.if_stmt.condition);
+        pure_walk(check, func, node->data.if_stmt.then_branch);
+        pure_walk(check, func, node->data.if_stmt.else_branch);
+        break;
+    case NODE_FOR_STATEMENT:
+        pure_walk(check, func, node->data.for_stmt.init);
+        pure_walk(check, func, node->data.for_stmt.cond);
+        pure_walk(check, func, node->data.for_stmt.incr);
+        pure_walk(check, func, node->data.for_stmt.body);
+        break;
+    case NODE_WHILE_STATEMENT:
+    case NODE_DO_WHILE_STATEMENT:
+        pure_walk(check, func, node->data.while_stmt.cond);
+        pure_walk(check, func, node->data.while_stmt.body);
+        break;
+    case NODE_SWITCH_STATEMENT:
+        pure_walk(check, func, node->data.switch_stmt.expression);
+        for (CaseNode *c = node->data.switch_stmt.cases; c; c = c->next)
+        {
+            pure_walk(check, func, c->value);
+            pure_walk(check, func, c->statements);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void pure_function(PureCheck *check, Function *func)
+{
+    for (int i = 0; i < check->count; i++)
+    {
+        if (check->seen[i] == func)
+            return;
+    }
+    if (check->count == PURE_MAX_FUNCTIONS)
+    {
+        check->problem = "'%s' calls too many functions";
+        check->where = func->name;
+        return;
+    }
+    check->seen[check->count++] = func;
+    pure_walk(check, func, func->body);
+}
+
+const StdrotFunction *stdrot_function(String name, int argc)
+{
+    Function *func = get_function(name);
+    if (!func)
+        callback_error("no function named '%s'", name);
+
+    Parameter *params[MAX_ARGUMENTS];
+    int param_count = function_parameters(func, params);
+    if (param_count != argc)
+    {
+        char message[64];
+        snprintf(message, sizeof(message), "'%%s' must take %d parameter%s", argc, argc == 1 ? "" : "s");
+        callback_error(message, name);
+    }
+    for (int i = 0; i < param_count; i++)
+    {
+        if (params[i]->pointer_level > 0 || !is_number_type(params[i]->type))
+            callback_error("'%s' must take numbers", name);
+    }
+    if (func->return_pointer_level > 0 || !is_number_type(func->return_type))
+        callback_error("'%s' must return a number", name);
+
+    PureCheck check = {0};
+    pure_function(&check, func);
+    if (check.problem)
+        callback_error(check.problem, check.where);
+    return (const StdrotFunction *)func;
+}
+
+/* value as an integer between lo and hi: rounded toward zero and clamped,
+ * NaN becomes 0 (a plain cast is undefined outside the type's range) */
+static int saturate(double value, int lo, int hi)
+{
+    if (value != value)
+        return 0;
+    if (value >= (double)hi)
+        return hi;
+    if (value <= (double)lo)
+        return lo;
+    return (int)value;
+}
+
+double stdrot_call(const StdrotFunction *function, const double *args, int argc)
+{
+    Function *func = (Function *)function;
+    Parameter *params[MAX_ARGUMENTS];
+    function_parameters(func, params);
+
+    Value values[MAX_ARGUMENTS];
+    for (int i = 0; i < argc; i++)
+    {
+        values[i].pointer_level = 0;
+        switch (params[i]->type)
+        {
+        case VAR_SHORT: values[i].svalue = (short)saturate(args[i], SHRT_MIN, SHRT_MAX); break;
+        case VAR_FLOAT: values[i].fvalue = (float)args[i]; break;
+        case VAR_DOUBLE: values[i].dvalue = args[i]; break;
+        case VAR_BOOL: values[i].bvalue = args[i] != 0; break;
+        default: values[i].ivalue = saturate(args[i], INT_MIN, INT_MAX); break;
+        }
+    }
+    call_function_values(func, values, argc);
+
+    const ReturnValue *ret = &current_runtime->return_value;
+    if (!ret->has_value)
+        return 0;
+    switch (ret->type)
+    {
+    case VAR_SHORT: return ret->value.svalue;
+    case VAR_FLOAT: return ret->value.fvalue;
+    case VAR_DOUBLE: return ret->value.dvalue;
+    case VAR_BOOL: return ret->value.bvalue;
+    default: return ret->value.ivalue;
+    }
+}
+
+/* Kept out of callback_task() so nothing it touches lives across the setjmp */
+__attribute__((noinline)) static void run_callback_chunk(CallbackRun *run, size_t chunk)
+{
+    run->chunk(run->data, chunk);
+}
+
+static void callback_task(void *data, size_t chunk, int worker)
+{
+    CallbackRun *run = data;
+    if (__atomic_load_n(&run->failed, __ATOMIC_RELAXED))
+        return;
+
+    Runtime *previous = current_runtime;
+    if (!run->workers[worker])
+    {
+        /* An empty scope: a callback only sees its own parameters */
+        run->workers[worker] = runtime_task(run->parent);
+        current_runtime = run->workers[worker];
+        run->interpreters[worker] = interpreter_new();
+        current_runtime->interpreter = run->interpreters[worker];
+    }
+    current_runtime = run->workers[worker];
+
+    jmp_buf exit_jump;
+    current_runtime->exit_jump = &exit_jump;
+    if (setjmp(exit_jump) == 0)
+    {
+        run_callback_chunk(run, chunk);
+    }
+    else
+    {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&run->failed, &expected, 1, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            run->status = current_runtime->exit_status;
+        while (current_runtime->scope && current_runtime->scope->parent)
+            exit_scope();
+        CLEAN_JUMP_BUFFER();
+    }
+    current_runtime->exit_jump = NULL;
+    current_runtime = previous;
+}
+
+void stdrot_parallel(size_t chunks, void (*chunk)(void *data, size_t chunk), void *data)
+{
+    CallbackRun run = {0};
+    run.chunk = chunk;
+    run.data = data;
+    run.parent = current_runtime;
+
+    pool_run(chunks, callback_task, &run);
+
+    for (int i = 0; i < POOL_MAX_THREADS; i++)
+    {
+        if (!run.workers[i])
+            continue;
+        run.workers[i]->interpreter = NULL;
+        interpreter_free(run.interpreters[i]);
+        runtime_task_free(run.workers[i]);
+    }
+    if (run.failed)
+        runtime_exit(run.status);
+}
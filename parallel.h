@@ -0,0 +1,53 @@
+/* parallel.h – squad flex: for loops whose iterations run on the thread pool
+ *
+ *     squad flex (rizz i = 1; i < n - 1; i++) combo(+: total, max: peak) {
+ *         next[i] = (cur[i - 1] + cur[i + 1]) / 2;
+ *         total = total + next[i];
+ *     }
+ *
+ * A squad loop counts a rizz from a start value towards a bound by a fixed
+ * step; the start and the bound are evaluated once. Its iterations are cut
+ * into chunks of consecutive iterations that run on the lib/pool.h threads.
+ * The semantic analyzer only accepts bodies whose iterations cannot see
+ * each other's writes (see check_squad_loop()).
+ *
+ * Each chunk starts the combo variables at the identity of their operator
+ * (0, 1, the largest or the smallest value of their type) and afterwards
+ * the chunks' results are folded into the variables in chunk order. The
+ * chunking does not depend on the thread count, so neither does the result.
+ *
+ * The same pool runs builtins that call a brainrot function for every
+ * element of an array (stdrot_parallel() and stdrot_call() in
+ * stdrot_api.h). Each pool thread calls it in a runtime of its own that
+ * starts with an empty scope, and stdrot_function() only accepts functions
+ * that cannot reach shared state: no printing, builtins, salty variables or
+ * arrays, in the function or anything it calls.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "ast.h"
+
+/* A squad loop's iterations never exceed this many chunks */
+#define SQUAD_CHUNKS 64
+
+typedef struct {
+    String var;        /* the loop counter */
+    bool declares_var; /* rizz i = start, rather than i = start */
+    ASTNode *start;
+    ASTNode *bound;    /* right side of the condition */
+    OperatorType cmp;  /* OP_LT, OP_LE, OP_GT or OP_GE */
+    int step;          /* added to the counter after each iteration */
+} SquadShape;
+
+/* Takes a squad loop apart; false if its header is not of the form
+ * (rizz i = start; i < bound; i++), with <=, >, >=, i--, ++i, --i or
+ * i = i + k / i = i - k (k an int literal) allowed too, provided the step
+ * moves the counter towards the bound */
+bool squad_loop_shape(const ASTNode *loop, SquadShape *shape);
+
+/* Runs a squad loop in the current runtime */
+void execute_squad_loop(ASTNode *loop);
+
+#endif /* PARALLEL_H */
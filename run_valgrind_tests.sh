@@ -4,18 +4,10 @@ for f in test_cases/*.brainrot; do
     echo "Running Valgrind on $f..."
     base=$(basename "$f" .brainrot)
 
-    case "$base" in
-        slorp_int)    input="42" ;;
-        slorp_short)  input="69" ;;
-        slorp_float)  input="3.14" ;;
-        slorp_double) input="3.141592" ;;
-        slorp_char)   input="c" ;;
-        slorp_string) input="skibidi bop bop yes yes" ;;
-        *)            input="" ;;
-    esac
+    input="test_cases/$base.input"
 
-    if [[ -n "$input" ]]; then
-        echo "$input" | valgrind --leak-check=full --error-exitcode=100 ./brainrot "$f"
+    if [[ -f "$input" ]]; then
+        valgrind --leak-check=full --error-exitcode=100 ./brainrot "$f" < "$input"
     else
         valgrind --track-origins=yes --leak-check=full --error-exitcode=100 ./brainrot "$f"
     fi
@@ -2,14 +2,13 @@
 
 #include "semantic_analyzer.h"
 #include "stdrot.h"
+#include "parallel.h"
 #include "lib/mem.h"
 #include <stdio.h>
 #include <string.h>
 
-extern int yylineno;
 extern void yyerror(const  char *s);
 extern String safe_strdup(const String *str);
-extern Scope *current_scope;
 
 /* Create a new semantic analyzer */
 SemanticAnalyzer* semantic_analyzer_new(void) {
@@ -48,6 +47,7 @@ SemanticAnalyzer* semantic_analyzer_new(void) {
     analyzer->base.visit_statement_list = NULL;
     analyzer->base.visit_print_statement = NULL;
     analyzer->base.visit_error_statement = NULL;
+    analyzer->base.evaluates_initializers = false;
     
     analyzer->current_scope = NULL;
     analyzer->symbol_table = NULL;
@@ -158,44 +158,44 @@ void print_semantic_errors(SemanticAnalyzer *analyzer) {
         switch (error->type) {
             case SEMANTIC_ERROR_UNDEFINED_VARIABLE:
                 if (error->line_number > 0) {
-                    fprintf(stderr, "Error: Undefined variable at line %d\n", error->line_number);
+                    fprintf(runtime_stderr(), "Error: Undefined variable at line %d\n", error->line_number);
                 } else {
-                    fprintf(stderr, "Error: Undefined variable\n");
+                    fprintf(runtime_stderr(), "Error: Undefined variable\n");
                 }
                 break;
             case SEMANTIC_ERROR_UNDEFINED_FUNCTION:
                 if (error->line_number > 0) {
-                    fprintf(stderr, "Error: Undefined function at line %d\n", error->line_number);
+                    fprintf(runtime_stderr(), "Error: Undefined function at line %d\n", error->line_number);
                 } else {
-                    fprintf(stderr, "Error: Undefined function\n");
+                    fprintf(runtime_stderr(), "Error: Undefined function\n");
                 }
                 break;
             case SEMANTIC_ERROR_CONST_ASSIGNMENT:
                 if (error->line_number > 0) {
-                    fprintf(stderr, "Error: Cannot modify const variable at line %d\n", error->line_number);
+                    fprintf(runtime_stderr(), "Error: Cannot modify const variable at line %d\n", error->line_number);
                 } else {
-                    fprintf(stderr, "Error: Cannot modify const variable\n");
+                    fprintf(runtime_stderr(), "Error: Cannot modify const variable\n");
                 }
                 break;
             case SEMANTIC_ERROR_REDEFINITION:
                 if (error->line_number > 0) {
-                    fprintf(stderr, "Error: Function redefinition at line %d\n", error->line_number);
+                    fprintf(runtime_stderr(), "Error: Function redefinition at line %d\n", error->line_number);
                 } else {
-                    fprintf(stderr, "Error: Function redefinition\n");
+                    fprintf(runtime_stderr(), "Error: Function redefinition\n");
                 }
                 break;
             case SEMANTIC_ERROR_SCOPE_ERROR:
                 if (error->line_number > 0) {
-                    fprintf(stderr, "Error: Variable out of scope at line %d\n", error->line_number);
+                    fprintf(runtime_stderr(), "Error: Variable out of scope at line %d\n", error->line_number);
                 } else {
-                    fprintf(stderr, "Error: Variable out of scope\n");
+                    fprintf(runtime_stderr(), "Error: Variable out of scope\n");
                 }
                 break;
             default:
                 if (error->line_number > 0) {
-                    fprintf(stderr, "Error: %s at line %d\n", error->message.data, error->line_number);
+                    fprintf(runtime_stderr(), "Error: %s at line %d\n", error->message.data, error->line_number);
                 } else {
-                    fprintf(stderr, "Error: %s\n", error->message.data);
+                    fprintf(runtime_stderr(), "Error: %s\n", error->message.data);
                 }
                 break;
         }
@@ -347,9 +347,13 @@ VarType infer_expression_type(ASTNode *node, SemanticAnalyzer *analyzer) {
             return infer_expression_type(node->data.unary.operand, analyzer);
         
         case NODE_FUNC_CALL: {
-            /* Check if it's a built-in function */
-            if (is_builtin_function(node->data.func_call.function_name)) {
-                return NONE; /* Most built-in functions return void */
+            /* Built-in functions declare what they yield in their export flags */
+            if (stdrot_bind_call(node)) {
+                ArgumentList *args = node->data.func_call.arguments;
+                if ((node->data.func_call.builtin_flags & STDROT_RETURNS_ELEM) && args && args->expr) {
+                    return infer_expression_type(args->expr, analyzer);
+                }
+                return stdrot_call_type(node);
             }
             
             /* Look up user-defined function */
@@ -533,7 +537,23 @@ void* semantic_visit_function_call(Visitor *self, ASTNode *node) {
     
     const String func_name = node->data.func_call.function_name;
     
-    if (!is_builtin_function(func_name)) {
+    /* Bind builtins here so the interpreter never looks the name up again */
+    if (stdrot_bind_call(node)) {
+        /* Literal formats are compiled once; check they get enough arguments */
+        const StdrotFormat *format = stdrot_bind_format(node);
+        if (format) {
+            int given = -1;
+            for (ArgumentList *arg = node->data.func_call.arguments; arg; arg = arg->next) given++;
+            if (given != format->arg_count) {
+                char error_msg[MAX_BUFFER_LEN];
+                snprintf(error_msg, sizeof(error_msg),
+                         "Format string for '%s' expects %d argument(s) but got %d",
+                         func_name.data, format->arg_count, given);
+                add_semantic_error(analyzer, SEMANTIC_ERROR_INVALID_OPERATION,
+                                  STRING_LITERAL(error_msg), node->line_number > 0 ? node->line_number : 1);
+            }
+        }
+    } else {
         Function *func = get_function(func_name);
         if (!func) {
             char error_msg[MAX_BUFFER_LEN];
@@ -723,9 +743,9 @@ void free_symbol_table(SymbolEntry *symbols) {
 void collect_declarations(SemanticAnalyzer *analyzer, ASTNode *node) {
     if (!node || !analyzer) return;
     
-    static int depth = 0;
+    static _Thread_local int depth = 0;
     if (depth > 1000) {
-        fprintf(stderr, "Warning: Maximum recursion depth reached in collect_declarations\n");
+        fprintf(runtime_stderr(), "Warning: Maximum recursion depth reached in collect_declarations\n");
         return;
     }
     depth++;
@@ -839,14 +859,566 @@ void collect_declarations(SemanticAnalyzer *analyzer, ASTNode *node) {
     depth--;
 }
 
+/* squad flex: a body may only write what no other iteration touches.
+ * That is variables it declares itself, the combo(...) variables (every
+ * chunk of iterations gets its own copy, updated only through its combo
+ * operator) and elements of arrays indexed by
+ * the counter in one dimension, provided every access to those arrays uses
+ * the counter in that dimension. It may not call functions or print,
+ * since the iterations run in no particular order, except for builtins
+ * exported with STDROT_THREAD_SAFE, such as the atomics. What the body
+ * passes to an atomic (a STDROT_TAKES_REF builtin) other iterations may be
+ * changing, so it may not touch that any other way. */
+
+#define SQUAD_MAX_NAMES 64
+
+/* A combo variable's value is only known once the chunks are combined, so
+ * the body may only update it: `v = v + e`, `v = v - e`, `v++` or `v--`
+ * for +, `v = v * e` for *, and `edgy (e < v) { v = e; }` for min or
+ * `edgy (e > v) { v = e; }` for max, with e not reading v */
+#define SQUAD_SHARED_MISUSE "squad flex body passes '%s' to atomics, so it may only use it through them"
+#define SQUAD_COMBO_MISUSE "squad flex body may only update combo variable '%s' with its combo operator"
+
+typedef struct {
+    String name;
+    int dimension; /* the index that is the counter */
+} SquadArray;
+
+typedef struct {
+    SemanticAnalyzer *analyzer;
+    const ASTNode *loop;
+    SquadShape shape;
+    String privates[SQUAD_MAX_NAMES]; /* declared so far, innermost last */
+    int private_count;
+    SquadArray arrays[SQUAD_MAX_NAMES]; /* arrays the body writes */
+    int array_count;
+    String shared[SQUAD_MAX_NAMES]; /* variables and arrays passed to atomics */
+    int shared_count;
+    int breakable; /* loops and switches inside the body around the node */
+    int line;      /* of the last node walked that knows its line */
+} SquadCheck;
+
+static void squad_error(SquadCheck *check, const ASTNode *node, const char *message, String name) {
+    char error_msg[MAX_BUFFER_LEN];
+    snprintf(error_msg, sizeof(error_msg), message, name.data ? name.data : "");
+    int line = node && node->line_number > 0 ? node->line_number : check->line;
+    add_semantic_error(check->analyzer, SEMANTIC_ERROR_INVALID_OPERATION, STRING_LITERAL(error_msg), line);
+}
+
+static bool squad_same_name(String a, String b) {
+    return a.data && b.data && strcmp(a.data, b.data) == 0;
+}
+
+static bool squad_is_counter(SquadCheck *check, const ASTNode *node) {
+    return node && node->type == NODE_IDENTIFIER && squad_same_name(node->data.name, check->shape.var);
+}
+
+static bool squad_is_private(SquadCheck *check, String name) {
+    for (int i = 0; i < check->private_count; i++) {
+        if (squad_same_name(check->privates[i], name)) return true;
+    }
+    return false;
+}
+
+static bool squad_is_reduction(SquadCheck *check, String name) {
+    for (Reduction *r = check->loop->data.for_stmt.reductions; r; r = r->next) {
+        if (squad_same_name(r->name, name)) return true;
+    }
+    return false;
+}
+
+/* Whether name is a variable or array the body passes to atomics */
+static bool squad_is_shared(SquadCheck *check, String name) {
+    if (squad_is_private(check, name)) return false;
+    for (int i = 0; i < check->shared_count; i++) {
+        if (squad_same_name(check->shared[i], name)) return true;
+    }
+    return false;
+}
+
+/* The combo(...) entry that node names, unless the body declared its own
+ * variable of that name */
+static Reduction *squad_reduction(SquadCheck *check, const ASTNode *node) {
+    if (!node || node->type != NODE_IDENTIFIER || squad_is_private(check, node->data.name)) return NULL;
+    for (Reduction *r = check->loop->data.for_stmt.reductions; r; r = r->next) {
+        if (squad_same_name(r->name, node->data.name)) return r;
+    }
+    return NULL;
+}
+
+static bool squad_same_expr(const ASTNode *a, const ASTNode *b) {
+    if (!a || !b || a->type != b->type) return false;
+    switch (a->type) {
+        case NODE_IDENTIFIER:
+            return squad_same_name(a->data.name, b->data.name);
+        case NODE_INT:
+            return a->data.ivalue == b->data.ivalue;
+        case NODE_FLOAT:
+            return a->data.fvalue == b->data.fvalue;
+        case NODE_DOUBLE:
+            return a->data.dvalue == b->data.dvalue;
+        case NODE_ARRAY_ACCESS:
+            if (!squad_same_name(a->data.array.name, b->data.array.name) ||
+                a->data.array.num_dimensions != b->data.array.num_dimensions) return false;
+            for (int d = 0; d < a->data.array.num_dimensions; d++) {
+                if (!squad_same_expr(a->data.array.indices[d], b->data.array.indices[d])) return false;
+            }
+            return true;
+        case NODE_OPERATION:
+            return a->data.op.op == b->data.op.op && squad_same_expr(a->data.op.left, b->data.op.left) &&
+                   squad_same_expr(a->data.op.right, b->data.op.right);
+        case NODE_UNARY_OPERATION:
+            return a->data.unary.op == b->data.unary.op &&
+                   squad_same_expr(a->data.unary.operand, b->data.unary.operand);
+        default:
+            return false;
+    }
+}
+
+/* The expression a combo variable is updated with in assignment, if the
+ * assignment is `v = v + e` or `v = v - e` for +, or `v = v * e` for * */
+static const ASTNode *squad_combo_operand(SquadCheck *check, const ASTNode *assignment, Reduction *r) {
+    const ASTNode *value = assignment->data.op.right;
+    if (!value || value->type != NODE_OPERATION || squad_reduction(check, value->data.op.left) != r) return NULL;
+    OperatorType op = value->data.op.op;
+    if ((r->op == REDUCE_SUM && (op == OP_PLUS || op == OP_MINUS)) || (r->op == REDUCE_PRODUCT && op == OP_TIMES)) {
+        return value->data.op.right;
+    }
+    return NULL;
+}
+
+/* The expression e of `edgy (e < v) { v = e; }` for a min combo variable v,
+ * or of `edgy (e > v) { v = e; }` for a max one (either way round, < or <=) */
+static const ASTNode *squad_combo_guard(SquadCheck *check, const ASTNode *if_stmt) {
+    const ASTNode *cond = if_stmt->data.if_stmt.condition;
+    const ASTNode *then = if_stmt->data.if_stmt.then_branch;
+    if (!cond || cond->type != NODE_OPERATION || if_stmt->data.if_stmt.else_branch || !then) return NULL;
+    if (then->type == NODE_STATEMENT_LIST) {
+        if (!then->data.statements || then->data.statements->next) return NULL;
+        then = then->data.statements->statement;
+    }
+    if (!then || then->type != NODE_ASSIGNMENT) return NULL;
+
+    Reduction *r = squad_reduction(check, then->data.op.left);
+    if (!r || (r->op != REDUCE_MIN && r->op != REDUCE_MAX)) return NULL;
+    bool less; /* e < v */
+    const ASTNode *value;
+    switch (cond->data.op.op) {
+        case OP_LT: case OP_LE: less = true; break;
+        case OP_GT: case OP_GE: less = false; break;
+        default: return NULL;
+    }
+    if (squad_reduction(check, cond->data.op.right) == r) {
+        value = cond->data.op.left;
+    } else if (squad_reduction(check, cond->data.op.left) == r) {
+        value = cond->data.op.right;
+        less = !less;
+    } else {
+        return NULL;
+    }
+    if (less != (r->op == REDUCE_MIN) || !squad_same_expr(value, then->data.op.right)) return NULL;
+    return value;
+}
+
+static SquadArray *squad_written_array(SquadCheck *check, String name) {
+    for (int i = 0; i < check->array_count; i++) {
+        if (squad_same_name(check->arrays[i].name, name)) return &check->arrays[i];
+    }
+    return NULL;
+}
+
+static int squad_counter_dimension(SquadCheck *check, const ASTNode *access) {
+    for (int d = 0; d < access->data.array.num_dimensions; d++) {
+        if (squad_is_counter(check, access->data.array.indices[d])) return d;
+    }
+    return -1;
+}
+
+static void squad_check_write(SquadCheck *check, const ASTNode *target) {
+    switch (target->type) {
+        case NODE_IDENTIFIER: {
+            String name = target->data.name;
+            if (squad_is_shared(check, name)) {
+                squad_error(check, target, SQUAD_SHARED_MISUSE, name);
+            } else if (squad_same_name(name, check->shape.var)) {
+                squad_error(check, target, "squad flex body must not change the counter '%s'", name);
+            } else if (!squad_is_private(check, name) && !squad_is_reduction(check, name)) {
+                squad_error(check, target, "squad flex body writes '%s', which every iteration shares; "
+                            "declare it in the body or add it to combo(...)", name);
+            }
+            break;
+        }
+        case NODE_ARRAY_ACCESS: {
+            String name = target->data.array.name;
+            int dimension = squad_counter_dimension(check, target);
+            if (squad_is_shared(check, name)) {
+                squad_error(check, target, SQUAD_SHARED_MISUSE, name);
+            } else if (!target->is_array) {
+                squad_error(check, target, "squad flex body must not write through pointer '%s'", name);
+            } else if (target->var_type == VAR_BOOL) {
+                squad_error(check, target, "squad flex body must not write cap array '%s', "
+                            "its elements share memory words", name);
+            } else if (dimension < 0) {
+                squad_error(check, target, "squad flex body writes '%s' at an index other than the counter", name);
+            } else if (!squad_written_array(check, name)) {
+                if (check->array_count == SQUAD_MAX_NAMES) {
+                    squad_error(check, target, "squad flex body writes too many arrays", name);
+                } else {
+                    check->arrays[check->array_count++] = (SquadArray){ name, dimension };
+                }
+            }
+            break;
+        }
+        case NODE_STRUCT_ACCESS:
+            squad_error(check, target, "squad flex body must not write gang member '%s'",
+                        target->data.struct_access.member_name);
+            break;
+        default:
+            squad_error(check, target, "squad flex body must not write through pointers", (String){0});
+            break;
+    }
+}
+
+static void squad_walk(SquadCheck *check, const ASTNode *node);
+
+static void squad_walk_indices(SquadCheck *check, const ASTNode *access) {
+    for (int d = 0; d < access->data.array.num_dimensions; d++) {
+        squad_walk(check, access->data.array.indices[d]);
+    }
+}
+
+/* A write's target: only array indices are evaluated as well */
+static void squad_walk_target(SquadCheck *check, const ASTNode *target) {
+    squad_check_write(check, target);
+    if (target->type == NODE_ARRAY_ACCESS) {
+        squad_walk_indices(check, target);
+    }
+}
+
+static void squad_walk(SquadCheck *check, const ASTNode *node) {
+    if (!node) return;
+    if (node->line_number > 0) check->line = node->line_number;
+
+    switch (node->type) {
+        case NODE_STATEMENT_LIST: {
+            int privates = check->private_count;
+            for (StatementList *s = node->data.statements; s; s = s->next) {
+                squad_walk(check, s->statement);
+            }
+            check->private_count = privates;
+            break;
+        }
+        case NODE_DECLARATION: {
+            String name = node->data.op.left->data.name;
+            if (node->var_type == VAR_STRUCT || node->modifiers.is_static) {
+                squad_error(check, node, "squad flex body must not declare salty or gang variable '%s'", name);
+                break;
+            }
+            squad_walk(check, node->data.op.right);
+            if (check->private_count == SQUAD_MAX_NAMES) {
+                squad_error(check, node, "squad flex body declares too many variables", name);
+            } else {
+                check->privates[check->private_count++] = name;
+            }
+            break;
+        }
+        case NODE_ARRAY_ACCESS:
+            /* Arrays are allocated once while parsing, so all iterations
+             * would share one declared in the body */
+            if (node->array_dimensions.num_dimensions > 0) {
+                squad_error(check, node, "squad flex body must not declare array '%s'", node->data.name);
+            } else {
+                if (squad_is_shared(check, node->data.array.name)) {
+                    squad_error(check, node, SQUAD_SHARED_MISUSE, node->data.array.name);
+                }
+                squad_walk_indices(check, node);
+            }
+            break;
+        case NODE_IDENTIFIER:
+            if (squad_reduction(check, node)) {
+                squad_error(check, node, SQUAD_COMBO_MISUSE, node->data.name);
+            } else if (squad_is_shared(check, node->data.name)) {
+                squad_error(check, node, SQUAD_SHARED_MISUSE, node->data.name);
+            }
+            break;
+        case NODE_ASSIGNMENT: {
+            Reduction *r = squad_reduction(check, node->data.op.left);
+            if (r) {
+                const ASTNode *operand = squad_combo_operand(check, node, r);
+                if (operand) {
+                    squad_walk(check, operand);
+                } else {
+                    squad_error(check, node, SQUAD_COMBO_MISUSE, r->name);
+                }
+                break;
+            }
+            squad_walk_target(check, node->data.op.left);
+            squad_walk(check, node->data.op.right);
+            break;
+        }
+        case NODE_UNARY_OPERATION:
+            switch (node->data.unary.op) {
+                case OP_PRE_INC:
+                case OP_PRE_DEC:
+                case OP_POST_INC:
+                case OP_POST_DEC: {
+                    Reduction *r = squad_reduction(check, node->data.unary.operand);
+                    if (r && r->op != REDUCE_SUM) {
+                        squad_error(check, node, SQUAD_COMBO_MISUSE, r->name);
+                    } else if (!r) {
+                        squad_walk_target(check, node->data.unary.operand);
+                    }
+                    break;
+                }
+                default:
+                    squad_walk(check, node->data.unary.operand);
+                    break;
+            }
+            break;
+        case NODE_OPERATION:
+            squad_walk(check, node->data.op.left);
+            squad_walk(check, node->data.op.right);
+            break;
+        case NODE_STRUCT_ACCESS:
+            squad_walk(check, node->data.struct_access.object);
+            break;
+        case NODE_FUNC_CALL: {
+            unsigned flags = stdrot_call_flags((ASTNode *)node);
+            ArgumentList *args = node->data.func_call.arguments;
+            if (!(flags & STDROT_THREAD_SAFE)) {
+                squad_error(check, node, "squad flex body must not call '%s'", node->data.func_call.function_name);
+                break;
+            }
+            if ((flags & STDROT_TAKES_REF) && args) {
+                /* The reference itself is the atomic access */
+                const ASTNode *ref = args->expr;
+                if (squad_is_counter(check, ref)) {
+                    squad_error(check, node, "squad flex body must not change the counter '%s'", check->shape.var);
+                } else if (ref && ref->type == NODE_ARRAY_ACCESS) {
+                    squad_walk_indices(check, ref);
+                } else if (!ref || ref->type != NODE_IDENTIFIER) {
+                    squad_walk(check, ref);
+                }
+                args = args->next;
+            }
+            for (; args; args = args->next) {
+                squad_walk(check, args->expr);
+            }
+            break;
+        }
+        case NODE_PRINT_STATEMENT:
+        case NODE_ERROR_STATEMENT:
+            squad_error(check, node, "squad flex body must not print", (String){0});
+            break;
+        case NODE_RETURN:
+            squad_error(check, node, "squad flex body must not bussin", (String){0});
+            break;
+        case NODE_BREAK_STATEMENT:
+            if (check->breakable == 0) {
+                squad_error(check, node, "squad flex body must not bruh out of the loop", (String){0});
+            }
+            break;
+        case NODE_IF_STATEMENT: {
+            const ASTNode *value = squad_combo_guard(check, node);
+            if (value) {
+                squad_walk(check, value);
+                break;
+            }
+            squad_walk(check, node->data.if_stmt.condition);
+            squad_walk(check, node->data.if_stmt.then_branch);
+            squad_walk(check, node->data.if_stmt.else_branch);
+            break;
+        }
+        case NODE_FOR_STATEMENT: {
+            int privates = check->private_count;
+            check->breakable++;
+            squad_walk(check, node->data.for_stmt.init);
+            squad_walk(check, node->data.for_stmt.cond);
+            squad_walk(check, node->data.for_stmt.incr);
+            squad_walk(check, node->data.for_stmt.body);
+            check->breakable--;
+            check->private_count = privates;
+            break;
+        }
+        case NODE_WHILE_STATEMENT:
+        case NODE_DO_WHILE_STATEMENT:
+            check->breakable++;
+            squad_walk(check, node->data.while_stmt.cond);
+            squad_walk(check, node->data.while_stmt.body);
+            check->breakable--;
+            break;
+        case NODE_SWITCH_STATEMENT:
+            squad_walk(check, node->data.switch_stmt.expression);
+            check->breakable++;
+            for (CaseNode *c = node->data.switch_stmt.cases; c; c = c->next) {
+                squad_walk(check, c->value);
+                squad_walk(check, c->statements);
+            }
+            check->breakable--;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Calls visit on node and everything below it */
+static void squad_each_node(SquadCheck *check, const ASTNode *node,
+                            void (*visit)(SquadCheck *, const ASTNode *)) {
+    if (!node) return;
+    visit(check, node);
+    switch (node->type) {
+        case NODE_STATEMENT_LIST:
+            for (StatementList *s = node->data.statements; s; s = s->next) {
+                squad_each_node(check, s->statement, visit);
+            }
+            break;
+        case NODE_DECLARATION:
+        case NODE_ASSIGNMENT:
+        case NODE_OPERATION:
+            squad_each_node(check, node->data.op.left, visit);
+            squad_each_node(check, node->data.op.right, visit);
+            break;
+        case NODE_ARRAY_ACCESS:
+            if (node->array_dimensions.num_dimensions == 0) {
+                for (int d = 0; d < node->data.array.num_dimensions; d++) {
+                    squad_each_node(check, node->data.array.indices[d], visit);
+                }
+            }
+            break;
+        case NODE_UNARY_OPERATION:
+            squad_each_node(check, node->data.unary.operand, visit);
+            break;
+        case NODE_STRUCT_ACCESS:
+            squad_each_node(check, node->data.struct_access.object, visit);
+            break;
+        case NODE_FUNC_CALL:
+            for (ArgumentList *arg = node->data.func_call.arguments; arg; arg = arg->next) {
+                squad_each_node(check, arg->expr, visit);
+            }
+            break;
+        case NODE_IF_STATEMENT:
+            squad_each_node(check, node->data.if_stmt.condition, visit);
+            squad_each_node(check, node->data.if_stmt.then_branch, visit);
+            squad_each_node(check, node->data.if_stmt.else_branch, visit);
+            break;
+        case NODE_FOR_STATEMENT:
+            squad_each_node(check, node->data.for_stmt.init, visit);
+            squad_each_node(check, node->data.for_stmt.cond, visit);
+            squad_each_node(check, node->data.for_stmt.incr, visit);
+            squad_each_node(check, node->data.for_stmt.body, visit);
+            break;
+        case NODE_WHILE_STATEMENT:
+        case NODE_DO_WHILE_STATEMENT:
+            squad_each_node(check, node->data.while_stmt.cond, visit);
+            squad_each_node(check, node->data.while_stmt.body, visit);
+            break;
+        case NODE_SWITCH_STATEMENT:
+            squad_each_node(check, node->data.switch_stmt.expression, visit);
+            for (CaseNode *c = node->data.switch_stmt.cases; c; c = c->next) {
+                squad_each_node(check, c->value, visit);
+                squad_each_node(check, c->statements, visit);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Notes what the body passes to atomics, before squad_walk() checks its
+ * other uses */
+static void squad_note_shared(SquadCheck *check, const ASTNode *node) {
+    if (node->type != NODE_FUNC_CALL || !(stdrot_call_flags((ASTNode *)node) & STDROT_TAKES_REF)) return;
+    ArgumentList *args = node->data.func_call.arguments;
+    const ASTNode *ref = args ? args->expr : NULL;
+    String name = {0};
+    if (ref && ref->type == NODE_IDENTIFIER) {
+        name = ref->data.name;
+    } else if (ref && ref->type == NODE_ARRAY_ACCESS) {
+        name = ref->data.array.name;
+    }
+    if (!name.data || squad_same_name(name, check->shape.var)) return;
+    for (int i = 0; i < check->shared_count; i++) {
+        if (squad_same_name(check->shared[i], name)) return;
+    }
+    if (check->shared_count == SQUAD_MAX_NAMES) {
+        squad_error(check, node, "squad flex body passes too many variables to atomics", name);
+    } else {
+        check->shared[check->shared_count++] = name;
+    }
+}
+
+/* Another iteration may be writing any element of a written array that is
+ * not at the counter in the written dimension */
+static void squad_check_access(SquadCheck *check, const ASTNode *node) {
+    if (node->line_number > 0) check->line = node->line_number;
+    if (node->type != NODE_ARRAY_ACCESS || node->array_dimensions.num_dimensions > 0) return;
+    SquadArray *array = squad_written_array(check, node->data.array.name);
+    if (array && (array->dimension >= node->data.array.num_dimensions ||
+                  !squad_is_counter(check, node->data.array.indices[array->dimension]))) {
+        squad_error(check, node, "squad flex body writes '%s', so it must always index it "
+                    "with the counter in the same place", node->data.array.name);
+    }
+}
+
+/* The bound is evaluated once, so it must not read what the body writes */
+static void squad_check_bound(SquadCheck *check, const ASTNode *node) {
+    String name = {0};
+    if (node->type == NODE_IDENTIFIER && squad_is_reduction(check, node->data.name)) {
+        name = node->data.name;
+    } else if (node->type == NODE_ARRAY_ACCESS && squad_written_array(check, node->data.array.name)) {
+        name = node->data.array.name;
+    }
+    if (name.data) {
+        squad_error(check, node, "squad flex bound must not depend on '%s', which the body changes", name);
+    }
+}
+
+static void check_squad_loop(SemanticAnalyzer *analyzer, const ASTNode *loop) {
+    SquadCheck check = { .analyzer = analyzer, .loop = loop, .line = loop->line_number };
+    if (!squad_loop_shape(loop, &check.shape)) {
+        squad_error(&check, loop, "squad flex needs a header like (rizz i = start; i < end; i++)", (String){0});
+        return;
+    }
+
+    if (!check.shape.declares_var) {
+        SymbolEntry *counter = find_symbol(analyzer, check.shape.var);
+        if (counter && (counter->type != VAR_INT || counter->pointer_level != 0)) {
+            squad_error(&check, loop, "squad flex counter '%s' must be a rizz", check.shape.var);
+        }
+    }
+
+    for (Reduction *r = loop->data.for_stmt.reductions; r; r = r->next) {
+        SymbolEntry *entry = find_symbol(analyzer, r->name);
+        if (squad_same_name(r->name, check.shape.var)) {
+            squad_error(&check, loop, "squad flex counter '%s' cannot be a combo variable", r->name);
+        } else if (!entry) {
+            squad_error(&check, loop, "combo variable '%s' is not declared", r->name);
+        } else if (entry->pointer_level != 0 ||
+                   (entry->type != VAR_INT && entry->type != VAR_SHORT &&
+                    entry->type != VAR_FLOAT && entry->type != VAR_DOUBLE)) {
+            squad_error(&check, loop, "combo variable '%s' must be a rizz, smol, chad or gigachad", r->name);
+        }
+        for (Reduction *other = r->next; other; other = other->next) {
+            if (squad_same_name(r->name, other->name)) {
+                squad_error(&check, loop, "combo variable '%s' is listed twice", r->name);
+            }
+        }
+    }
+
+    squad_each_node(&check, loop->data.for_stmt.body, squad_note_shared);
+    squad_walk(&check, loop->data.for_stmt.body);
+    squad_each_node(&check, loop->data.for_stmt.body, squad_check_access);
+    squad_each_node(&check, check.shape.bound, squad_check_bound);
+}
+
 /* Scope-aware semantic analysis that tracks scope depth during traversal */
 void semantic_analyze_with_scope_tracking(SemanticAnalyzer *analyzer, ASTNode *node) {
     if (!node || !analyzer) return;
     
     /* Prevent infinite recursion */
-    static int recursion_depth = 0;
+    static _Thread_local int recursion_depth = 0;
     if (recursion_depth > 100) {
-        fprintf(stderr, "Warning: Maximum recursion depth reached in scope tracking\n");
+        fprintf(runtime_stderr(), "Warning: Maximum recursion depth reached in scope tracking\n");
         return;
     }
     recursion_depth++;
@@ -900,6 +1472,10 @@ void semantic_analyze_with_scope_tracking(SemanticAnalyzer *analyzer, ASTNode *n
             
             /* Exit loop scope */
             analyzer->scope_depth--;
+
+            if (node->data.for_stmt.squad) {
+                check_squad_loop(analyzer, node);
+            }
             break;
         }
         
@@ -0,0 +1,609 @@
+/* server.c - Warm interpreter daemon and fork server, see server.h */
+
+#define _GNU_SOURCE /* accept4, POLLRDHUP */
+
+#include "server.h"
+#include "brainrot.h"
+#include "ast.h"
+#include "lib/hm.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/pidfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Programs kept compiled; once the cache is full, requests for new scripts
+ * compile their own and free it afterwards */
+#define SERVE_CACHE_MAX 256
+/* Largest frame either side accepts */
+#define SERVE_FRAME_MAX ((uint32_t)64 << 20)
+/* Input is forwarded in frames of up to this many bytes */
+#define SERVE_CHUNK ((size_t)64 << 10)
+
+typedef struct {
+    int fd;
+    pthread_mutex_t write_lock; /* a program's tasks may reply at once */
+    uint32_t input_left;        /* unread bytes of the current input frame */
+    bool input_done;
+} Connection;
+
+static HashMap *cache; /* source text -> BrProgram * */
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static const char *listening_path;
+
+/* ── Frames ──────────────────────────────────────────────────────────────── */
+
+/* Reads or writes exactly len bytes; false on an error or the end of the
+ * connection */
+static bool read_all(int fd, void *data, size_t len)
+{
+    char *p = data;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool write_all(int fd, const void *data, size_t len)
+{
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool send_frame(int fd, char type, const void *data, uint32_t len)
+{
+    unsigned char header[5] = { (unsigned char)type };
+    memcpy(header + 1, &len, sizeof(len));
+    struct iovec parts[2] = { { header, sizeof(header) }, { (void *)data, len } };
+
+    ssize_t sent;
+    do {
+        sent = writev(fd, parts, len > 0 ? 2 : 1);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) return false;
+
+    /* Finish a short write */
+    size_t done = (size_t)sent;
+    if (done < sizeof(header)) {
+        if (!write_all(fd, header + done, sizeof(header) - done)) return false;
+        done = sizeof(header);
+    }
+    done -= sizeof(header);
+    return write_all(fd, (const char *)data + done, len - done);
+}
+
+/* false at the end of the connection or on a frame too large to accept */
+static bool receive_header(int fd, char *type, uint32_t *len)
+{
+    unsigned char header[5];
+    if (!read_all(fd, header, sizeof(header))) return false;
+    *type = (char)header[0];
+    memcpy(len, header + 1, sizeof(*len));
+    return *len <= SERVE_FRAME_MAX;
+}
+
+/* ── Server ──────────────────────────────────────────────────────────────── */
+
+static size_t reply(Connection *conn, char type, const char *data, size_t len)
+{
+    size_t sent = 0;
+    pthread_mutex_lock(&conn->write_lock);
+    while (sent < len || len == 0) {
+        uint32_t part = len - sent < SERVE_FRAME_MAX ? (uint32_t)(len - sent) : SERVE_FRAME_MAX;
+        if (!send_frame(conn->fd, type, data + sent, part)) break;
+        sent += part;
+        if (len == 0) break;
+    }
+    pthread_mutex_unlock(&conn->write_lock);
+    return sent;
+}
+
+static __attribute__((format(printf, 2, 3))) void report(Connection *conn, const char *format, ...)
+{
+    char message[512];
+    va_list ap;
+    va_start(ap, format);
+    int len = vsnprintf(message, sizeof(message), format, ap);
+    va_end(ap);
+    if (len > 0) {
+        reply(conn, SERVE_ERRORS, message, (size_t)len < sizeof(message) ? (size_t)len : sizeof(message) - 1);
+    }
+}
+
+static size_t write_output(void *user, const char *data, size_t len)
+{
+    return reply(user, SERVE_OUTPUT, data, len);
+}
+
+static size_t write_errors(void *user, const char *data, size_t len)
+{
+    return reply(user, SERVE_ERRORS, data, len);
+}
+
+/* Input frames are only read as the program asks for input */
+static size_t read_input(void *user, char *buf, size_t len)
+{
+    Connection *conn = user;
+    while (conn->input_left == 0) {
+        char type;
+        if (conn->input_done || !receive_header(conn->fd, &type, &conn->input_left) ||
+            type != SERVE_INPUT || conn->input_left == 0) {
+            conn->input_done = true;
+            conn->input_left = 0;
+            return 0;
+        }
+    }
+
+    size_t want = len < conn->input_left ? len : conn->input_left;
+    ssize_t got;
+    do {
+        got = read(conn->fd, buf, want);
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0) {
+        conn->input_done = true;
+        conn->input_left = 0;
+        return 0;
+    }
+    conn->input_left -= (uint32_t)got;
+    return (size_t)got;
+}
+
+/* Reads the script at path; NULL, after telling the client, if it cannot */
+static char *read_script(Connection *conn, const char *path, size_t *len)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        report(conn, "Cannot open source file: %s\n", strerror(errno));
+        if (fd >= 0) close(fd);
+        return NULL;
+    }
+
+    char *source = malloc((size_t)st.st_size + 1);
+    if (!source || !read_all(fd, source, (size_t)st.st_size)) {
+        report(conn, "Cannot read source file: %s\n", source ? strerror(errno) : "out of memory");
+        free(source);
+        source = NULL;
+    }
+    close(fd);
+    *len = (size_t)st.st_size;
+    return source;
+}
+
+/* Reads a request into *source, which stays NULL, after telling the client,
+ * if the script cannot be read. false if the request is malformed. */
+static bool read_request(Connection *conn, bool *isolate, char **source, size_t *len)
+{
+    char type;
+    uint32_t size;
+    for (;;) {
+        if (!receive_header(conn->fd, &type, &size)) return false;
+        if (type == SERVE_ISOLATE && size == 0) {
+            *isolate = true;
+        } else if (type == SERVE_PATH || type == SERVE_SOURCE) {
+            break;
+        } else {
+            return false;
+        }
+    }
+
+    char *data = malloc((size_t)size + 1);
+    if (!data || !read_all(conn->fd, data, size)) {
+        free(data);
+        return false;
+    }
+    data[size] = '\0';
+    if (type == SERVE_SOURCE) {
+        *source = data;
+        *len = size;
+        return true;
+    }
+    *source = read_script(conn, data, len);
+    free(data);
+    return true;
+}
+
+/* The compiled program for source, taken from the cache or compiled now,
+ * with errors going to io. *cached is false if the caller has to free it. */
+static BrProgram *find_program(const char *source, size_t len, const BrIO *io, bool *cached)
+{
+    pthread_mutex_lock(&cache_lock);
+    if (!cache) cache = hm_new();
+    BrProgram **hit = cache ? hm_get(cache, source, len) : NULL;
+    BrProgram *program = hit ? *hit : NULL;
+    pthread_mutex_unlock(&cache_lock);
+    *cached = true;
+    if (program) return program;
+
+    program = br_compile_io(source, len, io);
+    if (!program) return NULL;
+
+    pthread_mutex_lock(&cache_lock);
+    hit = cache ? hm_get(cache, source, len) : NULL;
+    if (hit) {
+        /* Another request compiled it meanwhile */
+        br_free(program);
+        program = *hit;
+    } else if (cache && cache->size < SERVE_CACHE_MAX) {
+        hm_put(cache, source, len, &program, sizeof(program));
+    } else {
+        *cached = false;
+    }
+    pthread_mutex_unlock(&cache_lock);
+    return program;
+}
+
+/* Waits for child to exit, killing it if the client goes away first.
+ * Without a pidfd (kernels before 5.3) it looks at the child every
+ * SERVE_REAP_MS instead of being woken when it exits. */
+#define SERVE_REAP_MS 100
+
+static bool wait_child(pid_t child, int client, int *status)
+{
+    int exited = pidfd_open(child, 0);
+    struct pollfd fds[2] = { { .fd = client, .events = POLLRDHUP }, { .fd = exited, .events = POLLIN } };
+    pid_t done;
+    while ((done = waitpid(child, status, WNOHANG)) == 0) {
+        if (poll(fds, exited >= 0 ? 2 : 1, exited >= 0 ? -1 : SERVE_REAP_MS) < 0 && errno != EINTR)
+            break;
+        if (fds[0].revents & (POLLRDHUP | POLLHUP | POLLERR)) {
+            kill(child, SIGKILL);
+            break;
+        }
+    }
+    if (exited >= 0) close(exited);
+    while (done != child && waitpid(child, status, 0) < 0) {
+        if (errno != EINTR) return false;
+    }
+    return true;
+}
+
+/* Runs program in a child process, so that a crash only ends the child */
+static int run_isolated(BrProgram *program, const BrIO *io)
+{
+    pid_t child = fork();
+    if (child < 0) {
+        report(io->user, "Error: cannot fork: %s\n", strerror(errno));
+        return 1;
+    }
+    if (child == 0) {
+        _exit(br_run(program, io));
+    }
+
+    int status;
+    if (!wait_child(child, ((Connection *)io->user)->fd, &status))
+        return 1;
+    if (WIFSIGNALED(status)) {
+        report(io->user, "Error: the program was killed by signal %d\n", WTERMSIG(status));
+        return 128 + WTERMSIG(status);
+    }
+    return WEXITSTATUS(status);
+}
+
+static void *connection_main(void *arg)
+{
+    Connection *conn = arg;
+    bool isolate = false;
+    char *source = NULL;
+    size_t len = 0;
+    if (read_request(conn, &isolate, &source, &len)) {
+        BrIO io = { .write = write_output, .read = read_input, .user = conn, .write_error = write_errors };
+        int32_t status = 1;
+        bool cached;
+        BrProgram *program = source ? find_program(source, len, &io, &cached) : NULL;
+        free(source);
+        if (program) {
+            status = isolate ? run_isolated(program, &io) : br_run(program, &io);
+            if (!cached) br_free(program);
+        }
+        reply(conn, SERVE_EXIT, (const char *)&status, sizeof(status));
+    }
+    close(conn->fd);
+    pthread_mutex_destroy(&conn->write_lock);
+    free(conn);
+    return NULL;
+}
+
+static void stop(int sig)
+{
+    unlink(listening_path);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static bool socket_address(const char *path, struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Error: socket path is too long: %s\n", path);
+        return false;
+    }
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+static int connect_to(const struct sockaddr_un *addr)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+int server_listen(const char *socket_path)
+{
+    struct sockaddr_un addr;
+    if (!socket_address(socket_path, &addr)) return 1;
+
+    /* A socket nobody answers on was left by a server that was killed */
+    struct stat st;
+    if (lstat(socket_path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+        int other = connect_to(&addr);
+        if (other >= 0) {
+            close(other);
+            fprintf(stderr, "Error: a server is already listening on %s\n", socket_path);
+            return 1;
+        }
+        unlink(socket_path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("Cannot create the server socket");
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+    /* Requests run scripts as this user, so only this user may make them */
+    if (chmod(socket_path, S_IRUSR | S_IWUSR) != 0 || listen(fd, SOMAXCONN) != 0) {
+        perror("Cannot listen on the server socket");
+        close(fd);
+        unlink(socket_path);
+        return 1;
+    }
+
+    listening_path = socket_path;
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (;;) {
+        int client = accept4(fd, NULL, NULL, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("Cannot accept a connection");
+            sleep(1); /* out of descriptors or memory: let runs finish */
+            continue;
+        }
+
+        Connection *conn = calloc(1, sizeof(Connection));
+        pthread_t thread;
+        if (!conn) {
+            close(client);
+            continue;
+        }
+        conn->fd = client;
+        pthread_mutex_init(&conn->write_lock, NULL);
+        if (pthread_create(&thread, &attr, connection_main, conn) != 0) {
+            pthread_mutex_destroy(&conn->write_lock);
+            close(client);
+            free(conn);
+        }
+    }
+}
+
+/* ── Client ──────────────────────────────────────────────────────────────── */
+
+/* Sends this process's input as it arrives, on a thread of its own so that
+ * replies keep flowing while it waits */
+static void *forward_input(void *arg)
+{
+    int fd = *(int *)arg;
+    char *buf = malloc(SERVE_CHUNK);
+    for (;;) {
+        ssize_t n = buf ? read(STDIN_FILENO, buf, SERVE_CHUNK) : 0;
+        if (n < 0 && errno == EINTR) continue;
+        if (!send_frame(fd, SERVE_INPUT, buf, n > 0 ? (uint32_t)n : 0) || n <= 0) break;
+    }
+    free(buf);
+    return NULL;
+}
+
+int server_request(const char *socket_path, const char *script_path, bool isolate)
+{
+    struct sockaddr_un addr;
+    if (!socket_address(socket_path, &addr)) return 1;
+
+    char *path = realpath(script_path, NULL);
+    if (!path) {
+        perror("Cannot open source file");
+        return 1;
+    }
+    static int fd; /* the detached input thread may outlive this call */
+    fd = connect_to(&addr);
+    if (fd < 0) {
+        perror("Cannot connect to the server");
+        free(path);
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    bool sent = (!isolate || send_frame(fd, SERVE_ISOLATE, NULL, 0)) &&
+                send_frame(fd, SERVE_PATH, path, (uint32_t)strlen(path));
+    free(path);
+
+    pthread_t input;
+    if (sent && pthread_create(&input, NULL, forward_input, &fd) == 0) {
+        pthread_detach(input);
+    }
+
+    size_t capacity = SERVE_CHUNK;
+    char *data = malloc(capacity);
+    char type;
+    uint32_t len;
+    int status = -1;
+    while (sent && data && status < 0 && receive_header(fd, &type, &len)) {
+        if (len > capacity) {
+            char *grown = realloc(data, len);
+            if (!grown) break;
+            data = grown;
+            capacity = len;
+        }
+        if (!read_all(fd, data, len)) break;
+        if (type == SERVE_OUTPUT) {
+            write_all(STDOUT_FILENO, data, len);
+        } else if (type == SERVE_ERRORS) {
+            write_all(STDERR_FILENO, data, len);
+        } else if (type == SERVE_EXIT && len == sizeof(int32_t)) {
+            int32_t code;
+            memcpy(&code, data, sizeof(code));
+            status = code & 0xff;
+        }
+    }
+    free(data);
+    if (status < 0) {
+        fprintf(stderr, "Error: lost the connection to the server\n");
+        status = 1;
+    }
+    return status;
+}
+
+/* ── Fork server ─────────────────────────────────────────────────────────── */
+
+/* Runs program in a child with input and output as its stdin and stdout */
+static pid_t start_job(BrProgram *program, const char *input, const char *output)
+{
+    /* Whatever the child inherits unflushed it would write again */
+    fflush(NULL);
+    pid_t child = fork();
+    if (child != 0) {
+        if (child < 0) perror("Cannot fork a job");
+        return child;
+    }
+
+    int in = open(input, O_RDONLY);
+    if (in < 0) {
+        fprintf(stderr, "Error: cannot open job input %s: %s\n", input, strerror(errno));
+        _exit(1);
+    }
+    int out = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        fprintf(stderr, "Error: cannot open job output %s: %s\n", output, strerror(errno));
+        _exit(1);
+    }
+    dup2(in, STDIN_FILENO);
+    dup2(out, STDOUT_FILENO);
+    close(in);
+    close(out);
+    _exit(br_run(program, NULL));
+}
+
+/* Waits for one of the running jobs, reports it and frees its slot */
+static bool finish_job(pid_t *running, char **inputs, size_t slots, FILE *report)
+{
+    int status;
+    pid_t child;
+    do {
+        child = wait(&status);
+    } while (child < 0 && errno == EINTR);
+    if (child < 0) return false;
+
+    int code = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+    for (size_t i = 0; i < slots; i++) {
+        if (running[i] == child) {
+            fprintf(report, "%d\t%s\n", code, inputs[i] ? inputs[i] : "?");
+            fflush(report);
+            running[i] = 0;
+            free(inputs[i]);
+            inputs[i] = NULL;
+            break;
+        }
+    }
+    return code == 0;
+}
+
+int server_fork_jobs(BrProgram *program, FILE *jobs, FILE *report)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t slots = cpus > 0 ? (size_t)cpus : 1;
+    pid_t *running = calloc(slots, sizeof(pid_t));
+    char **inputs = calloc(slots, sizeof(char *));
+    if (!running || !inputs) {
+        fprintf(stderr, "Error: Failed to allocate memory for jobs\n");
+        free(running);
+        free(inputs);
+        return 1;
+    }
+
+    bool all_passed = true;
+    size_t busy = 0;
+    char *line = NULL;
+    size_t capacity = 0;
+    ssize_t len;
+    for (unsigned long number = 1; (len = getline(&line, &capacity, jobs)) >= 0; number++) {
+        if (len > 0 && line[len - 1] == '\n') line[--len] = '\0';
+        if (len == 0) continue;
+        char *tab = strchr(line, '\t');
+        if (!tab || tab == line || tab[1] == '\0') {
+            fprintf(stderr, "Error: job %lu is not <input> TAB <output>\n", number);
+            all_passed = false;
+            continue;
+        }
+        *tab = '\0';
+
+        if (busy == slots) {
+            all_passed &= finish_job(running, inputs, slots, report);
+            busy--;
+        }
+        pid_t child = start_job(program, line, tab + 1);
+        if (child < 0) {
+            all_passed = false;
+            continue;
+        }
+        for (size_t i = 0; i < slots; i++) {
+            if (running[i] == 0) {
+                running[i] = child;
+                inputs[i] = strdup(line);
+                break;
+            }
+        }
+        busy++;
+    }
+    while (busy > 0) {
+        all_passed &= finish_job(running, inputs, slots, report);
+        busy--;
+    }
+
+    free(line);
+    free(running);
+    free(inputs);
+    return all_passed ? 0 : 1;
+}
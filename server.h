@@ -0,0 +1,64 @@
+/* server.h – Warm interpreter daemon and fork server
+ *
+ *     brainrot --serve /tmp/brainrot.sock &
+ *     brainrot --client /tmp/brainrot.sock script.brainrot < input
+ *     brainrot --fork-server script.brainrot < jobs
+ *
+ * --serve keeps a process resident with the builtins loaded, and caches
+ * every program it compiles under its source text, so running a script it
+ * has seen before costs neither a process, a dlopen nor a parse. Each
+ * connection carries one request. It runs on a thread of its own, in a
+ * fresh runtime from br_run(), with the request's input, output and
+ * diagnostics instead of the server's. A request can ask for isolation:
+ * its run is then forked off the server, so that a crash cannot take the
+ * server down, at the cost of a fork.
+ *
+ * Requests and replies are frames: a type byte, a length in 4 bytes of host
+ * order, and that many bytes of data.
+ *
+ *     client: [SERVE_ISOLATE] SERVE_PATH or SERVE_SOURCE, then SERVE_INPUT
+ *             frames as the program's input arrives, an empty one at its end
+ *     server: SERVE_OUTPUT and SERVE_ERRORS frames, then SERVE_EXIT with the
+ *             exit status as a 4-byte int
+ *
+ * The server only reads input frames while the program is reading, so a
+ * client must keep reading replies while it sends them.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "brainrot.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+enum {
+    SERVE_ISOLATE = 'X', /* empty: run the request in a child process, killed if the client hangs up */
+    SERVE_PATH = 'P',    /* the path of the script, as the server sees it */
+    SERVE_SOURCE = 'S',  /* the script itself */
+    SERVE_INPUT = 'I',   /* program input; empty at its end */
+    SERVE_OUTPUT = 'o',
+    SERVE_ERRORS = 'e',
+    SERVE_EXIT = 'x',
+};
+
+/* Serves requests on a Unix socket at socket_path until killed. Returns 1
+ * if it cannot listen there. */
+int server_listen(const char *socket_path);
+
+/* Runs script_path on the server at socket_path with this process's input,
+ * output and diagnostics, and returns its exit status */
+int server_request(const char *socket_path, const char *script_path, bool isolate);
+
+/* Fork server: runs program once per job read from jobs, each job a line
+ *
+ *     <input path> TAB <output path>
+ *
+ * in a child forked from this process, with the input file as its stdin and
+ * the output file as its stdout. The children start from the compiled
+ * program, so a job costs a fork and no parsing. Up to one job per CPU runs
+ * at a time. As each job ends, "<exit status> TAB <input path>" is written
+ * to report. Returns 0 if every job exited with 0, else 1. */
+int server_fork_jobs(BrProgram *program, FILE *jobs, FILE *report);
+
+#endif /* SERVER_H */
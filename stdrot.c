@@ -5,11 +5,14 @@
  *   • libstdrot.so (pure I/O functions, zero interpreter dependency)
  *
  * It provides:
- *   1. Dynamic loader (stdrot_load/unload) that opens libstdrot.so and
- *      discovers all functions via stdrot_get_api()
- *   2. Thin varargs stubs (yapping/yappin/baka) that forward to the .so
+ *   1. Loader (stdrot_load/unload) that opens libstdrot.so and discovers
+ *      all functions via stdrot_get_api(). With -DSTDROT_STATIC (make static)
+ *      the stdrot objects are linked in and no dlopen happens at all.
+ *   2. Thin varargs stubs (yapping/yappin/baka) that forward to the .so,
+ *      resolving their target symbol on first use
  *   3. AST bridge functions (execute_*_call) that evaluate arguments and
- *      call the raw implementations
+ *      call the raw implementations. Names are looked up in a hash index
+ *      built at load time and each call node caches its StdrotFn
  */
 
 #include "stdrot.h"
@@ -20,13 +23,23 @@
 #include <string.h>
 #include <stdarg.h>
 #include <dlfcn.h>
+#include <unistd.h>
 
-/* ── Global execution context ────────────────────────────────────────────── */
-ExecutionContext g_exec_context = {
-    0,
-    { NULL, 0 },
-    { NULL, 0 }
-};
+/* ── Execution context ───────────────────────────────────────────────────── */
+
+/* The context lives in the program's runtime, so builtins running for
+ * different programs on different threads never share one */
+ExecutionContext *stdrot_exec_context(void)
+{
+    return &current_runtime->exec_context;
+}
+
+/* Builtins end the program through here, so it unwinds to br_run() when
+ * the interpreter is embedded */
+void stdrot_exit(int status)
+{
+    runtime_exit(status);
+}
 
 /* ── External interpreter functions ──────────────────────────────────────── */
 extern void yyerror(const char *s);
@@ -44,59 +57,41 @@ extern bool set_float_variable(const String name, float value, TypeModifiers mod
 extern bool set_double_variable(const String name, double value, TypeModifiers mods);
 extern bool set_short_variable(const String name, short value, TypeModifiers mods);
 extern bool set_bool_variable(const String name, bool value, TypeModifiers mods);
+extern size_t get_type_size_for_descriptor(VarType type, int pointer_level, TypeModifiers mods);
 
-/* ── Dynamic library state ────────────────────────────────────────────────── */
+/* ── Library state ───────────────────────────────────────────────────────── */
 static void *lib_handle = NULL;
 static StdrotEntry *functions = NULL;
 static int function_count = 0;
-
-/* Symbol cache to avoid repeated dlsym calls */
-#define STDROT_CACHE_SIZE 64
-typedef struct {
-    String name;
-    void *ptr;
-} SymbolCache;
-
-static SymbolCache symbol_cache[STDROT_CACHE_SIZE];
-static int cache_count = 0;
-
-/* ── Forward declarations of stub functions ──────────────────────────────── */
-void yapping(const String format, ...);
-void yappin(const String format, ...);
-void baka(const String format, ...);
-void ragequit(int exit_code);
-void chill(unsigned int seconds);
-char slorp_char(char chr);
-String slorp_string(String string, size_t size);
-int slorp_int(int val);
-short slorp_short(short val);
-float slorp_float(float var);
-double slorp_double(double var);
-
-/* ── Dynamic symbol lookup with caching ──────────────────────────────────── */
-
-static void *stdrot_lookup_symbol(const String symbol_name)
-{
-    if (!lib_handle || !symbol_name.data) return NULL;
-
-    /* Check cache first */
-    for (int i = 0; i < cache_count; i++) {
-        if (strcmp(symbol_cache[i].name.data, symbol_name.data) == 0) {
-            return symbol_cache[i].ptr;
-        }
-    }
-
-    /* Not in cache, lookup via dlsym */
-    void *ptr = dlsym(lib_handle, symbol_name.data);
-    if (ptr && cache_count < STDROT_CACHE_SIZE) {
-        symbol_cache[cache_count].name.data = symbol_name.data;
-        symbol_cache[cache_count].name.len = symbol_name.len;
-        symbol_cache[cache_count].ptr = ptr;
-        cache_count++;
-    }
-
-    return ptr;
-}
+static HashMap *function_index = NULL; /* name -> StdrotEntry*, built at load */
+
+#ifndef STDROT_STATIC
+/* Stub targets, resolved from libstdrot.so by stdrot_load() and kept until
+ * stdrot_unload(). Resolving them all up front, under the host's
+ * pthread_once, means the threads running programs only ever read them. */
+static struct {
+    void (*v_yapping)(const char *, va_list);
+    void (*v_yappin)(const char *, va_list);
+    void (*v_baka)(const char *, va_list);
+    void (*ragequit)(int);
+    void (*chill)(unsigned int);
+    char (*slorp_char)(char);
+    char *(*slorp_string)(char *, size_t);
+    int (*slorp_int)(int);
+    short (*slorp_short)(short);
+    float (*slorp_float)(float);
+    double (*slorp_double)(double);
+    int (*stdrot_format_compile)(String, StdrotFormatOp *, int, int *);
+    void (*stdrot_release)(ExecutionContext *);
+} stubs;
+
+#define STDROT_RESOLVE_STUB(field) (*(void **)(&stubs.field) = dlsym(lib_handle, #field))
+#else
+/* Static build: the stdrot objects are linked into this binary. */
+extern void v_yapping(const char *fmt, va_list ap);
+extern void v_yappin(const char *fmt, va_list ap);
+extern void v_baka(const char *fmt, va_list ap);
+#endif
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
@@ -105,13 +100,16 @@ static void *stdrot_lookup_symbol(const String symbol_name)
 
 void stdrot_load(void)
 {
-    /* First, make main binary symbols available to subsequently loaded libraries
-     * by loading the main program's symbols with RTLD_GLOBAL
-     */
-    dlopen(NULL, RTLD_LAZY | RTLD_GLOBAL);
-    
-    /* Open libstdrot.so from the same directory as the binary, or LD_LIBRARY_PATH
-     * Use RTLD_GLOBAL so the library can access symbols from the main binary (e.g., g_exec_context)
+#ifdef STDROT_STATIC
+    /* Everything STDROT_EXPORT()ed was linked into this executable, so the
+     * registry is simply our own stdrot_exports section. */
+    StdrotAPI api = stdrot_get_api();
+    functions = api.functions;
+    function_count = api.count;
+#else
+    /* Open libstdrot.so from the same directory as the binary, or LD_LIBRARY_PATH.
+     * The binary is linked with -rdynamic, so the library already sees our
+     * exported symbols (e.g., stdrot_exec_context) without re-opening ourselves.
      */
     lib_handle = dlopen("./libstdrot.so", RTLD_LAZY | RTLD_GLOBAL);
     if (!lib_handle) {
@@ -135,6 +133,28 @@ void stdrot_load(void)
     StdrotAPI api = get_api();
     functions = api.functions;
     function_count = api.count;
+
+    STDROT_RESOLVE_STUB(v_yapping);
+    STDROT_RESOLVE_STUB(v_yappin);
+    STDROT_RESOLVE_STUB(v_baka);
+    STDROT_RESOLVE_STUB(ragequit);
+    STDROT_RESOLVE_STUB(chill);
+    STDROT_RESOLVE_STUB(slorp_char);
+    STDROT_RESOLVE_STUB(slorp_string);
+    STDROT_RESOLVE_STUB(slorp_int);
+    STDROT_RESOLVE_STUB(slorp_short);
+    STDROT_RESOLVE_STUB(slorp_float);
+    STDROT_RESOLVE_STUB(slorp_double);
+    STDROT_RESOLVE_STUB(stdrot_format_compile);
+    STDROT_RESOLVE_STUB(stdrot_release);
+#endif
+
+    function_index = hm_new();
+    for (int i = 0; i < function_count; i++) {
+        StdrotEntry *entry = &functions[i];
+        if (!entry->name || !entry->fn) continue;
+        hm_put(function_index, entry->name, strlen(entry->name), &entry, sizeof(StdrotEntry *));
+    }
 }
 
 void stdrot_unload(void)
@@ -142,29 +162,249 @@ void stdrot_unload(void)
     if (lib_handle) {
         dlclose(lib_handle);
         lib_handle = NULL;
-        functions = NULL;
-        function_count = 0;
-        cache_count = 0;
+    }
+    if (function_index) {
+        hm_free_shallow(function_index);
+        function_index = NULL;
+    }
+    functions = NULL;
+    function_count = 0;
+#ifndef STDROT_STATIC
+    memset(&stubs, 0, sizeof(stubs));
+#endif
+}
+
+/* ── Output buffering ────────────────────────────────────────────────────── */
+
+#define STDROT_OUTPUT_BUFFER_SIZE (1 << 20)
+
+/* Backing store for stdout; lives for the whole run so exit() can flush it */
+static char output_buffer[STDROT_OUTPUT_BUFFER_SIZE];
+
+void stdrot_configure_output(OutputBufferMode mode)
+{
+    if (mode == OUTPUT_BUFFER_AUTO) {
+        mode = isatty(STDOUT_FILENO) ? OUTPUT_BUFFER_LINE : OUTPUT_BUFFER_BLOCK;
+    }
+
+    switch (mode) {
+    case OUTPUT_BUFFER_NONE:
+        setvbuf(stdout, NULL, _IONBF, 0);
+        break;
+    case OUTPUT_BUFFER_LINE:
+        setvbuf(stdout, output_buffer, _IOLBF, sizeof(output_buffer));
+        break;
+    default:
+        setvbuf(stdout, output_buffer, _IOFBF, sizeof(output_buffer));
+        break;
     }
 }
 
 /* ── Runtime query ────────────────────────────────────────────────────────── */
 
+static StdrotEntry *stdrot_lookup_entry(const String func_name)
+{
+    if (!func_name.data || !function_index) return NULL;
+
+    StdrotEntry **entry = (StdrotEntry **)hm_get(function_index, func_name.data, func_name.len);
+    return entry ? *entry : NULL;
+}
+
+StdrotFn stdrot_lookup(const String func_name)
+{
+    StdrotEntry *entry = stdrot_lookup_entry(func_name);
+    return entry ? entry->fn : NULL;
+}
+
 bool is_builtin_function(const String func_name)
 {
-    if (!func_name.data || !functions) return false;
+    return stdrot_lookup(func_name) != NULL;
+}
 
-    for (int i = 0; i < function_count; i++) {
-        if (strcmp(func_name.data, functions[i].name) == 0) {
-            return true;
+/* Returns the builtin a call node refers to, resolving it on the first visit
+ * (normally during semantic analysis) and caching it on the node. Runs of a
+ * compiled program may resolve nodes concurrently, hence the atomics: the
+ * flags are published before the function. */
+StdrotFn stdrot_bind_call(ASTNode *call)
+{
+    StdrotFn fn = __atomic_load_n(&call->data.func_call.builtin_fn, __ATOMIC_ACQUIRE);
+    if (!fn) {
+        StdrotEntry *entry = stdrot_lookup_entry(call->data.func_call.function_name);
+        if (entry) {
+            fn = entry->fn;
+            __atomic_store_n(&call->data.func_call.builtin_flags, entry->flags, __ATOMIC_RELAXED);
+            __atomic_store_n(&call->data.func_call.builtin_fn, fn, __ATOMIC_RELEASE);
         }
     }
-    return false;
+    return fn;
+}
+
+unsigned stdrot_call_flags(ASTNode *call)
+{
+    if (!stdrot_bind_call(call)) return 0;
+    return __atomic_load_n(&call->data.func_call.builtin_flags, __ATOMIC_RELAXED);
+}
+
+static VarType stdrot_type_to_var_type(int type)
+{
+    switch (type) {
+    case STDROT_INT:    return VAR_INT;
+    case STDROT_FLOAT:  return VAR_FLOAT;
+    case STDROT_DOUBLE: return VAR_DOUBLE;
+    case STDROT_SHORT:  return VAR_SHORT;
+    case STDROT_BOOL:   return VAR_BOOL;
+    case STDROT_CHAR:   return VAR_CHAR;
+    case STDROT_STRING: return VAR_STRING;
+    default:            return NONE;
+    }
+}
+
+/* Type a builtin call yields inside an expression, or NONE when it is not
+ * a builtin or only works as a statement. */
+VarType stdrot_call_type(ASTNode *call)
+{
+    if (!stdrot_bind_call(call)) return NONE;
+
+    unsigned flags = stdrot_call_flags(call);
+    if (flags & STDROT_RETURNS_ELEM) {
+        ArgumentList *args = call->data.func_call.arguments;
+        if (!args || !args->expr || args->expr->type != NODE_IDENTIFIER) return NONE;
+        Variable *var = get_variable(args->expr->data.name);
+        return var && var->is_array ? var->var_type : NONE;
+    }
+    return stdrot_type_to_var_type(STDROT_RETURN_TYPE(flags));
+}
+
+static int compile_format(String text, StdrotFormatOp *ops, int capacity, int *arg_count)
+{
+#ifdef STDROT_STATIC
+    return stdrot_format_compile(text, ops, capacity, arg_count);
+#else
+    int (*fn)(String, StdrotFormatOp *, int, int *) = stubs.stdrot_format_compile;
+    return fn ? fn(text, ops, capacity, arg_count) : -1;
+#endif
+}
+
+void stdrot_release_context(ExecutionContext *ctx)
+{
+    if (!ctx->handles && !ctx->input) return;
+#ifdef STDROT_STATIC
+    stdrot_release(ctx);
+#else
+    void (*fn)(ExecutionContext *) = stubs.stdrot_release;
+    if (fn) fn(ctx);
+#endif
+}
+
+/* For builtins exported with STDROT_TAKES_FORMAT whose format is a string
+ * literal, compiles the format once into the program's arena and caches it on
+ * the call node. Returns NULL when there is nothing to precompile. */
+const StdrotFormat *stdrot_bind_format(ASTNode *call)
+{
+    if (call->data.func_call.format) return call->data.func_call.format;
+
+    ArgumentList *args = call->data.func_call.arguments;
+    if (!args || !args->expr || args->expr->type != NODE_STRING_LITERAL) return NULL;
+
+    StdrotEntry *entry = stdrot_lookup_entry(call->data.func_call.function_name);
+    if (!entry || !(entry->flags & STDROT_TAKES_FORMAT)) return NULL;
+
+    String text = args->expr->data.name;
+    int arg_count = 0;
+    int op_count = compile_format(text, NULL, 0, &arg_count);
+    if (op_count < 0) return NULL;
+
+    StdrotFormatOp *ops = NULL;
+    if (op_count > 0) {
+        ops = arena_alloc(&current_runtime->arena, (size_t)op_count * sizeof(StdrotFormatOp));
+        compile_format(text, ops, op_count, NULL);
+    }
+
+    StdrotFormat *format = arena_alloc(&current_runtime->arena, sizeof(StdrotFormat));
+    format->ops = ops;
+    format->op_count = op_count;
+    format->arg_count = arg_count;
+    call->data.func_call.format = format;
+    return format;
+}
+
+/* The StdrotType of an element of type; false if builtins cannot take it */
+static bool element_type(VarType type, StdrotType *out)
+{
+    switch (type) {
+    case VAR_INT:    *out = STDROT_INT;    return true;
+    case VAR_SHORT:  *out = STDROT_SHORT;  return true;
+    case VAR_FLOAT:  *out = STDROT_FLOAT;  return true;
+    case VAR_DOUBLE: *out = STDROT_DOUBLE; return true;
+    case VAR_BOOL:   *out = STDROT_BOOL;   return true;
+    case VAR_CHAR:   *out = STDROT_CHAR;   return true;
+    default:         return false;
+    }
+}
+
+/* Lends an array to a builtin without copying it */
+static void array_to_stdrot_value(Variable *var, StdrotValue *out)
+{
+    StdrotType elem_type;
+
+    if (var->pointer_level > 0 || !element_type(var->var_type, &elem_type)) return;
+
+    out->type = STDROT_ARRAY;
+    out->val.arr.elem_type = elem_type;
+    /* cap arrays are bit-packed and have no per-element size */
+    out->val.arr.elem_size = is_packed_bool_array(var)
+        ? 0 : get_type_size_for_descriptor(var->var_type, 0, var->modifiers);
+    out->val.arr.data = var->value.array_data;
+    out->val.arr.length = (size_t)var->array_length;
+    if (var->array_dimensions.num_dimensions > 0) {
+        out->val.arr.dims = var->array_dimensions.dimensions;
+        out->val.arr.rank = var->array_dimensions.num_dimensions;
+    } else {
+        /* plain `type name[N]` arrays only record their length */
+        out->val.arr.dims = &var->array_length;
+        out->val.arr.rank = 1;
+    }
 }
 
-void execute_builtin_function(const String func_name, ArgumentList *args)
+/* Lends a variable or array element to a STDROT_TAKES_REF builtin. Leaves
+ * out alone for anything else, which is then passed by value. */
+static void reference_to_stdrot_value(ASTNode *expr, StdrotValue *out)
 {
-    execute_func_call(func_name, args);
+    Variable *var;
+    StdrotType elem_type;
+    void *data;
+    size_t size;
+
+    if (expr->type == NODE_IDENTIFIER) {
+        var = get_variable(expr->data.name);
+        if (!var || var->is_array || var->pointer_level > 0) return;
+        switch (var->var_type) {
+        case VAR_INT:    size = sizeof(int);    break;
+        case VAR_SHORT:  size = sizeof(short);  break;
+        case VAR_FLOAT:  size = sizeof(float);  break;
+        case VAR_DOUBLE: size = sizeof(double); break;
+        case VAR_BOOL:   size = sizeof(bool);   break;
+        default:
+            return;
+        }
+        data = evaluate_lvalue_address(expr);
+    } else if (expr->type == NODE_ARRAY_ACCESS) {
+        size_t offset;
+        var = resolve_array_element(expr, &offset);
+        if (!var || is_packed_bool_array(var) || var->pointer_level > 0) return;
+        size = get_type_size_for_descriptor(var->var_type, 0, var->modifiers);
+        data = array_element_address(var, offset);
+    } else {
+        return;
+    }
+
+    if (!element_type(var->var_type, &elem_type)) return;
+    if (var->modifiers.is_const) {
+        yyerror("Cannot modify const variable");
+        runtime_exit(EXIT_FAILURE);
+    }
+    out->type = STDROT_ARRAY;
+    out->val.arr = (StdrotArray){ elem_type, size, data, 1, NULL, 0 };
 }
 
 static void ast_expr_to_stdrot_value(ASTNode *expr, StdrotValue *out)
@@ -205,9 +445,20 @@ static void ast_expr_to_stdrot_value(ASTNode *expr, StdrotValue *out)
         out->type = STDROT_INT;
         out->val.i = evaluate_expression_int(expr);
         return;
+    case NODE_FUNC_CALL:
+        /* Builtin results pass straight through with their own type */
+        if (stdrot_bind_call(expr)) {
+            *out = stdrot_eval_call(expr);
+            return;
+        }
+        break;
     case NODE_IDENTIFIER: {
         Variable *var = get_variable(expr->data.name);
         if (!var) return;
+        if (var->is_array) {
+            array_to_stdrot_value(var, out);
+            return;
+        }
         switch (var->var_type) {
         case VAR_INT:
             out->type = STDROT_INT;
@@ -230,14 +481,8 @@ static void ast_expr_to_stdrot_value(ASTNode *expr, StdrotValue *out)
             out->val.b = var->value.bvalue;
             return;
         case VAR_CHAR:
-            if (var->is_array) {
-                out->type = STDROT_STRING;
-                out->val.str.data = (char *)var->value.array_data;
-                out->val.str.len  = (size_t)var->array_length;
-            } else {
-                out->type = STDROT_CHAR;
-                out->val.c = (char)var->value.ivalue;
-            }
+            out->type = STDROT_CHAR;
+            out->val.c = (char)var->value.ivalue;
             return;
         case VAR_STRING:
             out->type = STDROT_STRING;
@@ -271,56 +516,110 @@ static void ast_expr_to_stdrot_value(ASTNode *expr, StdrotValue *out)
     }
 }
 
-void execute_func_call(const String func_name, ArgumentList *args)
+/* Evaluates the arguments of a builtin call and runs it */
+static StdrotValue invoke_builtin(StdrotFn fn, unsigned flags, const String func_name,
+                                  ArgumentList *args, const StdrotFormat *format)
 {
-    if (!func_name.data || !functions) {
-        yyerror("Function not found");
-        return;
-    }
-
-    /* Look up function in the registry */
-    StdrotEntry *entry = NULL;
-    for (int i = 0; i < function_count; i++) {
-        if (strcmp(functions[i].name, func_name.data) == 0) {
-            entry = &functions[i];
-            break;
-        }
-    }
-
-    if (!entry || !entry->fn) {
-        yyerror("Unknown function");
-        return;
-    }
-
-    /* Set execution context - get line number from first argument node */
-    g_exec_context.function_name.data = func_name.data;
-    g_exec_context.line_number = 0;
-    if (args && args->expr && args->expr->line_number > 0) {
-        g_exec_context.line_number = args->expr->line_number;
-    }
-
     /* Generic function call - evaluate all arguments to StdrotValue */
     StdrotValue arg_values[64];
     int arg_count = 0;
 
     ArgumentList *cur = args;
+
+    /* A precompiled format replaces the string literal it was built from */
+    if (format && cur) {
+        arg_values[0].type = STDROT_FORMAT;
+        arg_values[0].val.fmt = format;
+        arg_count = 1;
+        cur = cur->next;
+    }
+
     while (cur && arg_count < 64) {
         ASTNode *expr = cur->expr;
         if (!expr) break;
 
-        ast_expr_to_stdrot_value(expr, &arg_values[arg_count]);
+        arg_values[arg_count].type = STDROT_NONE;
+        if (arg_count == 0 && (flags & STDROT_TAKES_REF)) {
+            reference_to_stdrot_value(expr, &arg_values[0]);
+        }
+        if (arg_values[arg_count].type == STDROT_NONE) {
+            ast_expr_to_stdrot_value(expr, &arg_values[arg_count]);
+        }
 
         arg_count++;
         cur = cur->next;
     }
 
-    StdrotValue result = entry->fn(arg_values, arg_count);
+    /* Set execution context - get line number from first argument node.
+     * Done after the arguments, which may be builtin calls themselves. */
+    current_runtime->exec_context.function_name.data = func_name.data;
+    current_runtime->exec_context.line_number = 0;
+    if (args && args->expr && args->expr->line_number > 0) {
+        current_runtime->exec_context.line_number = args->expr->line_number;
+    }
+
+    return fn(arg_values, arg_count);
+}
+
+/* Runs a builtin inside an expression. Unlike execute_func_call, the result
+ * is only returned, never written back into the first argument. */
+StdrotValue stdrot_eval_call(ASTNode *call)
+{
+    StdrotFn fn = stdrot_bind_call(call);
+    if (!fn) {
+        yyerror("Unknown function");
+        return (StdrotValue){STDROT_NONE, {0}};
+    }
+    return invoke_builtin(fn, stdrot_call_flags(call), call->data.func_call.function_name,
+                          call->data.func_call.arguments, call->data.func_call.format);
+}
+
+long long stdrot_eval_call_integer(ASTNode *call)
+{
+    StdrotValue v = stdrot_eval_call(call);
+    switch (v.type) {
+    case STDROT_INT:    return v.val.i;
+    case STDROT_SHORT:  return v.val.s;
+    case STDROT_BOOL:   return v.val.b;
+    case STDROT_CHAR:   return v.val.c;
+    case STDROT_FLOAT:  return (long long)v.val.f;
+    case STDROT_DOUBLE: return (long long)v.val.d;
+    default:            return 0;
+    }
+}
+
+double stdrot_eval_call_real(ASTNode *call)
+{
+    StdrotValue v = stdrot_eval_call(call);
+    switch (v.type) {
+    case STDROT_INT:    return v.val.i;
+    case STDROT_SHORT:  return v.val.s;
+    case STDROT_BOOL:   return v.val.b;
+    case STDROT_CHAR:   return v.val.c;
+    case STDROT_FLOAT:  return v.val.f;
+    case STDROT_DOUBLE: return v.val.d;
+    default:            return 0.0;
+    }
+}
+
+void execute_func_call(StdrotFn fn, unsigned flags, const String func_name, ArgumentList *args,
+                       const StdrotFormat *format)
+{
+    if (!fn) {
+        yyerror("Unknown function");
+        return;
+    }
+
+    StdrotValue result = invoke_builtin(fn, flags, func_name, args, format);
 
     /* Generic write-back: if first arg is an identifier and function returned a value,
      * write the returned value back to that variable. */
-    if (result.type != STDROT_NONE && args && args->expr && args->expr->type == NODE_IDENTIFIER) {
+    if (result.type != STDROT_NONE && !(flags & (STDROT_TAKES_REF | STDROT_TAKES_HANDLE)) &&
+        args && args->expr && args->expr->type == NODE_IDENTIFIER) {
         const String name = args->expr->data.name;
         Variable *var = get_variable(name);
+        /* Arrays are only ever written back as strings (char arrays) */
+        if (var && var->is_array && result.type != STDROT_STRING) var = NULL;
         if (var) {
             switch (result.type) {
             case STDROT_INT:
@@ -365,125 +664,114 @@ void execute_func_call(const String func_name, ArgumentList *args)
     }
 }
 
-/* ── Stub functions (thin wrappers that forward to .so) ────────────────────── */
+/* ── Stub functions (thin wrappers that forward to the implementations) ──── */
+
+#ifdef STDROT_STATIC
+
+void yapping(const String format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    v_yapping(format.data, ap);
+    va_end(ap);
+}
+
+void yappin(const String format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    v_yappin(format.data, ap);
+    va_end(ap);
+}
+
+void baka(const String format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    v_baka(format.data, ap);
+    va_end(ap);
+}
+
+/* ragequit, chill and the slorp_* readers come straight from the stdrot objects */
+
+#else
 
 void yapping(const String format, ...)
 {
-    String s = {
-        .data = "v_yapping",
-        .len = sizeof("v_yapping") - 1
-    };
     va_list ap;
     va_start(ap, format);
-    void (*fn)(const String, va_list) = (void (*)(const String, va_list))stdrot_lookup_symbol(s);
-    if (fn) fn(format, ap);
+    void (*fn)(const char *, va_list) = stubs.v_yapping;
+    if (fn) fn(format.data, ap);
     va_end(ap);
 }
 
 void yappin(const String format, ...)
 {
-    String s = {
-        .data = "v_yappin",
-        .len = sizeof("v_yappin") - 1
-    };
     va_list ap;
     va_start(ap, format);
-    void (*fn)(const String , va_list) = (void (*)(const String , va_list))stdrot_lookup_symbol(s);
-    if (fn) fn(format, ap);
+    void (*fn)(const char *, va_list) = stubs.v_yappin;
+    if (fn) fn(format.data, ap);
     va_end(ap);
 }
 
 void baka(const String format, ...)
 {
-    String s = {
-        .data = "v_baka",
-        .len = sizeof("v_baka") - 1
-    };
     va_list ap;
     va_start(ap, format);
-    void (*fn)(const String , va_list) = (void (*)(const String , va_list))stdrot_lookup_symbol(s);
-    if (fn) fn(format, ap);
+    void (*fn)(const char *, va_list) = stubs.v_baka;
+    if (fn) fn(format.data, ap);
     va_end(ap);
 }
 
 void ragequit(int exit_code)
 {
-    String s = {
-        .data = "ragequit",
-        .len = sizeof("ragequit") - 1
-    };
-    void (*fn)(int) = (void (*)(int))stdrot_lookup_symbol(s);
+    void (*fn)(int) = stubs.ragequit;
     if (fn) fn(exit_code);
 }
 
 void chill(unsigned int seconds)
 {
-    String s = {
-        .data = "chill",
-        .len = sizeof("chill") - 1
-    };
-    void (*fn)(unsigned int) = (void (*)(unsigned int))stdrot_lookup_symbol(s);
+    void (*fn)(unsigned int) = stubs.chill;
     if (fn) fn(seconds);
 }
 
 char slorp_char(char chr)
 {
-    String s = {
-        .data = "slorp_char",
-        .len = sizeof("slorp_char") - 1
-    };
-    char (*fn)(char) = (char (*)(char))stdrot_lookup_symbol(s);
+    char (*fn)(char) = stubs.slorp_char;
     return fn ? fn(chr) : chr;
 }
 
 String slorp_string(String string, size_t size)
 {
-    String s = {
-        .data = "slorp_string",
-        .len = sizeof("slorp_string") - 1
-    };
-    String (*fn)(String , size_t) = (String (*)(String , size_t))stdrot_lookup_symbol(s);
-    return fn ? fn(string, size) : string;
+    char *(*fn)(char *, size_t) = stubs.slorp_string;
+    if (fn) fn(string.data, size);
+    return string;
 }
 
 int slorp_int(int val)
 {
-    String s = {
-        .data = "slorp_int",
-        .len = sizeof("slorp_int") - 1
-    };
-    int (*fn)(int) = (int (*)(int))stdrot_lookup_symbol(s);
+    int (*fn)(int) = stubs.slorp_int;
     return fn ? fn(val) : val;
 }
 
 short slorp_short(short val)
 {
-    String s = {
-        .data = "slorp_short",
-        .len = sizeof("slorp_short") - 1
-    };
-    short (*fn)(short) = (short (*)(short))stdrot_lookup_symbol(s);
+    short (*fn)(short) = stubs.slorp_short;
     return fn ? fn(val) : val;
 }
 
 float slorp_float(float var)
 {
-    String s = {
-        .data = "slorp_float",
-        .len = sizeof("slorp_float") - 1
-    };
-    float (*fn)(float) = (float (*)(float))stdrot_lookup_symbol(s);
+    float (*fn)(float) = stubs.slorp_float;
     return fn ? fn(var) : var;
 }
 
 double slorp_double(double var)
 {
-    String s = {
-        .data = "slorp_double",
-        .len = sizeof("slorp_double") - 1
-    };
-    double (*fn)(double) = (double (*)(double))stdrot_lookup_symbol(s);
+    double (*fn)(double) = stubs.slorp_double;
     return fn ? fn(var) : var;
 }
 
+#endif /* STDROT_STATIC */
+
 #pragma GCC diagnostic pop
@@ -5,7 +5,8 @@
  *   • AST bridge functions (execute_*_call) that evaluate arguments and call
  *     the raw implementations in libstdrot.so
  *   • A loader (stdrot_load / stdrot_unload) that uses dlopen/dlsym to wire
- *     the stubs and read the function registry from the .so
+ *     the stubs and read the function registry from the .so, or, in a
+ *     STDROT_STATIC build, reads the registry linked into the binary
  */
 
 #ifndef STDROT_H
@@ -18,16 +19,48 @@
 #include <stddef.h>
 
 /* ── Loader lifecycle ────────────────────────────────────────────────────── *
- * Call stdrot_load() once at interpreter startup (interpreter_new).
- * Call stdrot_unload() at interpreter shutdown  (interpreter_free).
+ * br_compile() calls stdrot_load() once per process, before the first parse.
+ * Call stdrot_unload() at shutdown, after the last program is freed.
  */
 void stdrot_load(void);
 void stdrot_unload(void);
 
+/* Frees what builtins kept for a finished program (maps, deques, ...).
+ * Must run before stdrot_unload(). */
+void stdrot_release_context(ExecutionContext *ctx);
+
+/* ── Output buffering ────────────────────────────────────────────────────── *
+ * Selected with --output-buffer. AUTO is line buffering on a terminal and
+ * block buffering otherwise. Call once, before the first write to stdout.
+ */
+typedef enum {
+    OUTPUT_BUFFER_AUTO,
+    OUTPUT_BUFFER_LINE,
+    OUTPUT_BUFFER_BLOCK,
+    OUTPUT_BUFFER_NONE
+} OutputBufferMode;
+
+void stdrot_configure_output(OutputBufferMode mode);
+
 /* ── Runtime query / dispatch ────────────────────────────────────────────── */
 bool is_builtin_function(const String func_name);
-void execute_builtin_function(const String func_name, ArgumentList *args);
-void execute_func_call(const String func_name, ArgumentList *args);
+StdrotFn stdrot_lookup(const String func_name);
+StdrotFn stdrot_bind_call(ASTNode *call);
+/* StdrotEntry.flags of the builtin a call node refers to, 0 if none */
+unsigned stdrot_call_flags(ASTNode *call);
+const StdrotFormat *stdrot_bind_format(ASTNode *call);
+/* flags are the builtin's StdrotEntry.flags */
+void execute_func_call(StdrotFn fn, unsigned flags, const String func_name, ArgumentList *args,
+                       const StdrotFormat *format);
+
+/* ── Builtins inside expressions ─────────────────────────────────────────── *
+ * Only builtins exported with STDROT_RETURNS(...) or STDROT_RETURNS_ELEM
+ * have a type; the _integer/_real variants convert the result like a C cast.
+ */
+VarType stdrot_call_type(ASTNode *call);
+StdrotValue stdrot_eval_call(ASTNode *call);
+long long stdrot_eval_call_integer(ASTNode *call);
+double stdrot_eval_call_real(ASTNode *call);
 
 /* ── Stub functions (forward declarations for use by ast.c) ──────────────── */
 void yapping(const String format, ...);
@@ -35,11 +68,13 @@ void yappin(const String format, ...);
 void baka(const String format, ...);
 void ragequit(int exit_code);
 void chill(unsigned int seconds);
+#ifndef STDROT_STATIC
 char slorp_char(char chr);
 String slorp_string(String string, size_t size);
 int slorp_int(int val);
 short slorp_short(short val);
 float slorp_float(float var);
 double slorp_double(double var);
+#endif
 
 #endif /* STDROT_H */
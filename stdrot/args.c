@@ -0,0 +1,75 @@
+/* stdrot/args.c – Argument helpers shared by the array builtins */
+
+#include "args.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void stdrot_arg_error(const char *message)
+{
+    fflush(g_exec_context.out); /* keep buffered output ahead of the error text */
+    fprintf(g_exec_context.err, "Error: %s: %s at line %d\n",
+            g_exec_context.function_name.data ? g_exec_context.function_name.data : "builtin",
+            message, g_exec_context.line_number);
+    stdrot_exit(EXIT_FAILURE);
+}
+
+StdrotArray stdrot_arg_array(const StdrotValue *args, int argc, int index)
+{
+    if (index >= argc || args[index].type != STDROT_ARRAY) {
+        stdrot_arg_error("expected an array argument");
+    }
+    return args[index].val.arr;
+}
+
+double stdrot_arg_number(const StdrotValue *args, int argc, int index)
+{
+    if (index < argc) {
+        switch (args[index].type) {
+        case STDROT_INT:    return args[index].val.i;
+        case STDROT_SHORT:  return args[index].val.s;
+        case STDROT_FLOAT:  return args[index].val.f;
+        case STDROT_DOUBLE: return args[index].val.d;
+        case STDROT_BOOL:   return args[index].val.b;
+        case STDROT_CHAR:   return args[index].val.c;
+        default:            break;
+        }
+    }
+    stdrot_arg_error("expected a number argument");
+}
+
+long stdrot_arg_integer(const StdrotValue *args, int argc, int index)
+{
+    if (index < argc && args[index].type == STDROT_INT) return args[index].val.i;
+    if (index < argc && args[index].type == STDROT_SHORT) return args[index].val.s;
+    stdrot_arg_error("expected an integer argument");
+}
+
+int stdrot_to_int(double value)
+{
+    if (value != value) return 0;
+    if (value >= (double)INT_MAX) return INT_MAX;
+    if (value <= (double)INT_MIN) return INT_MIN;
+    return (int)value;
+}
+
+void stdrot_arg_range(const StdrotValue *args, int argc, int index,
+                      size_t length, size_t other_length, size_t *start, size_t *count)
+{
+    if (argc <= index) {
+        if (length != other_length) stdrot_arg_error("arrays have different lengths");
+        *start = 0;
+        *count = length;
+        return;
+    }
+    if (argc != index + 2) stdrot_arg_error("a range needs both a start and a count");
+
+    long s = stdrot_arg_integer(args, argc, index);
+    long c = stdrot_arg_integer(args, argc, index + 1);
+    size_t limit = length < other_length ? length : other_length;
+    if (s < 0 || c < 0 || (size_t)s > limit || (size_t)c > limit - (size_t)s) {
+        stdrot_arg_error("range is out of bounds");
+    }
+    *start = (size_t)s;
+    *count = (size_t)c;
+}
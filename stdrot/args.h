@@ -0,0 +1,34 @@
+/* stdrot/args.h – Argument helpers shared by the array builtins
+ *
+ * Internal to libstdrot.so. A bad argument is reported as
+ * "Error: <builtin>: <message> at line N" and ends the program, the same
+ * way slorp treats malformed input.
+ */
+
+#ifndef STDROT_ARGS_H
+#define STDROT_ARGS_H
+
+#include "stdrot_api.h"
+
+__attribute__((noreturn)) void stdrot_arg_error(const char *message);
+
+/* args[index] as an array, of any element type */
+StdrotArray stdrot_arg_array(const StdrotValue *args, int argc, int index);
+
+/* args[index] as a number; bool and char count as numbers */
+double stdrot_arg_number(const StdrotValue *args, int argc, int index);
+
+/* args[index] as a rizz or smol */
+long stdrot_arg_integer(const StdrotValue *args, int argc, int index);
+
+/* value as a rizz: rounded toward zero and saturated at the limits of rizz,
+ * NaN becomes 0 (a plain (int) cast is undefined outside its range) */
+int stdrot_to_int(double value);
+
+/* Optional trailing (start, count) at args[index]. Without one the range is
+ * the whole array, and both lengths must agree (pass the same length twice
+ * for a single array); with one it must fit inside both. */
+void stdrot_arg_range(const StdrotValue *args, int argc, int index,
+                      size_t length, size_t other_length, size_t *start, size_t *count);
+
+#endif /* STDROT_ARGS_H */
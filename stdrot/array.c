@@ -0,0 +1,228 @@
+/* stdrot/array.c – Whole-array builtins for libstdrot.so
+ *
+ * Each builtin works on a rizz or gigachad array, or on an optional
+ * (start, count) range of it, in one call instead of one interpreted loop
+ * iteration per element. The loops themselves live in kernels.c.
+ */
+
+#include "args.h"
+#include "kernels.h"
+#include <limits.h>
+#include <string.h>
+
+/* args[index] as an array the kernels understand */
+static StdrotArray array_arg(const StdrotValue *args, int argc, int index)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, index);
+    bool is_int = arr.elem_type == STDROT_INT && arr.elem_size == sizeof(int);
+    bool is_double = arr.elem_type == STDROT_DOUBLE && arr.elem_size == sizeof(double);
+    if (!is_int && !is_double) {
+        stdrot_arg_error("only rizz and gigachad arrays are supported");
+    }
+    return arr;
+}
+
+static void same_element_type(StdrotArray a, StdrotArray b)
+{
+    if (a.elem_type != b.elem_type) stdrot_arg_error("arrays must have the same element type");
+}
+
+static StdrotValue element_value(StdrotType type, double d, int i)
+{
+    StdrotValue out = {type, {0}};
+    if (type == STDROT_DOUBLE) out.val.d = d;
+    else out.val.i = i;
+    return out;
+}
+
+/* Whether value is a whole number that fits a rizz, so the integer kernels
+ * compute exactly what rizz arithmetic would */
+static bool whole_int(double value, int *out)
+{
+    if (!(value >= (double)INT_MIN && value <= (double)INT_MAX) || value != (int)value) return false;
+    *out = (int)value;
+    return true;
+}
+
+/* ── In-place operations ─────────────────────────────────────────────────── */
+
+/* array_fill(a, value[, start, count]) */
+static StdrotValue stdrot_array_fill(StdrotValue *args, int argc)
+{
+    StdrotArray a = array_arg(args, argc, 0);
+    double value = stdrot_arg_number(args, argc, 1);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 2, a.length, a.length, &start, &count);
+
+    if (a.elem_type == STDROT_DOUBLE) {
+        double *p = (double *)a.data + start;
+        for (size_t i = 0; i < count; i++) p[i] = value;
+    } else {
+        int *p = (int *)a.data + start;
+        int v = stdrot_to_int(value);
+        for (size_t i = 0; i < count; i++) p[i] = v;
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* array_copy(dst, src[, start, count]) */
+static StdrotValue stdrot_array_copy(StdrotValue *args, int argc)
+{
+    StdrotArray dst = array_arg(args, argc, 0);
+    StdrotArray src = array_arg(args, argc, 1);
+    size_t start, count;
+    same_element_type(dst, src);
+    stdrot_arg_range(args, argc, 2, dst.length, src.length, &start, &count);
+
+    memmove((char *)dst.data + start * dst.elem_size,
+            (const char *)src.data + start * src.elem_size, count * dst.elem_size);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* array_scale(a, factor[, start, count]): a *= factor. On a rizz array a
+ * fractional factor scales each element in double and stores it back like
+ * stdrot_to_int() */
+static StdrotValue stdrot_array_scale(StdrotValue *args, int argc)
+{
+    StdrotArray a = array_arg(args, argc, 0);
+    double factor = stdrot_arg_number(args, argc, 1);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 2, a.length, a.length, &start, &count);
+
+    if (a.elem_type == STDROT_DOUBLE) {
+        stdrot_kernels()->scale_d((double *)a.data + start, factor, count);
+    } else {
+        int *p = (int *)a.data + start;
+        int k;
+        if (whole_int(factor, &k)) {
+            stdrot_kernels()->scale_i(p, k, count);
+        } else {
+            for (size_t i = 0; i < count; i++) p[i] = stdrot_to_int(p[i] * factor);
+        }
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* array_axpy(y, alpha, x[, start, count]): y += alpha * x, with a
+ * fractional alpha handled like array_scale's factor */
+static StdrotValue stdrot_array_axpy(StdrotValue *args, int argc)
+{
+    StdrotArray y = array_arg(args, argc, 0);
+    double alpha = stdrot_arg_number(args, argc, 1);
+    StdrotArray x = array_arg(args, argc, 2);
+    size_t start, count;
+    same_element_type(y, x);
+    stdrot_arg_range(args, argc, 3, y.length, x.length, &start, &count);
+
+    if (y.elem_type == STDROT_DOUBLE) {
+        stdrot_kernels()->axpy_d((double *)y.data + start, alpha, (const double *)x.data + start, count);
+    } else {
+        int *py = (int *)y.data + start;
+        const int *px = (const int *)x.data + start;
+        int k;
+        if (whole_int(alpha, &k)) {
+            stdrot_kernels()->axpy_i(py, k, px, count);
+        } else {
+            for (size_t i = 0; i < count; i++) py[i] = stdrot_to_int(py[i] + alpha * px[i]);
+        }
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* ── Reductions ──────────────────────────────────────────────────────────── */
+
+/* array_sum(a[, start, count]) */
+static StdrotValue stdrot_array_sum(StdrotValue *args, int argc)
+{
+    StdrotArray a = array_arg(args, argc, 0);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 1, a.length, a.length, &start, &count);
+
+    if (a.elem_type == STDROT_DOUBLE) {
+        return element_value(STDROT_DOUBLE, stdrot_kernels()->sum_d((const double *)a.data + start, count), 0);
+    }
+    return element_value(STDROT_INT, 0.0, stdrot_kernels()->sum_i((const int *)a.data + start, count));
+}
+
+/* array_dot(a, b[, start, count]) */
+static StdrotValue stdrot_array_dot(StdrotValue *args, int argc)
+{
+    StdrotArray a = array_arg(args, argc, 0);
+    StdrotArray b = array_arg(args, argc, 1);
+    size_t start, count;
+    same_element_type(a, b);
+    stdrot_arg_range(args, argc, 2, a.length, b.length, &start, &count);
+
+    if (a.elem_type == STDROT_DOUBLE) {
+        double d = stdrot_kernels()->dot_d((const double *)a.data + start, (const double *)b.data + start, count);
+        return element_value(STDROT_DOUBLE, d, 0);
+    }
+    int i = stdrot_kernels()->dot_i((const int *)a.data + start, (const int *)b.data + start, count);
+    return element_value(STDROT_INT, 0.0, i);
+}
+
+/* Index of the smallest (or largest) element in the range, relative to the
+ * start of the array */
+static size_t extreme_index(StdrotValue *args, int argc, bool largest, StdrotArray *out)
+{
+    StdrotArray a = array_arg(args, argc, 0);
+    const StdrotKernels *k = stdrot_kernels();
+    size_t start, count;
+    stdrot_arg_range(args, argc, 1, a.length, a.length, &start, &count);
+    if (count == 0) stdrot_arg_error("range is empty");
+
+    *out = a;
+    if (a.elem_type == STDROT_DOUBLE) {
+        const double *p = (const double *)a.data + start;
+        return start + (largest ? k->argmax_d(p, count) : k->argmin_d(p, count));
+    }
+    const int *p = (const int *)a.data + start;
+    return start + (largest ? k->argmax_i(p, count) : k->argmin_i(p, count));
+}
+
+static StdrotValue element_at(StdrotArray a, size_t index)
+{
+    if (a.elem_type == STDROT_DOUBLE) return element_value(STDROT_DOUBLE, ((const double *)a.data)[index], 0);
+    return element_value(STDROT_INT, 0.0, ((const int *)a.data)[index]);
+}
+
+/* array_min(a[, start, count]) */
+static StdrotValue stdrot_array_min(StdrotValue *args, int argc)
+{
+    StdrotArray a;
+    size_t index = extreme_index(args, argc, false, &a);
+    return element_at(a, index);
+}
+
+/* array_max(a[, start, count]) */
+static StdrotValue stdrot_array_max(StdrotValue *args, int argc)
+{
+    StdrotArray a;
+    size_t index = extreme_index(args, argc, true, &a);
+    return element_at(a, index);
+}
+
+/* array_argmin(a[, start, count]) */
+static StdrotValue stdrot_array_argmin(StdrotValue *args, int argc)
+{
+    StdrotArray a;
+    return element_value(STDROT_INT, 0.0, (int)extreme_index(args, argc, false, &a));
+}
+
+/* array_argmax(a[, start, count]) */
+static StdrotValue stdrot_array_argmax(StdrotValue *args, int argc)
+{
+    StdrotArray a;
+    return element_value(STDROT_INT, 0.0, (int)extreme_index(args, argc, true, &a));
+}
+
+STDROT_EXPORT("array_fill", stdrot_array_fill);
+STDROT_EXPORT("array_copy", stdrot_array_copy);
+STDROT_EXPORT("array_scale", stdrot_array_scale);
+STDROT_EXPORT("array_axpy", stdrot_array_axpy);
+STDROT_EXPORT_FLAGS("array_sum", stdrot_array_sum, STDROT_RETURNS_ELEM);
+STDROT_EXPORT_FLAGS("array_dot", stdrot_array_dot, STDROT_RETURNS_ELEM);
+STDROT_EXPORT_FLAGS("array_min", stdrot_array_min, STDROT_RETURNS_ELEM);
+STDROT_EXPORT_FLAGS("array_max", stdrot_array_max, STDROT_RETURNS_ELEM);
+STDROT_EXPORT_FLAGS("array_argmin", stdrot_array_argmin, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("array_argmax", stdrot_array_argmax, STDROT_RETURNS(STDROT_INT));
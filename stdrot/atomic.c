@@ -0,0 +1,111 @@
+/* stdrot/atomic.c – Atomic builtins for libstdrot.so
+ *
+ *     rizz old = atomic_add(hits, 1);              hits += 1, returns before
+ *     atomic_add(hist[v[i] % 10], 1);
+ *     cap swapped = atomic_cas(slot, expected, desired);
+ *     rizz now = atomic_load(hist[3]);
+ *     atomic_store(flag, 1);
+ *
+ * The first argument is a rizz or smol variable or array element, passed
+ * by reference (STDROT_TAKES_REF). Every operation is sequentially
+ * consistent, and they are the only builtins that squad flex bodies may
+ * use to share a variable between iterations: a body that reads such a
+ * variable while other iterations update it must read it with atomic_load.
+ */
+
+#include "args.h"
+#include <stdint.h>
+
+#define ATOMIC_FLAGS (STDROT_TAKES_REF | STDROT_THREAD_SAFE | STDROT_RETURNS(STDROT_INT))
+
+/* args[0] as the variable to operate on */
+static StdrotArray ref_arg(const StdrotValue *args, int argc)
+{
+    if (argc < 1 || args[0].type != STDROT_ARRAY || args[0].val.arr.rank != 0) {
+        stdrot_arg_error("expected a variable or an array element");
+    }
+    StdrotArray ref = args[0].val.arr;
+    bool is_int = ref.elem_type == STDROT_INT && (ref.elem_size == sizeof(int32_t) || ref.elem_size == sizeof(int64_t));
+    bool is_short = ref.elem_type == STDROT_SHORT && ref.elem_size == sizeof(int16_t);
+    if (!is_int && !is_short) {
+        stdrot_arg_error("only rizz and smol variables are supported");
+    }
+    return ref;
+}
+
+/* Runs op on the variable at its own width and returns the result widened */
+#define ATOMIC_APPLY(ref, op)                                    \
+    ((ref).elem_size == sizeof(int16_t) ? (long long)op((int16_t *)(ref).data) : \
+     (ref).elem_size == sizeof(int32_t) ? (long long)op((int32_t *)(ref).data) : \
+                                          (long long)op((int64_t *)(ref).data))
+
+static StdrotValue int_value(long long value)
+{
+    return (StdrotValue){STDROT_INT, {.i = (int)value}};
+}
+
+/* atomic_add(var, delta): adds delta and returns the value before */
+static StdrotValue stdrot_atomic_add(StdrotValue *args, int argc)
+{
+    StdrotArray ref = ref_arg(args, argc);
+    long delta = stdrot_arg_integer(args, argc, 1);
+#define ADD(p) __atomic_fetch_add(p, delta, __ATOMIC_SEQ_CST)
+    return int_value(ATOMIC_APPLY(ref, ADD));
+#undef ADD
+}
+
+/* atomic_cas(var, expected, desired): stores desired if var holds
+ * expected; returns whether it did */
+static StdrotValue stdrot_atomic_cas(StdrotValue *args, int argc)
+{
+    StdrotArray ref = ref_arg(args, argc);
+    long expected = stdrot_arg_integer(args, argc, 1);
+    long desired = stdrot_arg_integer(args, argc, 2);
+    bool swapped;
+    switch (ref.elem_size) {
+    case sizeof(int16_t): {
+        int16_t want = (int16_t)expected;
+        swapped = __atomic_compare_exchange_n((int16_t *)ref.data, &want, (int16_t)desired, false,
+                                              __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        break;
+    }
+    case sizeof(int32_t): {
+        int32_t want = (int32_t)expected;
+        swapped = __atomic_compare_exchange_n((int32_t *)ref.data, &want, (int32_t)desired, false,
+                                              __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        break;
+    }
+    default: {
+        int64_t want = expected;
+        swapped = __atomic_compare_exchange_n((int64_t *)ref.data, &want, (int64_t)desired, false,
+                                              __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+        break;
+    }
+    }
+    return (StdrotValue){STDROT_BOOL, {.b = swapped}};
+}
+
+/* atomic_load(var) */
+static StdrotValue stdrot_atomic_load(StdrotValue *args, int argc)
+{
+    StdrotArray ref = ref_arg(args, argc);
+#define LOAD(p) __atomic_load_n(p, __ATOMIC_SEQ_CST)
+    return int_value(ATOMIC_APPLY(ref, LOAD));
+#undef LOAD
+}
+
+/* atomic_store(var, value): returns value */
+static StdrotValue stdrot_atomic_store(StdrotValue *args, int argc)
+{
+    StdrotArray ref = ref_arg(args, argc);
+    long value = stdrot_arg_integer(args, argc, 1);
+#define STORE(p) (__atomic_store_n(p, value, __ATOMIC_SEQ_CST), value)
+    return int_value(ATOMIC_APPLY(ref, STORE));
+#undef STORE
+}
+
+STDROT_EXPORT_FLAGS("atomic_add", stdrot_atomic_add, ATOMIC_FLAGS);
+STDROT_EXPORT_FLAGS("atomic_cas", stdrot_atomic_cas,
+                    STDROT_TAKES_REF | STDROT_THREAD_SAFE | STDROT_RETURNS(STDROT_BOOL));
+STDROT_EXPORT_FLAGS("atomic_load", stdrot_atomic_load, ATOMIC_FLAGS);
+STDROT_EXPORT_FLAGS("atomic_store", stdrot_atomic_store, ATOMIC_FLAGS);
@@ -5,21 +5,22 @@
 // Raw bet function: assert that condition is true
 static void bet(int condition, const char *message) {
     if (!condition) {
-        fprintf(stderr, "Error: bet: assertion failed at line %d", g_exec_context.line_number);
+        fflush(g_exec_context.out);
+        fprintf(g_exec_context.err, "Error: bet: assertion failed at line %d", g_exec_context.line_number);
         
         if (message) {
-            fprintf(stderr, ": %s", message);
+            fprintf(g_exec_context.err, ": %s", message);
         }
-        fprintf(stderr, "\n");
-        exit(1);
+        fprintf(g_exec_context.err, "\n");
+        stdrot_exit(1);
     }
 }
 
 // Wrapper for dynamic dispatch
 StdrotValue stdrot_bet(StdrotValue *args, int argc) {
     if (argc < 1) {
-        fprintf(stderr, "Error: bet: requires at least 1 argument\n");
-        exit(1);
+        fprintf(g_exec_context.err, "Error: bet: requires at least 1 argument\n");
+        stdrot_exit(1);
     }
 
     // First argument is the condition
@@ -36,8 +37,9 @@ StdrotValue stdrot_bet(StdrotValue *args, int argc) {
 
     // Optional second argument is the message
     const char *message = NULL;
-    if (argc > 1 && args[1].type == STDROT_STRING) {
-        message = args[1].val.str.data;
+    String text;
+    if (argc > 1 && stdrot_as_string(&args[1], &text)) {
+        message = text.data;
     }
 
     bet(condition, message);
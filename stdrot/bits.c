@@ -0,0 +1,166 @@
+/* stdrot/bits.c – Bitset builtins over cap arrays for libstdrot.so
+ *
+ * Cap arrays are stored one bit per element (see StdrotArray), so these
+ * builtins work a 64-bit word at a time: counting uses popcount, searching
+ * uses count-trailing-zeros, and the logic operations combine 64 elements
+ * per instruction. Only the words at the ends of a range are masked.
+ */
+
+#include "args.h"
+#include <stdint.h>
+
+#define WORD_BITS 64
+
+/* args[index] as a bit-packed cap array */
+static StdrotArray bits_arg(const StdrotValue *args, int argc, int index)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, index);
+    if (arr.elem_type != STDROT_BOOL || arr.elem_size != 0) {
+        stdrot_arg_error("only cap arrays are supported");
+    }
+    return arr;
+}
+
+/* The bits of word w that fall inside [start, end) */
+static uint64_t range_mask(size_t w, size_t start, size_t end)
+{
+    size_t base = w * WORD_BITS;
+    size_t lo = start > base ? start - base : 0;
+    size_t hi = end - base < WORD_BITS ? end - base : WORD_BITS;
+    uint64_t below_hi = hi == WORD_BITS ? ~(uint64_t)0 : ((uint64_t)1 << hi) - 1;
+    return below_hi & ~(((uint64_t)1 << lo) - 1);
+}
+
+typedef enum { BITS_AND, BITS_OR, BITS_XOR } BitsOp;
+
+/* dst op= src over the optional range at args[2] */
+static void combine(StdrotValue *args, int argc, BitsOp op)
+{
+    StdrotArray dst = bits_arg(args, argc, 0);
+    StdrotArray src = bits_arg(args, argc, 1);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 2, dst.length, src.length, &start, &count);
+    if (count == 0) return;
+
+    uint64_t *d = dst.data;
+    const uint64_t *s = src.data;
+    size_t end = start + count;
+    for (size_t w = start / WORD_BITS; w <= (end - 1) / WORD_BITS; w++) {
+        uint64_t mask = range_mask(w, start, end);
+        uint64_t v;
+        switch (op) {
+        case BITS_AND: v = d[w] & s[w]; break;
+        case BITS_OR:  v = d[w] | s[w]; break;
+        default:       v = d[w] ^ s[w]; break;
+        }
+        d[w] = (d[w] & ~mask) | (v & mask);
+    }
+}
+
+/* ── Builtins ────────────────────────────────────────────────────────────── */
+
+/* bits_count(a[, start, count]): number of W elements */
+static StdrotValue stdrot_bits_count(StdrotValue *args, int argc)
+{
+    StdrotArray a = bits_arg(args, argc, 0);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 1, a.length, a.length, &start, &count);
+
+    const uint64_t *words = a.data;
+    size_t end = start + count;
+    long total = 0;
+    if (count > 0) {
+        for (size_t w = start / WORD_BITS; w <= (end - 1) / WORD_BITS; w++) {
+            total += __builtin_popcountll(words[w] & range_mask(w, start, end));
+        }
+    }
+    return (StdrotValue){STDROT_INT, {.i = (int)total}};
+}
+
+/* bits_next(a, from): index of the first W element at or after from, or -1
+ * if there is none */
+static StdrotValue stdrot_bits_next(StdrotValue *args, int argc)
+{
+    StdrotArray a = bits_arg(args, argc, 0);
+    long from = stdrot_arg_integer(args, argc, 1);
+    if (from < 0 || (size_t)from > a.length) stdrot_arg_error("index is out of bounds");
+
+    const uint64_t *words = a.data;
+    size_t nwords = (a.length + WORD_BITS - 1) / WORD_BITS;
+    size_t w = (size_t)from / WORD_BITS;
+    if (w < nwords) {
+        /* bits past the length are zero, so no end mask is needed */
+        uint64_t word = words[w] & (~(uint64_t)0 << (from % WORD_BITS));
+        for (;;) {
+            if (word) {
+                return (StdrotValue){STDROT_INT, {.i = (int)(w * WORD_BITS + __builtin_ctzll(word))}};
+            }
+            if (++w == nwords) break;
+            word = words[w];
+        }
+    }
+    return (StdrotValue){STDROT_INT, {.i = -1}};
+}
+
+/* bits_fill(a, value[, start, count]) */
+static StdrotValue stdrot_bits_fill(StdrotValue *args, int argc)
+{
+    StdrotArray a = bits_arg(args, argc, 0);
+    bool value = stdrot_arg_number(args, argc, 1) != 0;
+    size_t start, count;
+    stdrot_arg_range(args, argc, 2, a.length, a.length, &start, &count);
+    if (count == 0) return (StdrotValue){STDROT_NONE, {0}};
+
+    uint64_t *words = a.data;
+    size_t end = start + count;
+    for (size_t w = start / WORD_BITS; w <= (end - 1) / WORD_BITS; w++) {
+        uint64_t mask = range_mask(w, start, end);
+        words[w] = value ? words[w] | mask : words[w] & ~mask;
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* bits_not(a[, start, count]): flips every element */
+static StdrotValue stdrot_bits_not(StdrotValue *args, int argc)
+{
+    StdrotArray a = bits_arg(args, argc, 0);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 1, a.length, a.length, &start, &count);
+    if (count == 0) return (StdrotValue){STDROT_NONE, {0}};
+
+    uint64_t *words = a.data;
+    size_t end = start + count;
+    for (size_t w = start / WORD_BITS; w <= (end - 1) / WORD_BITS; w++) {
+        words[w] ^= range_mask(w, start, end);
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* bits_and(dst, src[, start, count]): dst = dst && src */
+static StdrotValue stdrot_bits_and(StdrotValue *args, int argc)
+{
+    combine(args, argc, BITS_AND);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* bits_or(dst, src[, start, count]): dst = dst || src */
+static StdrotValue stdrot_bits_or(StdrotValue *args, int argc)
+{
+    combine(args, argc, BITS_OR);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* bits_xor(dst, src[, start, count]): dst = dst != src */
+static StdrotValue stdrot_bits_xor(StdrotValue *args, int argc)
+{
+    combine(args, argc, BITS_XOR);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+STDROT_EXPORT_FLAGS("bits_count", stdrot_bits_count, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("bits_next", stdrot_bits_next, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("bits_fill", stdrot_bits_fill);
+STDROT_EXPORT("bits_not", stdrot_bits_not);
+STDROT_EXPORT("bits_and", stdrot_bits_and);
+STDROT_EXPORT("bits_or", stdrot_bits_or);
+STDROT_EXPORT("bits_xor", stdrot_bits_xor);
@@ -0,0 +1,146 @@
+/* stdrot/counter.c – Sharded counter builtins for libstdrot.so
+ *
+ *     rizz hist = counter_new(10);
+ *     squad flex (rizz i = 0; i < n; i++) {
+ *         counter_add(hist, v[i] % 10, 1);
+ *     }
+ *     counter_collect(totals, hist);
+ *
+ * A counter is a row of rizz bins, held by the program as a rizz handle,
+ * that many threads can add to at once without fighting over cache lines.
+ * Each thread adds to a shard of its own: a private copy of every bin,
+ * padded to whole cache lines. Reading a bin sums it over the shards, so
+ * adding is cheap and reading costs a pass over COUNTER_SHARDS copies.
+ */
+
+#include "args.h"
+#include "handles.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/* At least as many as the thread pool has threads (POOL_MAX_THREADS) */
+#define COUNTER_SHARDS 16
+#define CACHE_LINE 64
+
+typedef struct {
+    size_t bins;
+    size_t stride;      /* cells per shard, a multiple of a cache line */
+    long long *cells;   /* COUNTER_SHARDS shards of stride cells */
+} Counter;
+
+/* The calling thread's shard, handed out in turn on first use. initial-exec
+ * for the same reason as active_reader in lib/input.c. */
+static _Thread_local unsigned thread_shard __attribute__((tls_model("initial-exec")));
+static unsigned shards_handed_out;
+
+static long long *shard_of_thread(const Counter *c)
+{
+    if (thread_shard == 0) {
+        thread_shard = __atomic_add_fetch(&shards_handed_out, 1, __ATOMIC_RELAXED) % COUNTER_SHARDS + 1;
+    }
+    return c->cells + (thread_shard - 1) * c->stride;
+}
+
+static void counter_destroy(void *obj)
+{
+    Counter *c = obj;
+    free(c->cells);
+    free(c);
+}
+
+static long long bin_total(const Counter *c, size_t bin)
+{
+    long long total = 0;
+    for (size_t shard = 0; shard < COUNTER_SHARDS; shard++) {
+        total += __atomic_load_n(&c->cells[shard * c->stride + bin], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+/* args[index] as a bin of c */
+static size_t bin_arg(const Counter *c, const StdrotValue *args, int argc, int index)
+{
+    long bin = stdrot_arg_integer(args, argc, index);
+    if (bin < 0 || (size_t)bin >= c->bins) stdrot_arg_error("bin out of range");
+    return (size_t)bin;
+}
+
+/* ── Builtins ────────────────────────────────────────────────────────────── */
+
+/* counter_new([bins]): returns a handle to a counter of bins zeroed bins,
+ * one by default */
+static StdrotValue stdrot_counter_new(StdrotValue *args, int argc)
+{
+    long bins = argc > 0 ? stdrot_arg_integer(args, argc, 0) : 1;
+    if (bins < 1) stdrot_arg_error("a counter needs at least one bin");
+
+    const size_t per_line = CACHE_LINE / sizeof(long long);
+    Counter *c = calloc(1, sizeof(Counter));
+    if (!c) stdrot_arg_error("out of memory");
+    c->bins = (size_t)bins;
+    c->stride = (c->bins + per_line - 1) / per_line * per_line;
+    c->cells = aligned_alloc(CACHE_LINE, COUNTER_SHARDS * c->stride * sizeof(long long));
+    if (!c->cells) {
+        free(c);
+        stdrot_arg_error("out of memory");
+    }
+    for (size_t i = 0; i < COUNTER_SHARDS * c->stride; i++) c->cells[i] = 0;
+    return (StdrotValue){STDROT_INT, {.i = stdrot_handle_new(STDROT_HANDLE_COUNTER, c, counter_destroy)}};
+}
+
+/* counter_add(c, delta) or counter_add(c, bin, delta) */
+static StdrotValue stdrot_counter_add(StdrotValue *args, int argc)
+{
+    Counter *c = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_COUNTER);
+    size_t bin = argc > 2 ? bin_arg(c, args, argc, 1) : 0;
+    long delta = stdrot_arg_integer(args, argc, argc > 2 ? 2 : 1);
+    __atomic_fetch_add(&shard_of_thread(c)[bin], delta, __ATOMIC_RELAXED);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* counter_get(c[, bin]): the bin's total, bin 0 by default */
+static StdrotValue stdrot_counter_get(StdrotValue *args, int argc)
+{
+    Counter *c = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_COUNTER);
+    size_t bin = argc > 1 ? bin_arg(c, args, argc, 1) : 0;
+    return (StdrotValue){STDROT_INT, {.i = (int)bin_total(c, bin)}};
+}
+
+/* counter_collect(dst, c): dst[i] = the total of bin i, for every bin */
+static StdrotValue stdrot_counter_collect(StdrotValue *args, int argc)
+{
+    StdrotArray dst = stdrot_arg_array(args, argc, 0);
+    Counter *c = stdrot_arg_handle(args, argc, 1, STDROT_HANDLE_COUNTER);
+    if (dst.elem_type != STDROT_INT || dst.elem_size != sizeof(int)) {
+        stdrot_arg_error("only rizz arrays are supported");
+    }
+    if (dst.length < c->bins) stdrot_arg_error("array is shorter than the counter");
+    for (size_t bin = 0; bin < c->bins; bin++) {
+        ((int *)dst.data)[bin] = (int)bin_total(c, bin);
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* counter_clear(c): sets every bin back to zero */
+static StdrotValue stdrot_counter_clear(StdrotValue *args, int argc)
+{
+    Counter *c = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_COUNTER);
+    for (size_t i = 0; i < COUNTER_SHARDS * c->stride; i++) {
+        __atomic_store_n(&c->cells[i], 0, __ATOMIC_RELAXED);
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* counter_free(c) */
+static StdrotValue stdrot_counter_free(StdrotValue *args, int argc)
+{
+    stdrot_handle_free(args, argc, 0, STDROT_HANDLE_COUNTER);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+STDROT_EXPORT_FLAGS("counter_new", stdrot_counter_new, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("counter_add", stdrot_counter_add, STDROT_THREAD_SAFE);
+STDROT_EXPORT_FLAGS("counter_get", stdrot_counter_get, STDROT_THREAD_SAFE | STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("counter_collect", stdrot_counter_collect);
+STDROT_EXPORT("counter_clear", stdrot_counter_clear);
+STDROT_EXPORT("counter_free", stdrot_counter_free);
@@ -0,0 +1,164 @@
+/* stdrot/deque.c – Double-ended queue builtins for libstdrot.so
+ *
+ * A deque of rizz values in one ring buffer whose capacity is a power of
+ * two, held by the program as a rizz handle. Pushing at either end is
+ * amortized O(1): the buffer doubles when full and never shrinks until
+ * the deque is freed.
+ */
+
+#include "args.h"
+#include "handles.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DEQUE_MIN_CAPACITY 16
+
+typedef struct {
+    int *items;
+    size_t capacity; /* power of two */
+    size_t head;     /* index of the front element */
+    size_t size;
+} Deque;
+
+static void deque_destroy(void *obj)
+{
+    Deque *d = obj;
+    free(d->items);
+    free(d);
+}
+
+/* Unwraps the ring into a buffer twice the size */
+static void grow(Deque *d)
+{
+    size_t capacity = d->capacity * 2;
+    int *items = malloc(capacity * sizeof(int));
+    if (!items) stdrot_arg_error("out of memory");
+
+    size_t first = d->capacity - d->head < d->size ? d->capacity - d->head : d->size;
+    memcpy(items, d->items + d->head, first * sizeof(int));
+    memcpy(items + first, d->items, (d->size - first) * sizeof(int));
+    free(d->items);
+    d->items = items;
+    d->capacity = capacity;
+    d->head = 0;
+}
+
+static Deque *nonempty_arg(const StdrotValue *args, int argc)
+{
+    Deque *d = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_DEQUE);
+    if (d->size == 0) stdrot_arg_error("deque is empty");
+    return d;
+}
+
+static size_t back_index(const Deque *d)
+{
+    return (d->head + d->size - 1) & (d->capacity - 1);
+}
+
+/* ── Builtins ────────────────────────────────────────────────────────────── */
+
+/* deque_new(): returns a handle to an empty deque */
+static StdrotValue stdrot_deque_new(StdrotValue *args, int argc)
+{
+    (void)args;
+    (void)argc;
+    Deque *d = calloc(1, sizeof(Deque));
+    if (!d) stdrot_arg_error("out of memory");
+    d->items = malloc(DEQUE_MIN_CAPACITY * sizeof(int));
+    if (!d->items) {
+        free(d);
+        stdrot_arg_error("out of memory");
+    }
+    d->capacity = DEQUE_MIN_CAPACITY;
+    return (StdrotValue){STDROT_INT, {.i = stdrot_handle_new(STDROT_HANDLE_DEQUE, d, deque_destroy)}};
+}
+
+/* deque_push_back(d, value) */
+static StdrotValue stdrot_deque_push_back(StdrotValue *args, int argc)
+{
+    Deque *d = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_DEQUE);
+    int value = (int)stdrot_arg_integer(args, argc, 1);
+    if (d->size == d->capacity) grow(d);
+    d->items[(d->head + d->size) & (d->capacity - 1)] = value;
+    d->size++;
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* deque_push_front(d, value) */
+static StdrotValue stdrot_deque_push_front(StdrotValue *args, int argc)
+{
+    Deque *d = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_DEQUE);
+    int value = (int)stdrot_arg_integer(args, argc, 1);
+    if (d->size == d->capacity) grow(d);
+    d->head = (d->head - 1) & (d->capacity - 1);
+    d->items[d->head] = value;
+    d->size++;
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* deque_pop_front(d): removes and returns the front element */
+static StdrotValue stdrot_deque_pop_front(StdrotValue *args, int argc)
+{
+    Deque *d = nonempty_arg(args, argc);
+    int value = d->items[d->head];
+    d->head = (d->head + 1) & (d->capacity - 1);
+    d->size--;
+    return (StdrotValue){STDROT_INT, {.i = value}};
+}
+
+/* deque_pop_back(d): removes and returns the back element */
+static StdrotValue stdrot_deque_pop_back(StdrotValue *args, int argc)
+{
+    Deque *d = nonempty_arg(args, argc);
+    int value = d->items[back_index(d)];
+    d->size--;
+    return (StdrotValue){STDROT_INT, {.i = value}};
+}
+
+/* deque_peek_front(d) */
+static StdrotValue stdrot_deque_peek_front(StdrotValue *args, int argc)
+{
+    Deque *d = nonempty_arg(args, argc);
+    return (StdrotValue){STDROT_INT, {.i = d->items[d->head]}};
+}
+
+/* deque_peek_back(d) */
+static StdrotValue stdrot_deque_peek_back(StdrotValue *args, int argc)
+{
+    Deque *d = nonempty_arg(args, argc);
+    return (StdrotValue){STDROT_INT, {.i = d->items[back_index(d)]}};
+}
+
+/* deque_size(d) */
+static StdrotValue stdrot_deque_size(StdrotValue *args, int argc)
+{
+    Deque *d = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_DEQUE);
+    return (StdrotValue){STDROT_INT, {.i = (int)d->size}};
+}
+
+/* deque_clear(d): removes every element but keeps the allocated capacity */
+static StdrotValue stdrot_deque_clear(StdrotValue *args, int argc)
+{
+    Deque *d = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_DEQUE);
+    d->head = 0;
+    d->size = 0;
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* deque_free(d): releases the deque; the handle becomes invalid */
+static StdrotValue stdrot_deque_free(StdrotValue *args, int argc)
+{
+    stdrot_handle_free(args, argc, 0, STDROT_HANDLE_DEQUE);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+STDROT_EXPORT_FLAGS("deque_new", stdrot_deque_new, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("deque_push_back", stdrot_deque_push_back);
+STDROT_EXPORT("deque_push_front", stdrot_deque_push_front);
+STDROT_EXPORT_FLAGS("deque_pop_front", stdrot_deque_pop_front, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("deque_pop_back", stdrot_deque_pop_back, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("deque_peek_front", stdrot_deque_peek_front, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("deque_peek_back", stdrot_deque_peek_back, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("deque_size", stdrot_deque_size, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("deque_clear", stdrot_deque_clear);
+STDROT_EXPORT("deque_free", stdrot_deque_free);
@@ -0,0 +1,345 @@
+/* stdrot/format.c – Format string compiler and printer for libstdrot.so
+ *
+ * A format is compiled once into StdrotFormatOps: literal spans that are
+ * copied as-is and conversions that already know which StdrotValue types
+ * they accept. Printing then walks the ops without re-parsing anything and
+ * renders into a local buffer that is handed to stdio in large chunks.
+ */
+
+#include "format.h"
+#include "numfmt.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ── Compiler ────────────────────────────────────────────────────────────── */
+
+static StdrotFormatKind format_kind(char conv)
+{
+    if (conv == 'b') return STDROT_FMT_BOOL;
+    if (conv == 'c') return STDROT_FMT_CHAR;
+    if (conv == 's') return STDROT_FMT_STRING;
+    if (strchr("diouxX", conv)) return STDROT_FMT_INT;
+    if (strchr("fFeEgGaA", conv)) return STDROT_FMT_FLOAT;
+    return STDROT_FMT_SKIP;
+}
+
+/* Reads flags, width and precision back out of a normalized spec so the
+ * printer can take its own fast paths. Anything unusual is left to printf. */
+static void format_parse_spec(StdrotFormatOp *op, bool had_star)
+{
+    const char *s = op->spec + 1;
+
+    op->flags = had_star ? STDROT_FMT_COMPLEX : 0;
+    op->width = -1;
+    op->precision = -1;
+
+    for (;; s++) {
+        if (*s == '-') op->flags |= STDROT_FMT_LEFT;
+        else if (*s == '0') op->flags |= STDROT_FMT_ZERO;
+        else if (*s == '+' || *s == ' ') op->flags |= STDROT_FMT_SIGN;
+        else if (*s == '#') op->flags |= STDROT_FMT_ALT;
+        else break;
+    }
+    if (*s >= '1' && *s <= '9') {
+        int width = 0;
+        while (*s >= '0' && *s <= '9') width = width * 10 + (*s++ - '0');
+        op->width = (short)(width > 4096 ? 4096 : width);
+    }
+    if (*s == '.') {
+        int precision = 0;
+        s++;
+        while (*s >= '0' && *s <= '9') precision = precision * 10 + (*s++ - '0');
+        op->precision = (short)(precision > 4096 ? 4096 : precision);
+    }
+    if (*s != op->conv) op->flags |= STDROT_FMT_COMPLEX;
+}
+
+int stdrot_format_compile(String fmt, StdrotFormatOp *ops, int capacity, int *arg_count)
+{
+    const char *p = fmt.data;
+    /* a char array may be filled to the brim without a terminator */
+    const char *end = fmt.data ? fmt.data + strnlen(fmt.data, fmt.len) : NULL;
+    int count = 0;
+    int args = 0;
+
+    while (p && p < end) {
+        StdrotFormatOp op;
+        memset(&op, 0, sizeof(op));
+        op.kind = STDROT_FMT_LITERAL;
+        op.text = p;
+
+        if (*p != '%') {
+            while (p < end && *p != '%') p++;
+        } else if (p + 1 < end && p[1] == '%') {
+            op.text = p + 1; /* "%%" prints a single '%' */
+            p += 2;
+            op.len = 1;
+        } else {
+            /* flags, width, precision */
+            const char *q = p + 1;
+            size_t n = 0;
+            bool had_star = false;
+            op.spec[n++] = '%';
+            while (q < end && strchr("-+ #0123456789.*", *q)) {
+                if (*q == '*') had_star = true;
+                else if (n < sizeof(op.spec) - 4) op.spec[n++] = *q;
+                q++;
+            }
+
+            /* length modifiers: h/hh are kept for integers, the rest are
+             * dropped because arguments are always passed at their real type */
+            const char *len_mod = q;
+            if (q < end && (*q == 'h' || *q == 'l')) {
+                q++;
+                if (q < end && *q == *len_mod) q++;
+            } else if (q < end && strchr("jztL", *q)) {
+                q++;
+            }
+
+            if (q >= end) {
+                p = end; /* dangling '%...' is printed as written */
+            } else {
+                op.kind = format_kind(*q);
+                if (op.kind == STDROT_FMT_INT && *len_mod == 'h') {
+                    for (const char *m = len_mod; m < q; m++) op.spec[n++] = *m;
+                }
+                op.spec[n++] = *q;
+                op.spec[n] = '\0';
+                op.conv = *q;
+                format_parse_spec(&op, had_star);
+                p = q + 1;
+                args++;
+            }
+        }
+
+        if (op.len == 0) op.len = (size_t)(p - op.text);
+
+        if (count < capacity) ops[count] = op;
+        count++;
+    }
+
+    if (arg_count) *arg_count = args;
+    return count;
+}
+
+/* ── Output sink ─────────────────────────────────────────────────────────── */
+
+typedef struct {
+    FILE *out;
+    size_t len;
+    char buf[4096];
+} FormatSink;
+
+static void sink_flush(FormatSink *sink)
+{
+    if (sink->len) fwrite(sink->buf, 1, sink->len, sink->out);
+    sink->len = 0;
+}
+
+static void sink_write(FormatSink *sink, const char *data, size_t n)
+{
+    if (n > sizeof(sink->buf) - sink->len) {
+        sink_flush(sink);
+        if (n > sizeof(sink->buf)) {
+            fwrite(data, 1, n, sink->out);
+            return;
+        }
+    }
+    memcpy(sink->buf + sink->len, data, n);
+    sink->len += n;
+}
+
+static void sink_putc(FormatSink *sink, char c)
+{
+    if (sink->len == sizeof(sink->buf)) sink_flush(sink);
+    sink->buf[sink->len++] = c;
+}
+
+__attribute__((format(printf, 2, 3)))
+static void sink_printf(FormatSink *sink, const char *spec, ...)
+{
+    va_list ap;
+    size_t room = sizeof(sink->buf) - sink->len;
+
+    va_start(ap, spec);
+    int n = vsnprintf(sink->buf + sink->len, room, spec, ap);
+    va_end(ap);
+    if (n < 0) return;
+
+    if ((size_t)n < room) {
+        sink->len += (size_t)n;
+        return;
+    }
+
+    /* Did not fit: make room, or bypass the buffer for huge conversions */
+    sink_flush(sink);
+    va_start(ap, spec);
+    if ((size_t)n < sizeof(sink->buf)) {
+        sink->len = (size_t)vsnprintf(sink->buf, sizeof(sink->buf), spec, ap);
+    } else {
+        vfprintf(sink->out, spec, ap);
+    }
+    va_end(ap);
+}
+
+/* Writes `len` bytes of `digits` padded to the op's width */
+static void sink_padded(FormatSink *sink, const StdrotFormatOp *op, const char *digits, size_t len)
+{
+    size_t width = op->width > 0 ? (size_t)op->width : 0;
+    size_t pad = width > len ? width - len : 0;
+
+    if (op->flags & STDROT_FMT_LEFT) {
+        sink_write(sink, digits, len);
+        while (pad--) sink_putc(sink, ' ');
+    } else if (op->flags & STDROT_FMT_ZERO) {
+        if (len && digits[0] == '-') {
+            sink_putc(sink, '-');
+            digits++;
+            len--;
+        }
+        while (pad--) sink_putc(sink, '0');
+        sink_write(sink, digits, len);
+    } else {
+        while (pad--) sink_putc(sink, ' ');
+        sink_write(sink, digits, len);
+    }
+}
+
+/* %d %i %u with at most '-'/'0' and a width; returns false to use printf */
+static bool format_int_fast(FormatSink *sink, const StdrotFormatOp *op, int value)
+{
+    char digits[24];
+    size_t len = 0;
+
+    if ((op->flags & ~(STDROT_FMT_LEFT | STDROT_FMT_ZERO)) || op->precision >= 0) return false;
+
+    if (op->conv == 'u') {
+        len = stdrot_format_u64(digits, (unsigned int)value);
+    } else if (op->conv == 'd' || op->conv == 'i') {
+        uint64_t magnitude = value < 0 ? (uint64_t)0 - (uint64_t)(int64_t)value : (uint64_t)value;
+        if (value < 0) digits[len++] = '-';
+        len += stdrot_format_u64(digits + len, magnitude);
+    } else {
+        return false;
+    }
+
+    sink_padded(sink, op, digits, len);
+    return true;
+}
+
+/* %f / %.Nf without flags or width; returns false to use printf */
+static bool format_double_fast(FormatSink *sink, const StdrotFormatOp *op, double value)
+{
+    char digits[STDROT_NUMFMT_MAX];
+
+    if (op->flags || op->width >= 0 || (op->conv != 'f' && op->conv != 'F')) return false;
+
+    int len = stdrot_format_fixed(digits, value, op->precision < 0 ? 6 : op->precision);
+    if (len < 0) return false;
+    sink_write(sink, digits, (size_t)len);
+    return true;
+}
+
+/* ── Printer ─────────────────────────────────────────────────────────────── */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+
+static void format_run(FormatSink *sink, const StdrotFormat *format,
+                       const StdrotValue *args, int arg_count)
+{
+    int arg_idx = 0;
+
+    for (int i = 0; i < format->op_count; i++) {
+        const StdrotFormatOp *op = &format->ops[i];
+
+        if (op->kind == STDROT_FMT_LITERAL) {
+            sink_write(sink, op->text, op->len);
+            continue;
+        }
+
+        /* Conversions without a matching argument are printed as written */
+        if (arg_idx >= arg_count) {
+            sink_write(sink, op->text, op->len);
+            continue;
+        }
+
+        const StdrotValue *arg = &args[arg_idx++];
+        switch (op->kind) {
+        case STDROT_FMT_BOOL: {
+            bool b = false;
+            if (arg->type == STDROT_BOOL) b = arg->val.b;
+            else if (arg->type == STDROT_INT) b = (arg->val.i != 0);
+            else if (arg->type == STDROT_SHORT) b = (arg->val.s != 0);
+            sink_putc(sink, b ? 'W' : 'L');
+            break;
+        }
+        case STDROT_FMT_INT: {
+            int value;
+            if (arg->type == STDROT_INT) value = arg->val.i;
+            else if (arg->type == STDROT_SHORT) value = arg->val.s;
+            else if (arg->type == STDROT_BOOL) value = arg->val.b;
+            else break;
+            if (!format_int_fast(sink, op, value)) sink_printf(sink, op->spec, value);
+            break;
+        }
+        case STDROT_FMT_FLOAT: {
+            double value;
+            if (arg->type == STDROT_FLOAT) value = arg->val.f;
+            else if (arg->type == STDROT_DOUBLE) value = arg->val.d;
+            else break;
+            if (!format_double_fast(sink, op, value)) sink_printf(sink, op->spec, value);
+            break;
+        }
+        case STDROT_FMT_CHAR:
+            if (arg->type == STDROT_CHAR) sink_putc(sink, arg->val.c);
+            else if (arg->type == STDROT_INT) sink_putc(sink, (char)arg->val.i);
+            break;
+        case STDROT_FMT_STRING: {
+            String text;
+            if (!stdrot_as_string(arg, &text)) break;
+            /* a char array may be filled to the brim without a terminator */
+            sink_write(sink, text.data, arg->type == STDROT_ARRAY ? strnlen(text.data, text.len)
+                                                                   : strlen(text.data));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+#pragma GCC diagnostic pop
+
+void stdrot_format_print(FILE *out, const StdrotValue *format,
+                         const StdrotValue *args, int arg_count, bool newline)
+{
+    FormatSink sink;
+    String text;
+    sink.out = out;
+    sink.len = 0;
+
+    if (format->type == STDROT_FORMAT && format->val.fmt) {
+        format_run(&sink, format->val.fmt, args, arg_count);
+    } else if (stdrot_as_string(format, &text)) {
+        /* Not known at analysis time (e.g. baka, or a char array format) */
+        StdrotFormatOp local_ops[32];
+        StdrotFormat compiled = { local_ops, 0, 0 };
+        int needed = stdrot_format_compile(text, local_ops, 32, &compiled.arg_count);
+        StdrotFormatOp *heap_ops = NULL;
+
+        if (needed > 32) {
+            heap_ops = malloc((size_t)needed * sizeof(StdrotFormatOp));
+            if (!heap_ops) return;
+            stdrot_format_compile(text, heap_ops, needed, NULL);
+            compiled.ops = heap_ops;
+        }
+        compiled.op_count = needed;
+        format_run(&sink, &compiled, args, arg_count);
+        free(heap_ops);
+    }
+
+    if (newline) sink_putc(&sink, '\n');
+    sink_flush(&sink);
+}
@@ -0,0 +1,20 @@
+/* stdrot/format.h – Format engine shared by yapping, yappin and baka
+ *
+ * Internal to libstdrot.so. The compiler half (stdrot_format_compile) is
+ * part of the public API in stdrot_api.h so the host can precompile
+ * string-literal formats during semantic analysis.
+ */
+
+#ifndef STDROT_FORMAT_H
+#define STDROT_FORMAT_H
+
+#include "stdrot_api.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Prints `format` (STDROT_FORMAT or STDROT_STRING) with `args` to `out`,
+ * optionally followed by a newline. */
+void stdrot_format_print(FILE *out, const StdrotValue *format,
+                         const StdrotValue *args, int arg_count, bool newline);
+
+#endif /* STDROT_FORMAT_H */
@@ -0,0 +1,86 @@
+/* stdrot/handles.c – Integer handles for builtin-owned objects */
+
+#include "handles.h"
+#include "args.h"
+#include <stdlib.h>
+
+typedef struct {
+    StdrotHandleKind kind; /* 0 for a free slot */
+    void *obj;
+    void (*destroy)(void *);
+} HandleSlot;
+
+/* One table per running program, kept in its ExecutionContext */
+typedef struct {
+    HandleSlot *slots;
+    int count;
+    int capacity;
+} HandleTable;
+
+static HandleTable *current_table(void)
+{
+    HandleTable *table = g_exec_context.handles;
+    if (!table) {
+        table = calloc(1, sizeof(HandleTable));
+        if (!table) stdrot_arg_error("out of memory");
+        g_exec_context.handles = table;
+    }
+    return table;
+}
+
+int stdrot_handle_new(StdrotHandleKind kind, void *obj, void (*destroy)(void *))
+{
+    HandleTable *table = current_table();
+    int index = 0;
+    while (index < table->count && table->slots[index].kind) index++;
+
+    if (index == table->capacity) {
+        int capacity = table->capacity ? table->capacity * 2 : 16;
+        HandleSlot *grown = realloc(table->slots, (size_t)capacity * sizeof(HandleSlot));
+        if (!grown) {
+            destroy(obj);
+            stdrot_arg_error("out of memory");
+        }
+        table->slots = grown;
+        table->capacity = capacity;
+    }
+    if (index == table->count) table->count++;
+
+    table->slots[index] = (HandleSlot){ kind, obj, destroy };
+    return index + 1;
+}
+
+/* Only reads the table: squad flex workers look handles up concurrently */
+static HandleSlot *lookup(const StdrotValue *args, int argc, int index, StdrotHandleKind kind)
+{
+    HandleTable *table = g_exec_context.handles;
+    long handle = stdrot_arg_integer(args, argc, index);
+    if (!table || handle < 1 || handle > table->count || table->slots[handle - 1].kind != kind) {
+        stdrot_arg_error("invalid handle");
+    }
+    return &table->slots[handle - 1];
+}
+
+void *stdrot_arg_handle(const StdrotValue *args, int argc, int index, StdrotHandleKind kind)
+{
+    return lookup(args, argc, index, kind)->obj;
+}
+
+void stdrot_handle_free(const StdrotValue *args, int argc, int index, StdrotHandleKind kind)
+{
+    HandleSlot *slot = lookup(args, argc, index, kind);
+    slot->destroy(slot->obj);
+    *slot = (HandleSlot){ 0, NULL, NULL };
+}
+
+void stdrot_release_handles(ExecutionContext *ctx)
+{
+    HandleTable *table = ctx->handles;
+    if (!table) return;
+    for (int i = 0; i < table->count; i++) {
+        if (table->slots[i].kind) table->slots[i].destroy(table->slots[i].obj);
+    }
+    free(table->slots);
+    free(table);
+    ctx->handles = NULL;
+}
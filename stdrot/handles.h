@@ -0,0 +1,35 @@
+/* stdrot/handles.h – Integer handles for builtin-owned objects
+ *
+ * Internal to libstdrot.so. Containers such as maps, deques and heaps live
+ * in C memory; the program only holds a rizz handle to them. Handles start
+ * at 1 and are reused after the object is freed, so 0 never names a live
+ * object. Each program has its own handles, and the objects it never frees
+ * are destroyed when it finishes (see stdrot_release()).
+ */
+
+#ifndef STDROT_HANDLES_H
+#define STDROT_HANDLES_H
+
+#include "stdrot_api.h"
+
+typedef enum {
+    STDROT_HANDLE_MAP = 1,
+    STDROT_HANDLE_DEQUE,
+    STDROT_HANDLE_HEAP,
+    STDROT_HANDLE_COUNTER,
+} StdrotHandleKind;
+
+/* Registers obj, to be released with destroy(obj), and returns its handle */
+int stdrot_handle_new(StdrotHandleKind kind, void *obj, void (*destroy)(void *));
+
+/* The object behind args[index]; a stale handle or one of another kind is
+ * reported as an argument error */
+void *stdrot_arg_handle(const StdrotValue *args, int argc, int index, StdrotHandleKind kind);
+
+/* Destroys the object behind args[index] and invalidates the handle */
+void stdrot_handle_free(const StdrotValue *args, int argc, int index, StdrotHandleKind kind);
+
+/* Destroys every object the program behind ctx still holds */
+void stdrot_release_handles(ExecutionContext *ctx);
+
+#endif /* STDROT_HANDLES_H */
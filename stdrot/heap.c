@@ -0,0 +1,165 @@
+/* stdrot/heap.c – Priority queue builtins for libstdrot.so
+ *
+ * A min-heap of (priority, value) pairs, with gigachad priorities and rizz
+ * values, held by the program as a rizz handle. It is a 4-ary heap in one
+ * growable array: half as deep as a binary heap, with the children of a
+ * node next to each other in memory. That suits push-heavy searches such
+ * as Dijkstra, where many pushed entries are never popped.
+ */
+
+#include "args.h"
+#include "handles.h"
+#include <stdlib.h>
+
+#define HEAP_ARITY 4
+#define HEAP_MIN_CAPACITY 16
+
+typedef struct {
+    double priority;
+    int value;
+} HeapEntry;
+
+typedef struct {
+    HeapEntry *entries;
+    size_t capacity;
+    size_t size;
+} Heap;
+
+static void heap_destroy(void *obj)
+{
+    Heap *h = obj;
+    free(h->entries);
+    free(h);
+}
+
+static void sift_up(HeapEntry *e, size_t i)
+{
+    HeapEntry moving = e[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / HEAP_ARITY;
+        if (!(moving.priority < e[parent].priority)) break;
+        e[i] = e[parent];
+        i = parent;
+    }
+    e[i] = moving;
+}
+
+static void sift_down(HeapEntry *e, size_t n, size_t i)
+{
+    HeapEntry moving = e[i];
+    for (;;) {
+        size_t first = i * HEAP_ARITY + 1;
+        if (first >= n) break;
+        size_t last = first + HEAP_ARITY < n ? first + HEAP_ARITY : n;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; c++) {
+            if (e[c].priority < e[best].priority) best = c;
+        }
+        if (!(e[best].priority < moving.priority)) break;
+        e[i] = e[best];
+        i = best;
+    }
+    e[i] = moving;
+}
+
+static Heap *nonempty_arg(const StdrotValue *args, int argc)
+{
+    Heap *h = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_HEAP);
+    if (h->size == 0) stdrot_arg_error("heap is empty");
+    return h;
+}
+
+/* ── Builtins ────────────────────────────────────────────────────────────── */
+
+/* heap_new(): returns a handle to an empty heap */
+static StdrotValue stdrot_heap_new(StdrotValue *args, int argc)
+{
+    (void)args;
+    (void)argc;
+    Heap *h = calloc(1, sizeof(Heap));
+    if (!h) stdrot_arg_error("out of memory");
+    h->entries = malloc(HEAP_MIN_CAPACITY * sizeof(HeapEntry));
+    if (!h->entries) {
+        free(h);
+        stdrot_arg_error("out of memory");
+    }
+    h->capacity = HEAP_MIN_CAPACITY;
+    return (StdrotValue){STDROT_INT, {.i = stdrot_handle_new(STDROT_HANDLE_HEAP, h, heap_destroy)}};
+}
+
+/* heap_push(h, priority, value) */
+static StdrotValue stdrot_heap_push(StdrotValue *args, int argc)
+{
+    Heap *h = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_HEAP);
+    double priority = stdrot_arg_number(args, argc, 1);
+    int value = (int)stdrot_arg_integer(args, argc, 2);
+    if (priority != priority) stdrot_arg_error("priority is NaN");
+
+    if (h->size == h->capacity) {
+        HeapEntry *grown = realloc(h->entries, h->capacity * 2 * sizeof(HeapEntry));
+        if (!grown) stdrot_arg_error("out of memory");
+        h->entries = grown;
+        h->capacity *= 2;
+    }
+    h->entries[h->size] = (HeapEntry){ priority, value };
+    sift_up(h->entries, h->size++);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* heap_pop(h): removes the entry with the lowest priority and returns its
+ * value */
+static StdrotValue stdrot_heap_pop(StdrotValue *args, int argc)
+{
+    Heap *h = nonempty_arg(args, argc);
+    int value = h->entries[0].value;
+    if (--h->size > 0) {
+        h->entries[0] = h->entries[h->size];
+        sift_down(h->entries, h->size, 0);
+    }
+    return (StdrotValue){STDROT_INT, {.i = value}};
+}
+
+/* heap_peek(h): value of the entry with the lowest priority */
+static StdrotValue stdrot_heap_peek(StdrotValue *args, int argc)
+{
+    Heap *h = nonempty_arg(args, argc);
+    return (StdrotValue){STDROT_INT, {.i = h->entries[0].value}};
+}
+
+/* heap_peek_priority(h): the lowest priority */
+static StdrotValue stdrot_heap_peek_priority(StdrotValue *args, int argc)
+{
+    Heap *h = nonempty_arg(args, argc);
+    return (StdrotValue){STDROT_DOUBLE, {.d = h->entries[0].priority}};
+}
+
+/* heap_size(h) */
+static StdrotValue stdrot_heap_size(StdrotValue *args, int argc)
+{
+    Heap *h = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_HEAP);
+    return (StdrotValue){STDROT_INT, {.i = (int)h->size}};
+}
+
+/* heap_clear(h): removes every entry but keeps the allocated capacity */
+static StdrotValue stdrot_heap_clear(StdrotValue *args, int argc)
+{
+    Heap *h = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_HEAP);
+    h->size = 0;
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* heap_free(h): releases the heap; the handle becomes invalid */
+static StdrotValue stdrot_heap_free(StdrotValue *args, int argc)
+{
+    stdrot_handle_free(args, argc, 0, STDROT_HANDLE_HEAP);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+STDROT_EXPORT_FLAGS("heap_new", stdrot_heap_new, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("heap_push", stdrot_heap_push);
+STDROT_EXPORT_FLAGS("heap_pop", stdrot_heap_pop, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("heap_peek", stdrot_heap_peek, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("heap_peek_priority", stdrot_heap_peek_priority, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_DOUBLE));
+STDROT_EXPORT_FLAGS("heap_size", stdrot_heap_size, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("heap_clear", stdrot_heap_clear);
+STDROT_EXPORT("heap_free", stdrot_heap_free);
@@ -0,0 +1,372 @@
+/* stdrot/kernels.c – Vectorized loops over rizz and gigachad arrays
+ *
+ * The SSE2 and AVX2 variants are generated from the same macro body with
+ * the vector width and intrinsics as parameters, and compiled with a
+ * per-function target attribute so the library itself still runs on any
+ * x86-64 (or non-x86) machine. See kernels.h for the contract.
+ */
+
+#include "kernels.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STDROT_KERNELS_X86 1
+#endif
+
+/* ── Shared helpers ──────────────────────────────────────────────────────── */
+
+/* First index holding m, the minimum or maximum found by a kernel */
+static size_t find_first_d(const double *a, size_t n, double m)
+{
+    if (m != m) return 0; /* only a[0] can seed a NaN */
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] == m) return i;
+    }
+    return 0;
+}
+
+static size_t find_first_i(const int *a, size_t n, int m)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] == m) return i;
+    }
+    return 0;
+}
+
+/* ── Scalar ──────────────────────────────────────────────────────────────── */
+
+static double sum_d_scalar(const double *a, size_t n)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < n; i++) s += a[i];
+    return s;
+}
+
+static double dot_d_scalar(const double *a, const double *b, size_t n)
+{
+    double s = 0.0;
+    for (size_t i = 0; i < n; i++) s += a[i] * b[i];
+    return s;
+}
+
+static void scale_d_scalar(double *a, double k, size_t n)
+{
+    for (size_t i = 0; i < n; i++) a[i] *= k;
+}
+
+static void axpy_d_scalar(double *y, double alpha, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] += alpha * x[i];
+}
+
+static size_t argmin_d_scalar(const double *a, size_t n)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] < a[best]) best = i;
+    }
+    return best;
+}
+
+static size_t argmax_d_scalar(const double *a, size_t n)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] > a[best]) best = i;
+    }
+    return best;
+}
+
+static int sum_i_scalar(const int *a, size_t n)
+{
+    unsigned s = 0;
+    for (size_t i = 0; i < n; i++) s += (unsigned)a[i];
+    return (int)s;
+}
+
+static int dot_i_scalar(const int *a, const int *b, size_t n)
+{
+    unsigned s = 0;
+    for (size_t i = 0; i < n; i++) s += (unsigned)a[i] * (unsigned)b[i];
+    return (int)s;
+}
+
+static void scale_i_scalar(int *a, int k, size_t n)
+{
+    for (size_t i = 0; i < n; i++) a[i] = (int)((unsigned)a[i] * (unsigned)k);
+}
+
+static void axpy_i_scalar(int *y, int alpha, const int *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = (int)((unsigned)y[i] + (unsigned)alpha * (unsigned)x[i]);
+}
+
+static size_t argmin_i_scalar(const int *a, size_t n)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] < a[best]) best = i;
+    }
+    return best;
+}
+
+static size_t argmax_i_scalar(const int *a, size_t n)
+{
+    size_t best = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (a[i] > a[best]) best = i;
+    }
+    return best;
+}
+
+static const StdrotKernels scalar_kernels = {
+    "scalar",
+    sum_d_scalar, dot_d_scalar, scale_d_scalar, axpy_d_scalar, argmin_d_scalar, argmax_d_scalar,
+    sum_i_scalar, dot_i_scalar, scale_i_scalar, axpy_i_scalar, argmin_i_scalar, argmax_i_scalar
+};
+
+#ifdef STDROT_KERNELS_X86
+
+/* ── SIMD bodies ─────────────────────────────────────────────────────────── *
+ * W is the number of lanes. Sums run two accumulators to hide add latency.
+ * min/max pass the running extreme as the second operand, which is what
+ * the instructions return when the loaded element is NaN.
+ */
+
+#define KERNEL_TARGET(isa) __attribute__((target(#isa)))
+
+#define DEFINE_DOUBLE_KERNELS(isa, vec, W, load, store, set1, zero, add, mul, vmin, vmax)    \
+    KERNEL_TARGET(isa) static double sum_d_##isa(const double *a, size_t n)                 \
+    {                                                                                       \
+        vec s0 = zero(), s1 = zero();                                                       \
+        double lanes[W], s = 0.0;                                                           \
+        size_t i = 0;                                                                       \
+        for (; i + 2 * W <= n; i += 2 * W) {                                                \
+            s0 = add(s0, load(a + i));                                                      \
+            s1 = add(s1, load(a + i + W));                                                  \
+        }                                                                                   \
+        store(lanes, add(s0, s1));                                                          \
+        for (int l = 0; l < W; l++) s += lanes[l];                                          \
+        for (; i < n; i++) s += a[i];                                                       \
+        return s;                                                                           \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static double dot_d_##isa(const double *a, const double *b, size_t n) \
+    {                                                                                       \
+        vec s0 = zero(), s1 = zero();                                                       \
+        double lanes[W], s = 0.0;                                                           \
+        size_t i = 0;                                                                       \
+        for (; i + 2 * W <= n; i += 2 * W) {                                                \
+            s0 = add(s0, mul(load(a + i), load(b + i)));                                    \
+            s1 = add(s1, mul(load(a + i + W), load(b + i + W)));                            \
+        }                                                                                   \
+        store(lanes, add(s0, s1));                                                          \
+        for (int l = 0; l < W; l++) s += lanes[l];                                          \
+        for (; i < n; i++) s += a[i] * b[i];                                                \
+        return s;                                                                           \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static void scale_d_##isa(double *a, double k, size_t n)             \
+    {                                                                                       \
+        vec vk = set1(k);                                                                   \
+        size_t i = 0;                                                                       \
+        for (; i + W <= n; i += W) store(a + i, mul(load(a + i), vk));                      \
+        for (; i < n; i++) a[i] *= k;                                                       \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static void axpy_d_##isa(double *y, double alpha, const double *x, size_t n) \
+    {                                                                                       \
+        vec va = set1(alpha);                                                               \
+        size_t i = 0;                                                                       \
+        for (; i + W <= n; i += W) store(y + i, add(load(y + i), mul(va, load(x + i))));    \
+        for (; i < n; i++) y[i] += alpha * x[i];                                            \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static size_t argmin_d_##isa(const double *a, size_t n)              \
+    {                                                                                       \
+        double m = a[0], lanes[W];                                                          \
+        size_t i = 0;                                                                       \
+        if (n >= W) {                                                                       \
+            vec vm = set1(m);                                                               \
+            for (; i + W <= n; i += W) vm = vmin(load(a + i), vm);                          \
+            store(lanes, vm);                                                               \
+            for (int l = 0; l < W; l++) if (lanes[l] < m) m = lanes[l];                     \
+        }                                                                                   \
+        for (; i < n; i++) if (a[i] < m) m = a[i];                                          \
+        return find_first_d(a, n, m);                                                       \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static size_t argmax_d_##isa(const double *a, size_t n)              \
+    {                                                                                       \
+        double m = a[0], lanes[W];                                                          \
+        size_t i = 0;                                                                       \
+        if (n >= W) {                                                                       \
+            vec vm = set1(m);                                                               \
+            for (; i + W <= n; i += W) vm = vmax(load(a + i), vm);                          \
+            store(lanes, vm);                                                               \
+            for (int l = 0; l < W; l++) if (lanes[l] > m) m = lanes[l];                     \
+        }                                                                                   \
+        for (; i < n; i++) if (a[i] > m) m = a[i];                                          \
+        return find_first_d(a, n, m);                                                       \
+    }
+
+#define DEFINE_INT_KERNELS(isa, vec, W, load, store, set1, zero, add, mullo, vmin, vmax)     \
+    KERNEL_TARGET(isa) static int sum_i_##isa(const int *a, size_t n)                       \
+    {                                                                                       \
+        vec s = zero();                                                                     \
+        int lanes[W];                                                                       \
+        unsigned total = 0;                                                                 \
+        size_t i = 0;                                                                       \
+        for (; i + W <= n; i += W) s = add(s, load(a + i));                                 \
+        store(lanes, s);                                                                    \
+        for (int l = 0; l < W; l++) total += (unsigned)lanes[l];                            \
+        for (; i < n; i++) total += (unsigned)a[i];                                         \
+        return (int)total;                                                                  \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static int dot_i_##isa(const int *a, const int *b, size_t n)         \
+    {                                                                                       \
+        vec s = zero();                                                                     \
+        int lanes[W];                                                                       \
+        unsigned total = 0;                                                                 \
+        size_t i = 0;                                                                       \
+        for (; i + W <= n; i += W) s = add(s, mullo(load(a + i), load(b + i)));             \
+        store(lanes, s);                                                                    \
+        for (int l = 0; l < W; l++) total += (unsigned)lanes[l];                            \
+        for (; i < n; i++) total += (unsigned)a[i] * (unsigned)b[i];                        \
+        return (int)total;                                                                  \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static void scale_i_##isa(int *a, int k, size_t n)                   \
+    {                                                                                       \
+        vec vk = set1(k);                                                                   \
+        size_t i = 0;                                                                       \
+        for (; i + W <= n; i += W) store(a + i, mullo(load(a + i), vk));                    \
+        for (; i < n; i++) a[i] = (int)((unsigned)a[i] * (unsigned)k);                      \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static void axpy_i_##isa(int *y, int alpha, const int *x, size_t n)  \
+    {                                                                                       \
+        vec va = set1(alpha);                                                               \
+        size_t i = 0;                                                                       \
+        for (; i + W <= n; i += W) store(y + i, add(load(y + i), mullo(va, load(x + i))));  \
+        for (; i < n; i++) y[i] = (int)((unsigned)y[i] + (unsigned)alpha * (unsigned)x[i]); \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static size_t argmin_i_##isa(const int *a, size_t n)                 \
+    {                                                                                       \
+        int m = a[0], lanes[W];                                                             \
+        size_t i = 0;                                                                       \
+        if (n >= W) {                                                                       \
+            vec vm = set1(m);                                                               \
+            for (; i + W <= n; i += W) vm = vmin(load(a + i), vm);                          \
+            store(lanes, vm);                                                               \
+            for (int l = 0; l < W; l++) if (lanes[l] < m) m = lanes[l];                     \
+        }                                                                                   \
+        for (; i < n; i++) if (a[i] < m) m = a[i];                                          \
+        return find_first_i(a, n, m);                                                       \
+    }                                                                                       \
+    KERNEL_TARGET(isa) static size_t argmax_i_##isa(const int *a, size_t n)                 \
+    {                                                                                       \
+        int m = a[0], lanes[W];                                                             \
+        size_t i = 0;                                                                       \
+        if (n >= W) {                                                                       \
+            vec vm = set1(m);                                                               \
+            for (; i + W <= n; i += W) vm = vmax(load(a + i), vm);                          \
+            store(lanes, vm);                                                               \
+            for (int l = 0; l < W; l++) if (lanes[l] > m) m = lanes[l];                     \
+        }                                                                                   \
+        for (; i < n; i++) if (a[i] > m) m = a[i];                                          \
+        return find_first_i(a, n, m);                                                       \
+    }
+
+/* ── SSE2 ────────────────────────────────────────────────────────────────── *
+ * SSE2 has no 32-bit multiply-low, min or max; emulate them.
+ */
+
+#define SSE2_LOADI(p)     _mm_loadu_si128((const __m128i *)(const void *)(p))
+#define SSE2_STOREI(p, v) _mm_storeu_si128((__m128i *)(void *)(p), (v))
+
+KERNEL_TARGET(sse2) static inline __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+KERNEL_TARGET(sse2) static inline __m128i min_epi32_sse2(__m128i a, __m128i b)
+{
+    __m128i lt = _mm_cmplt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(lt, a), _mm_andnot_si128(lt, b));
+}
+
+KERNEL_TARGET(sse2) static inline __m128i max_epi32_sse2(__m128i a, __m128i b)
+{
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+
+DEFINE_DOUBLE_KERNELS(sse2, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+                      _mm_setzero_pd, _mm_add_pd, _mm_mul_pd, _mm_min_pd, _mm_max_pd)
+DEFINE_INT_KERNELS(sse2, __m128i, 4, SSE2_LOADI, SSE2_STOREI, _mm_set1_epi32,
+                   _mm_setzero_si128, _mm_add_epi32, mullo_epi32_sse2, min_epi32_sse2, max_epi32_sse2)
+
+static const StdrotKernels sse2_kernels = {
+    "sse2",
+    sum_d_sse2, dot_d_sse2, scale_d_sse2, axpy_d_sse2, argmin_d_sse2, argmax_d_sse2,
+    sum_i_sse2, dot_i_sse2, scale_i_sse2, axpy_i_sse2, argmin_i_sse2, argmax_i_sse2
+};
+
+/* ── AVX2 ────────────────────────────────────────────────────────────────── */
+
+#define AVX2_LOADI(p)     _mm256_loadu_si256((const __m256i *)(const void *)(p))
+#define AVX2_STOREI(p, v) _mm256_storeu_si256((__m256i *)(void *)(p), (v))
+
+DEFINE_DOUBLE_KERNELS(avx2, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+                      _mm256_setzero_pd, _mm256_add_pd, _mm256_mul_pd, _mm256_min_pd, _mm256_max_pd)
+DEFINE_INT_KERNELS(avx2, __m256i, 8, AVX2_LOADI, AVX2_STOREI, _mm256_set1_epi32,
+                   _mm256_setzero_si256, _mm256_add_epi32, _mm256_mullo_epi32,
+                   _mm256_min_epi32, _mm256_max_epi32)
+
+static const StdrotKernels avx2_kernels = {
+    "avx2",
+    sum_d_avx2, dot_d_avx2, scale_d_avx2, axpy_d_avx2, argmin_d_avx2, argmax_d_avx2,
+    sum_i_avx2, dot_i_avx2, scale_i_avx2, axpy_i_avx2, argmin_i_avx2, argmax_i_avx2
+};
+
+#endif /* STDROT_KERNELS_X86 */
+
+/* ── Dispatch ────────────────────────────────────────────────────────────── */
+
+static const StdrotKernels *select_kernels(void)
+{
+    const char *forced = getenv("BRAINROT_KERNELS");
+
+    if (forced && strcmp(forced, "scalar") == 0) return &scalar_kernels;
+#ifdef STDROT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && !(forced && strcmp(forced, "sse2") == 0)) {
+        return &avx2_kernels;
+    }
+    if (__builtin_cpu_supports("sse2")) return &sse2_kernels;
+#endif
+    return &scalar_kernels;
+}
+
+const StdrotKernels *stdrot_kernels(void)
+{
+    /* Programs on other threads may get here first; any of them picks the
+     * same table */
+    static const StdrotKernels *selected;
+
+    const StdrotKernels *kernels = __atomic_load_n(&selected, __ATOMIC_RELAXED);
+    if (!kernels) {
+        kernels = select_kernels();
+        __atomic_store_n(&selected, kernels, __ATOMIC_RELAXED);
+    }
+    return kernels;
+}
+
+int stdrot_thread_count(void)
+{
+    const char *env = getenv("BRAINROT_THREADS");
+    long n = env ? strtol(env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > STDROT_MAX_THREADS) n = STDROT_MAX_THREADS;
+    return (int)n;
+}
@@ -0,0 +1,43 @@
+/* stdrot/kernels.h – Vectorized loops over rizz and gigachad arrays
+ *
+ * Internal to libstdrot.so. Every operation has a scalar, an SSE2 and an
+ * AVX2 implementation; stdrot_kernels() picks the widest one the CPU
+ * supports the first time it is called. Setting BRAINROT_KERNELS to
+ * "scalar", "sse2" or "avx2" forces a narrower table (for testing).
+ *
+ * Integer arithmetic wraps around like unsigned arithmetic. Double sums
+ * and dot products are accumulated in several lanes at once, so their
+ * rounding can differ from a left-to-right loop in the last bits.
+ * argmin/argmax return the first index of the extreme value and require
+ * n > 0; a NaN in a[0] is returned as is, later NaNs are skipped.
+ */
+
+#ifndef STDROT_KERNELS_H
+#define STDROT_KERNELS_H
+
+#include <stddef.h>
+
+typedef struct {
+    const char *name;
+    double (*sum_d)(const double *a, size_t n);
+    double (*dot_d)(const double *a, const double *b, size_t n);
+    void   (*scale_d)(double *a, double k, size_t n);
+    void   (*axpy_d)(double *y, double alpha, const double *x, size_t n);
+    size_t (*argmin_d)(const double *a, size_t n);
+    size_t (*argmax_d)(const double *a, size_t n);
+    int    (*sum_i)(const int *a, size_t n);
+    int    (*dot_i)(const int *a, const int *b, size_t n);
+    void   (*scale_i)(int *a, int k, size_t n);
+    void   (*axpy_i)(int *y, int alpha, const int *x, size_t n);
+    size_t (*argmin_i)(const int *a, size_t n);
+    size_t (*argmax_i)(const int *a, size_t n);
+} StdrotKernels;
+
+const StdrotKernels *stdrot_kernels(void);
+
+/* Worker threads for builtins that split large inputs: BRAINROT_THREADS,
+ * or the number of online CPUs, clamped to 1..STDROT_MAX_THREADS */
+#define STDROT_MAX_THREADS 16
+int stdrot_thread_count(void);
+
+#endif /* STDROT_KERNELS_H */
@@ -0,0 +1,283 @@
+/* stdrot/map.c – Hash map builtins for libstdrot.so
+ *
+ * A map is an open-addressing table with linear probing, held by the
+ * program as a rizz handle. Keys are rizz/smol/yap values or text (string
+ * literals or yap arrays, up to their first NUL), and both kinds can be
+ * mixed in one map; values are rizz. Slots are stored inline and deleted
+ * with backward shifting, so there are no tombstones and lookups never
+ * allocate. Text keys are copied into one pool per map that is compacted
+ * when most of it belongs to removed keys.
+ */
+
+#include "args.h"
+#include "handles.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAP_MIN_CAPACITY 16
+#define INT_KEY UINT32_MAX /* MapSlot.key_len of an integer key */
+
+typedef struct {
+    uint64_t hash;    /* 0 for an empty slot */
+    uint64_t key;     /* the integer, or the text's offset in the pool */
+    uint32_t key_len; /* INT_KEY, or the text length */
+    int value;
+} MapSlot;
+
+typedef struct {
+    MapSlot *slots;
+    size_t capacity; /* power of two */
+    size_t size;
+    char *pool;
+    size_t pool_len;
+    size_t pool_cap;
+    size_t pool_live; /* bytes still used by keys in the table */
+} Map;
+
+typedef struct {
+    uint64_t hash;
+    uint64_t key;
+    uint32_t key_len;
+    const char *text;
+} MapKey;
+
+static uint64_t mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h ? h : 1;
+}
+
+static MapKey key_arg(const StdrotValue *args, int argc, int index)
+{
+    MapKey k = {0, 0, INT_KEY, NULL};
+    String text;
+
+    if (index < argc && stdrot_as_string(&args[index], &text)) {
+        size_t len = args[index].type == STDROT_ARRAY ? strnlen(text.data, text.len) : text.len;
+        if (len >= INT_KEY) stdrot_arg_error("key is too long");
+        uint64_t h = 0xcbf29ce484222325ULL; /* FNV-1a */
+        for (size_t i = 0; i < len; i++) {
+            h ^= (unsigned char)text.data[i];
+            h *= 0x100000001b3ULL;
+        }
+        k.hash = mix(h ^ len);
+        k.key_len = (uint32_t)len;
+        k.text = text.data;
+        return k;
+    }
+    if (index < argc && args[index].type == STDROT_CHAR) {
+        k.key = (uint64_t)(int64_t)args[index].val.c;
+    } else {
+        k.key = (uint64_t)(int64_t)stdrot_arg_integer(args, argc, index);
+    }
+    k.hash = mix(k.key);
+    return k;
+}
+
+static bool slot_matches(const Map *m, const MapSlot *s, const MapKey *k)
+{
+    if (s->hash != k->hash || s->key_len != k->key_len) return false;
+    if (k->key_len == INT_KEY) return s->key == k->key;
+    /* an empty key may have no pool behind it */
+    return k->key_len == 0 || memcmp(m->pool + s->key, k->text, k->key_len) == 0;
+}
+
+/* Slot holding k, or the empty slot where it would go */
+static size_t find(const Map *m, const MapKey *k)
+{
+    size_t mask = m->capacity - 1;
+    size_t i = (size_t)k->hash & mask;
+    while (m->slots[i].hash && !slot_matches(m, &m->slots[i], k)) i = (i + 1) & mask;
+    return i;
+}
+
+static void rehash(Map *m, size_t capacity)
+{
+    MapSlot *old = m->slots;
+    size_t old_capacity = m->capacity;
+
+    m->slots = calloc(capacity, sizeof(MapSlot));
+    if (!m->slots) stdrot_arg_error("out of memory");
+    m->capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (!old[i].hash) continue;
+        size_t j = (size_t)old[i].hash & (capacity - 1);
+        while (m->slots[j].hash) j = (j + 1) & (capacity - 1);
+        m->slots[j] = old[i];
+    }
+    free(old);
+}
+
+/* Copies the text of live keys to the front of a fresh pool */
+static void compact_pool(Map *m, size_t capacity)
+{
+    char *pool = malloc(capacity);
+    if (!pool) stdrot_arg_error("out of memory");
+
+    size_t len = 0;
+    for (size_t i = 0; i < m->capacity; i++) {
+        MapSlot *s = &m->slots[i];
+        if (!s->hash || s->key_len == INT_KEY) continue;
+        if (s->key_len) memcpy(pool + len, m->pool + s->key, s->key_len);
+        s->key = len;
+        len += s->key_len;
+    }
+    free(m->pool);
+    m->pool = pool;
+    m->pool_len = len;
+    m->pool_cap = capacity;
+}
+
+static uint64_t pool_add(Map *m, const char *text, size_t len)
+{
+    if (len == 0) return m->pool_len; /* the pool may not exist yet */
+    if (len > m->pool_cap - m->pool_len) {
+        size_t needed = m->pool_live + len;
+        size_t capacity = m->pool_cap ? m->pool_cap : 256;
+        while (capacity < 2 * needed) capacity *= 2;
+        compact_pool(m, capacity);
+    }
+    memcpy(m->pool + m->pool_len, text, len);
+    m->pool_len += len;
+    m->pool_live += len;
+    return m->pool_len - len;
+}
+
+/* Backward-shift deletion: pulls later entries of the probe run into the
+ * hole so that every key stays reachable from its home slot */
+static void erase(Map *m, size_t hole)
+{
+    size_t mask = m->capacity - 1;
+    if (m->slots[hole].key_len != INT_KEY) m->pool_live -= m->slots[hole].key_len;
+
+    for (size_t i = (hole + 1) & mask; m->slots[i].hash; i = (i + 1) & mask) {
+        size_t home = (size_t)m->slots[i].hash & mask;
+        /* move i into the hole unless its home lies cyclically in (hole, i] */
+        bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (stays) continue;
+        m->slots[hole] = m->slots[i];
+        hole = i;
+    }
+    m->slots[hole].hash = 0;
+    m->size--;
+}
+
+static void map_destroy(void *obj)
+{
+    Map *m = obj;
+    free(m->slots);
+    free(m->pool);
+    free(m);
+}
+
+/* ── Builtins ────────────────────────────────────────────────────────────── */
+
+/* map_new(): returns a handle to an empty map */
+static StdrotValue stdrot_map_new(StdrotValue *args, int argc)
+{
+    (void)args;
+    (void)argc;
+    Map *m = calloc(1, sizeof(Map));
+    if (!m) stdrot_arg_error("out of memory");
+    m->slots = calloc(MAP_MIN_CAPACITY, sizeof(MapSlot));
+    if (!m->slots) {
+        free(m);
+        stdrot_arg_error("out of memory");
+    }
+    m->capacity = MAP_MIN_CAPACITY;
+    return (StdrotValue){STDROT_INT, {.i = stdrot_handle_new(STDROT_HANDLE_MAP, m, map_destroy)}};
+}
+
+/* map_put(m, key, value): inserts or overwrites */
+static StdrotValue stdrot_map_put(StdrotValue *args, int argc)
+{
+    Map *m = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_MAP);
+    MapKey k = key_arg(args, argc, 1);
+    int value = (int)stdrot_arg_integer(args, argc, 2);
+
+    size_t i = find(m, &k);
+    if (!m->slots[i].hash) {
+        if ((m->size + 1) * 4 > m->capacity * 3) {
+            rehash(m, m->capacity * 2);
+            i = find(m, &k);
+        }
+        if (k.key_len != INT_KEY) k.key = pool_add(m, k.text, k.key_len);
+        m->slots[i] = (MapSlot){ k.hash, k.key, k.key_len, 0 };
+        m->size++;
+    }
+    m->slots[i].value = value;
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* map_get(m, key[, fallback]): a missing key is an error unless a
+ * fallback is given */
+static StdrotValue stdrot_map_get(StdrotValue *args, int argc)
+{
+    Map *m = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_MAP);
+    MapKey k = key_arg(args, argc, 1);
+
+    size_t i = find(m, &k);
+    if (m->slots[i].hash) return (StdrotValue){STDROT_INT, {.i = m->slots[i].value}};
+    if (argc < 3) stdrot_arg_error("key not found");
+    return (StdrotValue){STDROT_INT, {.i = (int)stdrot_arg_integer(args, argc, 2)}};
+}
+
+/* map_contains(m, key) */
+static StdrotValue stdrot_map_contains(StdrotValue *args, int argc)
+{
+    Map *m = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_MAP);
+    MapKey k = key_arg(args, argc, 1);
+    return (StdrotValue){STDROT_BOOL, {.b = m->slots[find(m, &k)].hash != 0}};
+}
+
+/* map_remove(m, key): returns whether the key was there */
+static StdrotValue stdrot_map_remove(StdrotValue *args, int argc)
+{
+    Map *m = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_MAP);
+    MapKey k = key_arg(args, argc, 1);
+
+    size_t i = find(m, &k);
+    bool found = m->slots[i].hash != 0;
+    if (found) erase(m, i);
+    return (StdrotValue){STDROT_BOOL, {.b = found}};
+}
+
+/* map_size(m) */
+static StdrotValue stdrot_map_size(StdrotValue *args, int argc)
+{
+    Map *m = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_MAP);
+    return (StdrotValue){STDROT_INT, {.i = (int)m->size}};
+}
+
+/* map_clear(m): removes every key but keeps the allocated capacity */
+static StdrotValue stdrot_map_clear(StdrotValue *args, int argc)
+{
+    Map *m = stdrot_arg_handle(args, argc, 0, STDROT_HANDLE_MAP);
+    memset(m->slots, 0, m->capacity * sizeof(MapSlot));
+    m->size = 0;
+    m->pool_len = 0;
+    m->pool_live = 0;
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* map_free(m): releases the map; the handle becomes invalid */
+static StdrotValue stdrot_map_free(StdrotValue *args, int argc)
+{
+    stdrot_handle_free(args, argc, 0, STDROT_HANDLE_MAP);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+STDROT_EXPORT_FLAGS("map_new", stdrot_map_new, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("map_put", stdrot_map_put);
+STDROT_EXPORT_FLAGS("map_get", stdrot_map_get, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("map_contains", stdrot_map_contains, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_BOOL));
+STDROT_EXPORT_FLAGS("map_remove", stdrot_map_remove, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_BOOL));
+STDROT_EXPORT_FLAGS("map_size", stdrot_map_size, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("map_clear", stdrot_map_clear);
+STDROT_EXPORT("map_free", stdrot_map_free);
@@ -0,0 +1,149 @@
+/* stdrot/mapreduce.c – Parallel map and map/reduce builtins for libstdrot.so
+ *
+ *     array_map(dst, src, "fn"[, start, count])        dst[i] = fn(src[i])
+ *     array_map_reduce(src, "fn", "combine", init[, start, count])
+ *
+ * fn takes one number and combine two; both are brainrot functions, run on
+ * the interpreter's thread pool through stdrot_parallel(). The elements are
+ * cut into MAP_CHUNKS chunks of consecutive elements whatever the thread
+ * count. map_reduce folds each chunk left to right, starting from its first
+ * mapped element, and then folds the chunks' results into init in chunk
+ * order. The result therefore never depends on the thread count, and it is
+ * the serial left fold whenever combine is associative.
+ *
+ * Results stored into a rizz array, or returned for one, are rounded toward
+ * zero and saturate at the limits of rizz; NaN becomes 0.
+ */
+
+#include "args.h"
+#include <string.h>
+
+#define MAP_CHUNKS 64
+
+typedef struct {
+    const StdrotFunction *fn;
+    const StdrotFunction *combine;
+    StdrotArray src, dst;
+    size_t start, count, chunks;
+    double *partials; /* map_reduce: one per chunk */
+    double result;    /* map_reduce: init, then the partials folded in */
+} MapJob;
+
+/* args[index] as a rizz or gigachad array */
+static StdrotArray number_array_arg(const StdrotValue *args, int argc, int index)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, index);
+    bool is_int = arr.elem_type == STDROT_INT && arr.elem_size == sizeof(int);
+    bool is_double = arr.elem_type == STDROT_DOUBLE && arr.elem_size == sizeof(double);
+    if (!is_int && !is_double) {
+        stdrot_arg_error("only rizz and gigachad arrays are supported");
+    }
+    return arr;
+}
+
+/* args[index] as the name of a function taking argc numbers */
+static const StdrotFunction *function_arg(const StdrotValue *args, int argc, int index, int arity)
+{
+    String name;
+    if (index >= argc || !stdrot_as_string(&args[index], &name)) {
+        stdrot_arg_error("expected the name of a function");
+    }
+    if (args[index].type == STDROT_ARRAY) name.len = strnlen(name.data, name.len);
+    return stdrot_function(name, arity);
+}
+
+static double load(StdrotArray arr, size_t i)
+{
+    return arr.elem_type == STDROT_DOUBLE ? ((const double *)arr.data)[i] : ((const int *)arr.data)[i];
+}
+
+static void store(StdrotArray arr, size_t i, double value)
+{
+    if (arr.elem_type == STDROT_DOUBLE) ((double *)arr.data)[i] = value;
+    else ((int *)arr.data)[i] = stdrot_to_int(value);
+}
+
+static void chunk_bounds(const MapJob *job, size_t chunk, size_t *first, size_t *last)
+{
+    *first = job->start + job->count * chunk / job->chunks;
+    *last = job->start + job->count * (chunk + 1) / job->chunks;
+}
+
+static void map_chunk(void *data, size_t chunk)
+{
+    const MapJob *job = data;
+    size_t first, last;
+    chunk_bounds(job, chunk, &first, &last);
+    for (size_t i = first; i < last; i++) {
+        double x = load(job->src, i);
+        store(job->dst, i, stdrot_call(job->fn, &x, 1));
+    }
+}
+
+static void map_reduce_chunk(void *data, size_t chunk)
+{
+    const MapJob *job = data;
+    size_t first, last;
+    chunk_bounds(job, chunk, &first, &last);
+    double x = load(job->src, first);
+    double pair[2] = { stdrot_call(job->fn, &x, 1), 0 };
+    for (size_t i = first + 1; i < last; i++) {
+        x = load(job->src, i);
+        pair[1] = stdrot_call(job->fn, &x, 1);
+        pair[0] = stdrot_call(job->combine, pair, 2);
+    }
+    job->partials[chunk] = pair[0];
+}
+
+static void fold_chunk(void *data, size_t chunk)
+{
+    MapJob *job = data;
+    (void)chunk;
+    for (size_t c = 0; c < job->chunks; c++) {
+        double pair[2] = { job->result, job->partials[c] };
+        job->result = stdrot_call(job->combine, pair, 2);
+    }
+}
+
+/* array_map(dst, src, "fn"[, start, count]) */
+static StdrotValue stdrot_array_map(StdrotValue *args, int argc)
+{
+    MapJob job = {0};
+    job.dst = number_array_arg(args, argc, 0);
+    job.src = number_array_arg(args, argc, 1);
+    stdrot_arg_range(args, argc, 3, job.dst.length, job.src.length, &job.start, &job.count);
+    job.fn = function_arg(args, argc, 2, 1);
+
+    job.chunks = job.count < MAP_CHUNKS ? job.count : MAP_CHUNKS;
+    if (job.chunks > 0) stdrot_parallel(job.chunks, map_chunk, &job);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* array_map_reduce(src, "fn", "combine", init[, start, count]): the fold of
+ * combine over fn of each element, starting from init, as an element of src */
+static StdrotValue stdrot_array_map_reduce(StdrotValue *args, int argc)
+{
+    MapJob job = {0};
+    job.src = number_array_arg(args, argc, 0);
+    job.result = stdrot_arg_number(args, argc, 3);
+    stdrot_arg_range(args, argc, 4, job.src.length, job.src.length, &job.start, &job.count);
+    job.fn = function_arg(args, argc, 1, 1);
+    job.combine = function_arg(args, argc, 2, 2);
+
+    double partials[MAP_CHUNKS];
+    job.partials = partials;
+    job.chunks = job.count < MAP_CHUNKS ? job.count : MAP_CHUNKS;
+    if (job.chunks > 0) {
+        stdrot_parallel(job.chunks, map_reduce_chunk, &job);
+        /* combine may only be called from inside a job */
+        stdrot_parallel(1, fold_chunk, &job);
+    }
+
+    StdrotValue out = {job.src.elem_type, {0}};
+    if (job.src.elem_type == STDROT_DOUBLE) out.val.d = job.result;
+    else out.val.i = stdrot_to_int(job.result);
+    return out;
+}
+
+STDROT_EXPORT("array_map", stdrot_array_map);
+STDROT_EXPORT_FLAGS("array_map_reduce", stdrot_array_map_reduce, STDROT_RETURNS_ELEM);
@@ -0,0 +1,204 @@
+/* stdrot/matrix.c – Matrix builtins over 2-D gigachad arrays for libstdrot.so
+ *
+ * Matrices are the interpreter's own row-major array storage, used in
+ * place. matmul walks C in column blocks that stay in L1 and B in k-blocks
+ * that stay in L2, with the inner row update done by the SIMD axpy kernel.
+ * Large products are split by rows across threads; every row is still
+ * computed by one thread in the same order, so results do not depend on
+ * the thread count.
+ */
+
+#include "args.h"
+#include "kernels.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MATMUL_BLOCK_K 64
+#define MATMUL_BLOCK_J 256
+#define TRANSPOSE_TILE 32
+#define MATMUL_MIN_PARALLEL_WORK (1u << 21) /* multiply-adds */
+
+/* args[index] as a gigachad array with `rank` dimensions (0: any rank) */
+static StdrotArray double_arg(const StdrotValue *args, int argc, int index, int rank)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, index);
+    if (arr.elem_type != STDROT_DOUBLE || arr.elem_size != sizeof(double)) {
+        stdrot_arg_error("only gigachad arrays are supported");
+    }
+    if (rank && arr.rank != rank) {
+        stdrot_arg_error(rank == 2 ? "expected a 2-D array" : "expected a 1-D array");
+    }
+    return arr;
+}
+
+/* ── matmul ──────────────────────────────────────────────────────────────── */
+
+typedef struct {
+    void (*axpy)(double *, double, const double *, size_t);
+    double *c;
+    const double *a;
+    const double *b;
+    size_t row_begin, row_end, k, n;
+} MatmulTask;
+
+static void matmul_rows(const MatmulTask *t)
+{
+    size_t k = t->k, n = t->n;
+
+    memset(t->c + t->row_begin * n, 0, (t->row_end - t->row_begin) * n * sizeof(double));
+
+    for (size_t jj = 0; jj < n; jj += MATMUL_BLOCK_J) {
+        size_t jlen = n - jj < MATMUL_BLOCK_J ? n - jj : MATMUL_BLOCK_J;
+        for (size_t kk = 0; kk < k; kk += MATMUL_BLOCK_K) {
+            size_t kend = k - kk < MATMUL_BLOCK_K ? k : kk + MATMUL_BLOCK_K;
+            for (size_t i = t->row_begin; i < t->row_end; i++) {
+                double *c_row = t->c + i * n + jj;
+                const double *a_row = t->a + i * k;
+                for (size_t p = kk; p < kend; p++) {
+                    t->axpy(c_row, a_row[p], t->b + p * n + jj, jlen);
+                }
+            }
+        }
+    }
+}
+
+static void *matmul_thread(void *arg)
+{
+    matmul_rows(arg);
+    return NULL;
+}
+
+/* matrix_matmul(c, a, b): c[m][n] = a[m][k] · b[k][n] */
+static StdrotValue stdrot_matrix_matmul(StdrotValue *args, int argc)
+{
+    StdrotArray c = double_arg(args, argc, 0, 2);
+    StdrotArray a = double_arg(args, argc, 1, 2);
+    StdrotArray b = double_arg(args, argc, 2, 2);
+
+    size_t m = (size_t)a.dims[0], k = (size_t)a.dims[1], n = (size_t)b.dims[1];
+    if ((size_t)b.dims[0] != k || (size_t)c.dims[0] != m || (size_t)c.dims[1] != n) {
+        stdrot_arg_error("matrix dimensions do not match");
+    }
+    if (c.data == a.data || c.data == b.data) {
+        stdrot_arg_error("the result must not be one of the inputs");
+    }
+
+    MatmulTask tasks[STDROT_MAX_THREADS];
+    pthread_t threads[STDROT_MAX_THREADS];
+    int thread_count = stdrot_thread_count();
+    if ((double)m * (double)n * (double)k < MATMUL_MIN_PARALLEL_WORK) thread_count = 1;
+    if ((size_t)thread_count > m) thread_count = m ? (int)m : 1;
+
+    size_t rows_per_thread = (m + (size_t)thread_count - 1) / (size_t)thread_count;
+    int started = 0;
+    for (int t = 0; t < thread_count; t++) {
+        size_t begin = (size_t)t * rows_per_thread;
+        size_t end = begin + rows_per_thread < m ? begin + rows_per_thread : m;
+        tasks[t] = (MatmulTask){ stdrot_kernels()->axpy_d, c.data, a.data, b.data, begin, end, k, n };
+        if (begin >= end) continue;
+        /* the calling thread takes the last chunk; fall back to it too if
+         * a thread cannot be created */
+        if (t == thread_count - 1 || pthread_create(&threads[started], NULL, matmul_thread, &tasks[t]) != 0) {
+            matmul_rows(&tasks[t]);
+        } else {
+            started++;
+        }
+    }
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* ── transpose / matvec / stencil ────────────────────────────────────────── */
+
+/* matrix_transpose(dst, src): dst[n][m] = src[m][n]^T, any element type */
+static StdrotValue stdrot_matrix_transpose(StdrotValue *args, int argc)
+{
+    StdrotArray dst = stdrot_arg_array(args, argc, 0);
+    StdrotArray src = stdrot_arg_array(args, argc, 1);
+
+    if (dst.rank != 2 || src.rank != 2) stdrot_arg_error("expected a 2-D array");
+    if (dst.elem_type != src.elem_type || dst.elem_size != src.elem_size) {
+        stdrot_arg_error("arrays must have the same element type");
+    }
+    if (src.elem_size == 0) stdrot_arg_error("cap arrays are not supported");
+    size_t m = (size_t)src.dims[0], n = (size_t)src.dims[1], size = src.elem_size;
+    if ((size_t)dst.dims[0] != n || (size_t)dst.dims[1] != m) {
+        stdrot_arg_error("matrix dimensions do not match");
+    }
+    if (dst.data == src.data) stdrot_arg_error("the result must not be the input");
+
+    const char *s = src.data;
+    char *d = dst.data;
+    for (size_t ii = 0; ii < m; ii += TRANSPOSE_TILE) {
+        size_t iend = m - ii < TRANSPOSE_TILE ? m : ii + TRANSPOSE_TILE;
+        for (size_t jj = 0; jj < n; jj += TRANSPOSE_TILE) {
+            size_t jend = n - jj < TRANSPOSE_TILE ? n : jj + TRANSPOSE_TILE;
+            for (size_t i = ii; i < iend; i++) {
+                for (size_t j = jj; j < jend; j++) {
+                    memcpy(d + (j * m + i) * size, s + (i * n + j) * size, size);
+                }
+            }
+        }
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* matrix_matvec(y, a, x): y[m] = a[m][n] · x[n] */
+static StdrotValue stdrot_matrix_matvec(StdrotValue *args, int argc)
+{
+    StdrotArray y = double_arg(args, argc, 0, 1);
+    StdrotArray a = double_arg(args, argc, 1, 2);
+    StdrotArray x = double_arg(args, argc, 2, 1);
+
+    size_t m = (size_t)a.dims[0], n = (size_t)a.dims[1];
+    if (x.length != n || y.length != m) stdrot_arg_error("matrix dimensions do not match");
+    if (y.data == x.data) stdrot_arg_error("the result must not be the input vector");
+
+    double (*dot)(const double *, const double *, size_t) = stdrot_kernels()->dot_d;
+    double *out = y.data;
+    const double *rows = a.data;
+    for (size_t i = 0; i < m; i++) out[i] = dot(rows + i * n, x.data, n);
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+/* matrix_stencil5(dst, src, center, neighbor): for interior cells
+ *   dst[i][j] = center * src[i][j]
+ *             + neighbor * (src[i-1][j] + src[i+1][j] + src[i][j-1] + src[i][j+1])
+ * Border cells are copied from src unchanged. */
+static StdrotValue stdrot_matrix_stencil5(StdrotValue *args, int argc)
+{
+    StdrotArray dst = double_arg(args, argc, 0, 2);
+    StdrotArray src = double_arg(args, argc, 1, 2);
+    double center = stdrot_arg_number(args, argc, 2);
+    double neighbor = stdrot_arg_number(args, argc, 3);
+
+    size_t m = (size_t)src.dims[0], n = (size_t)src.dims[1];
+    if ((size_t)dst.dims[0] != m || (size_t)dst.dims[1] != n) {
+        stdrot_arg_error("matrix dimensions do not match");
+    }
+    if (dst.data == src.data) stdrot_arg_error("the result must not be the input");
+
+    double *d = dst.data;
+    const double *s = src.data;
+    memcpy(d, s, m * n * sizeof(double));
+    if (m < 3 || n < 3) return (StdrotValue){STDROT_NONE, {0}};
+
+    /* Each output row only reads three input rows, so this streams */
+    for (size_t i = 1; i + 1 < m; i++) {
+        const double *up = s + (i - 1) * n;
+        const double *mid = s + i * n;
+        const double *down = s + (i + 1) * n;
+        double *out = d + i * n;
+        for (size_t j = 1; j + 1 < n; j++) {
+            out[j] = center * mid[j] + neighbor * (up[j] + down[j] + mid[j - 1] + mid[j + 1]);
+        }
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+STDROT_EXPORT("matrix_matmul", stdrot_matrix_matmul);
+STDROT_EXPORT("matrix_transpose", stdrot_matrix_transpose);
+STDROT_EXPORT("matrix_matvec", stdrot_matrix_matvec);
+STDROT_EXPORT("matrix_stencil5", stdrot_matrix_stencil5);
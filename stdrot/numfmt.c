@@ -0,0 +1,108 @@
+/* stdrot/numfmt.c – Number to text conversion for the format engine
+ *
+ * Integers are emitted two digits at a time from a pair table. Fixed-point
+ * doubles are rounded exactly: the binary value m·2^e is scaled by 10^p in
+ * 128-bit arithmetic and rounded half-to-even on the exact remainder, which
+ * is what glibc does for "%.pf" in the default rounding mode.
+ */
+
+#include "numfmt.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+__extension__ typedef unsigned __int128 u128;
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t pow10_table[18] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL
+};
+
+size_t stdrot_format_u64(char *buf, uint64_t value)
+{
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+
+    while (value >= 100) {
+        size_t idx = (size_t)(value % 100) * 2;
+        value /= 100;
+        p -= 2;
+        memcpy(p, digit_pairs + idx, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, digit_pairs + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
+    }
+
+    size_t len = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(buf, p, len);
+    return len;
+}
+
+int stdrot_format_fixed(char *buf, double value, int precision)
+{
+    if (precision < 0 || precision > 17 || !isfinite(value)) return -1;
+
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 63) != 0;
+    int biased = (int)((bits >> 52) & 0x7ff);
+    uint64_t mantissa = bits & ((1ULL << 52) - 1);
+    int exponent = -1074;
+    if (biased != 0) {
+        mantissa |= 1ULL << 52;
+        exponent = biased - 1075;
+    }
+
+    /* scaled = round_half_even(|value| * 10^precision) */
+    uint64_t scale = pow10_table[precision];
+    u128 scaled = 0;
+    if (mantissa != 0 && exponent >= 0) {
+        if (exponent >= 11) return -1; /* |value| >= 2^63 */
+        scaled = (u128)(mantissa << exponent) * scale;
+    } else if (mantissa != 0) {
+        int shift = -exponent;
+        u128 product = (u128)mantissa * scale; /* < 2^117 */
+        if (shift < 128) {
+            u128 half = (u128)1 << (shift - 1);
+            u128 rem = product & (((u128)1 << shift) - 1);
+            scaled = product >> shift;
+            if (rem > half || (rem == half && (scaled & 1))) scaled++;
+        }
+        /* shift >= 128 leaves product / 2^shift below 2^-11: rounds to 0 */
+    }
+
+    uint64_t int_part = (uint64_t)(scaled / scale);
+    uint64_t frac_part = (uint64_t)(scaled % scale);
+
+    char *p = buf;
+    if (negative) *p++ = '-';
+    p += stdrot_format_u64(p, int_part);
+    if (precision > 0) {
+        *p++ = '.';
+        for (int i = precision - 1; i >= 0; i--) {
+            p[i] = (char)('0' + frac_part % 10);
+            frac_part /= 10;
+        }
+        p += precision;
+    }
+    return (int)(p - buf);
+}
@@ -0,0 +1,25 @@
+/* stdrot/numfmt.h – Number to text conversion for the format engine
+ *
+ * Internal to libstdrot.so. Both functions write into `buf` without a
+ * terminating NUL and return the number of characters written; output is
+ * byte-for-byte what printf produces for the equivalent conversion.
+ */
+
+#ifndef STDROT_NUMFMT_H
+#define STDROT_NUMFMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest output of either function (sign, 20 digits, '.', 17 decimals) */
+#define STDROT_NUMFMT_MAX 48
+
+/* Decimal digits of `value`, like "%llu". buf needs 20 bytes. */
+size_t stdrot_format_u64(char *buf, uint64_t value);
+
+/* Like "%.*f" with `precision` decimals. Handles finite values with
+ * |value| < 2^63 and precision <= 17 exactly; returns -1 for anything else
+ * so the caller can fall back to snprintf. */
+int stdrot_format_fixed(char *buf, double value, int precision);
+
+#endif /* STDROT_NUMFMT_H */
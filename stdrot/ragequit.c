@@ -1,20 +1,23 @@
 /* stdrot/ragequit.c – Process control functions for libstdrot.so */
 
 #include "stdrot_api.h"
+#include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
 
-/* ragequit: exit with a code.
- * cleanup() is registered via atexit() in main() so it runs automatically. */
+/* ragequit: end the program with a code. The host flushes the program's
+ * output and frees everything it used, then exits or, when embedded,
+ * returns the code from br_run(). */
 void ragequit(int exit_code)
 {
-    exit(exit_code);
+    stdrot_exit(exit_code);
 }
 
-/* chill: suspend execution for the given number of seconds */
+/* chill: suspend execution for the given number of seconds. In a task only
+ * the task waits; its worker runs other tasks meanwhile. */
 void chill(unsigned int seconds)
 {
-    sleep(seconds);
+    fflush(g_exec_context.out); /* show everything printed so far before going quiet */
+    stdrot_sleep(seconds);
 }
 
 static StdrotValue stdrot_ragequit(StdrotValue *args, int argc)
@@ -6,6 +6,8 @@
  */
 
 #include "stdrot_api.h"
+#include "handles.h"
+#include "lib/input.h"
 
 /* Linker provides these symbols marking the start/end of the section */
 extern StdrotEntry __start_stdrot_exports;
@@ -19,3 +21,11 @@ StdrotAPI stdrot_get_api(void)
     api.count = (int)(&__stop_stdrot_exports - &__start_stdrot_exports);
     return api;
 }
+
+/* Called by stdrot.c when a program finishes */
+void stdrot_release(ExecutionContext *ctx)
+{
+    stdrot_release_handles(ctx);
+    input_reader_free(ctx->input);
+    ctx->input = NULL;
+}
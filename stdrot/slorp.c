@@ -1,108 +1,148 @@
 /* stdrot/slorp.c – Input (read) functions for libstdrot.so
  *
  * All slorp_* functions call into lib/input.c which is compiled into this
- * .so, so the main binary has zero direct dependency on lib/input.c.
+ * .so, so the main binary has zero direct dependency on lib/input.c. They
+ * read the running program's input (g_exec_context.read), which is fd 0
+ * unless the host supplied its own.
  */
 
 #include "stdrot_api.h"
 #include "lib/input.h"
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+static pthread_once_t wait_once = PTHREAD_ONCE_INIT;
+
+/* Lets a task wait for fd 0 without holding up its worker */
+static void install_wait(void)
+{
+    input_set_wait(stdrot_wait_readable);
+}
+
+/* Points lib/input.c at the running program's input. The program's tasks
+ * share it, so every read ends with stdrot_input_end(). */
+static void use_program_input(void)
+{
+    pthread_once(&wait_once, install_wait);
+    ExecutionContext *ctx = stdrot_input_begin();
+    if (ctx->read && !ctx->input) {
+        ctx->input = input_reader_new(ctx->read, ctx->read_data);
+        if (!ctx->input) {
+            fprintf(g_exec_context.err, "Error: out of memory\n");
+            stdrot_exit(EXIT_FAILURE);
+        }
+    }
+    input_use(ctx->input);
+}
+
 char slorp_char(char chr)
 {
+    use_program_input();
     input_status status = input_char(&chr);
+    stdrot_input_end();
     if (status == INPUT_SUCCESS)
         return chr;
     if (status == INPUT_INVALID_LENGTH) {
-        fprintf(stderr, "Error: Invalid input length.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Invalid input length.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
-    fprintf(stderr, "Error reading char: %d\n", status);
-    exit(EXIT_FAILURE);
+    fprintf(g_exec_context.err, "Error reading char: %d\n", status);
+    stdrot_exit(EXIT_FAILURE);
 }
 
 char *slorp_string(char *string, size_t size)
 {
+    use_program_input();
     size_t chars_read;
     input_status status = input_string(string, size, &chars_read);
+    stdrot_input_end();
     if (status == INPUT_SUCCESS)
         return string;
     if (status == INPUT_BUFFER_OVERFLOW) {
-        fprintf(stderr, "Error: Input exceeded buffer size.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Input exceeded buffer size.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
-    fprintf(stderr, "Error reading string: %d\n", status);
-    exit(EXIT_FAILURE);
+    fprintf(g_exec_context.err, "Error reading string: %d\n", status);
+    stdrot_exit(EXIT_FAILURE);
 }
 
 int slorp_int(int val)
 {
+    use_program_input();
     input_status status = input_int(&val);
+    stdrot_input_end();
     if (status == INPUT_SUCCESS)
         return val;
     if (status == INPUT_INTEGER_OVERFLOW) {
-        fprintf(stderr, "Error: Integer value out of range.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Integer value out of range.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
     if (status == INPUT_CONVERSION_ERROR) {
-        fprintf(stderr, "Error: Invalid integer format.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Invalid integer format.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
-    fprintf(stderr, "Error reading integer: %d\n", status);
-    exit(EXIT_FAILURE);
+    fprintf(g_exec_context.err, "Error reading integer: %d\n", status);
+    stdrot_exit(EXIT_FAILURE);
 }
 
 short slorp_short(short val)
 {
+    use_program_input();
     input_status status = input_short(&val);
+    stdrot_input_end();
     if (status == INPUT_SUCCESS)
         return val;
     if (status == INPUT_SHORT_OVERFLOW) {
-        fprintf(stderr, "Error: short value out of range.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: short value out of range.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
     if (status == INPUT_CONVERSION_ERROR) {
-        fprintf(stderr, "Error: Invalid short integer format.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Invalid short integer format.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
-    fprintf(stderr, "Error reading short: %d\n", status);
-    exit(EXIT_FAILURE);
+    fprintf(g_exec_context.err, "Error reading short: %d\n", status);
+    stdrot_exit(EXIT_FAILURE);
 }
 
 float slorp_float(float var)
 {
+    use_program_input();
     input_status status = input_float(&var);
+    stdrot_input_end();
     if (status == INPUT_SUCCESS)
         return var;
     if (status == INPUT_FLOAT_OVERFLOW) {
-        fprintf(stderr, "Error: Float value out of range.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Float value out of range.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
     if (status == INPUT_CONVERSION_ERROR) {
-        fprintf(stderr, "Error: Invalid float format.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Invalid float format.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
-    fprintf(stderr, "Error reading float: %d\n", status);
-    exit(EXIT_FAILURE);
+    fprintf(g_exec_context.err, "Error reading float: %d\n", status);
+    stdrot_exit(EXIT_FAILURE);
 }
 
 double slorp_double(double var)
 {
+    use_program_input();
     input_status status = input_double(&var);
+    stdrot_input_end();
     if (status == INPUT_SUCCESS)
         return var;
     if (status == INPUT_DOUBLE_OVERFLOW) {
-        fprintf(stderr, "Error: Double value out of range.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Double value out of range.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
     if (status == INPUT_CONVERSION_ERROR) {
-        fprintf(stderr, "Error: Invalid double format.\n");
-        exit(EXIT_FAILURE);
+        fprintf(g_exec_context.err, "Error: Invalid double format.\n");
+        stdrot_exit(EXIT_FAILURE);
     }
-    fprintf(stderr, "Error reading double: %d\n", status);
-    exit(EXIT_FAILURE);
+    fprintf(g_exec_context.err, "Error reading double: %d\n", status);
+    stdrot_exit(EXIT_FAILURE);
 }
 
 static StdrotValue stdrot_slorp(StdrotValue *args, int argc)
@@ -111,6 +151,9 @@ static StdrotValue stdrot_slorp(StdrotValue *args, int argc)
         return (StdrotValue){STDROT_NONE, {0}};
     }
 
+    /* Flush pending output first so prompts are visible before we block */
+    fflush(g_exec_context.out);
+
     StdrotValue out = {STDROT_NONE, {0}};
     switch (args[0].type) {
     case STDROT_INT:
@@ -133,6 +176,12 @@ static StdrotValue stdrot_slorp(StdrotValue *args, int argc)
         out.type = STDROT_CHAR;
         out.val.c = slorp_char(args[0].val.c);
         break;
+    case STDROT_ARRAY:
+        /* char arrays are filled in place; other arrays go to slorp_array */
+        if (args[0].val.arr.elem_type == STDROT_CHAR && args[0].val.arr.length > 0) {
+            slorp_string(args[0].val.arr.data, args[0].val.arr.length);
+        }
+        break;
     case STDROT_STRING:
         if (args[0].val.str.data) {
             size_t size = args[0].val.str.len;
@@ -148,4 +197,92 @@ static StdrotValue stdrot_slorp(StdrotValue *args, int argc)
     return out;
 }
 
+static void slorp_array_error(const char *message)
+{
+    fflush(g_exec_context.out); /* keep buffered output ahead of the error text */
+    fprintf(g_exec_context.err, "Error: slorp_array: %s at line %d\n", message, g_exec_context.line_number);
+    stdrot_exit(EXIT_FAILURE);
+}
+
+/* slorp_array(arr[, count]): reads `count` values (default: the whole array)
+ * straight into the array's storage, with no interpreter work per element */
+static StdrotValue stdrot_slorp_array(StdrotValue *args, int argc)
+{
+    StdrotArray arr;
+
+    if (argc > 0 && args[0].type == STDROT_ARRAY) {
+        arr = args[0].val.arr;
+    } else {
+        slorp_array_error("first argument must be an array");
+    }
+
+    size_t count = arr.length;
+    if (argc > 1) {
+        long n;
+        if (args[1].type == STDROT_INT) n = args[1].val.i;
+        else if (args[1].type == STDROT_SHORT) n = args[1].val.s;
+        else slorp_array_error("count must be an integer");
+        if (n < 0 || (size_t)n > arr.length) slorp_array_error("count is out of bounds for the array");
+        count = (size_t)n;
+    }
+
+    /* Flush pending output first so prompts are visible before we block */
+    fflush(g_exec_context.out);
+    use_program_input();
+
+    switch (arr.elem_type) {
+    case STDROT_INT: {
+        if (arr.elem_size != sizeof(int)) slorp_array_error("unsupported element type");
+        int *dst = arr.data;
+        for (size_t i = 0; i < count; i++) dst[i] = slorp_int(0);
+        break;
+    }
+    case STDROT_SHORT: {
+        short *dst = arr.data;
+        for (size_t i = 0; i < count; i++) dst[i] = slorp_short(0);
+        break;
+    }
+    case STDROT_FLOAT: {
+        float *dst = arr.data;
+        for (size_t i = 0; i < count; i++) dst[i] = slorp_float(0.0f);
+        break;
+    }
+    case STDROT_DOUBLE: {
+        double *dst = arr.data;
+        for (size_t i = 0; i < count; i++) dst[i] = slorp_double(0.0);
+        break;
+    }
+    case STDROT_BOOL: {
+        /* cap arrays are bit-packed, see StdrotArray */
+        uint64_t *words = arr.data;
+        for (size_t i = 0; i < count; i++) {
+            bool value;
+            if (input_bool(&value) != INPUT_SUCCESS) {
+                fprintf(g_exec_context.err, "Error: Invalid boolean format.\n");
+                stdrot_exit(EXIT_FAILURE);
+            }
+            if (value) words[i / 64] |= (uint64_t)1 << (i % 64);
+            else words[i / 64] &= ~((uint64_t)1 << (i % 64));
+        }
+        break;
+    }
+    case STDROT_CHAR: {
+        char *dst = arr.data;
+        for (size_t i = 0; i < count; i++) {
+            if (input_char_token(&dst[i]) != INPUT_SUCCESS) {
+                fprintf(g_exec_context.err, "Error: Invalid input length.\n");
+                stdrot_exit(EXIT_FAILURE);
+            }
+        }
+        break;
+    }
+    default:
+        slorp_array_error("unsupported element type");
+    }
+
+    stdrot_input_end();
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
 STDROT_EXPORT("slorp", stdrot_slorp);
+STDROT_EXPORT("slorp_array", stdrot_slorp_array);
@@ -0,0 +1,449 @@
+/* stdrot/sort.c – Sorting, selection and binary search builtins for libstdrot.so
+ *
+ * All of them work in place on rizz, smol, chad, gigachad and yap arrays,
+ * or on a (start, count) range of one. The per-type code is generated by
+ * DEFINE_SORT below:
+ *
+ *   - introsort: median-of-three quicksort, heapsort once the recursion gets
+ *     too deep, insertion sort for short runs
+ *   - LSD radix sort (8-bit digits, passes with a single bucket skipped) for
+ *     rizz and smol; counting sort for yap
+ *   - introselect for array_nth
+ *   - large inputs are cut into one chunk per thread, sorted in parallel and
+ *     merged pairwise
+ *
+ * chad/gigachad NaNs sort after every number.
+ */
+
+#include "args.h"
+#include "kernels.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INSERTION_SORT_MAX 16
+#define RADIX_SORT_MIN 256
+#define PARALLEL_SORT_MIN (1u << 16)
+
+#define LESS_PLAIN(x, y) ((x) < (y))
+#define LESS_FLOAT(x, y) ((x) < (y) || ((y) != (y) && (x) == (x)))
+
+static int depth_limit(size_t n)
+{
+    int depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+#define DEFINE_SORT(name, T, LESS)                                                          \
+    static void insertion_##name(T *a, size_t n)                                            \
+    {                                                                                       \
+        for (size_t i = 1; i < n; i++) {                                                    \
+            T v = a[i];                                                                     \
+            size_t j = i;                                                                   \
+            while (j > 0 && LESS(v, a[j - 1])) {                                            \
+                a[j] = a[j - 1];                                                            \
+                j--;                                                                        \
+            }                                                                               \
+            a[j] = v;                                                                       \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    static void sift_##name(T *a, size_t root, size_t n)                                    \
+    {                                                                                       \
+        for (;;) {                                                                          \
+            size_t child = 2 * root + 1;                                                    \
+            if (child >= n) return;                                                         \
+            if (child + 1 < n && LESS(a[child], a[child + 1])) child++;                     \
+            if (!LESS(a[root], a[child])) return;                                           \
+            T t = a[root];                                                                  \
+            a[root] = a[child];                                                             \
+            a[child] = t;                                                                   \
+            root = child;                                                                   \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    static void heapsort_##name(T *a, size_t n)                                             \
+    {                                                                                       \
+        for (size_t i = n / 2; i-- > 0;) sift_##name(a, i, n);                              \
+        for (size_t end = n; end-- > 1;) {                                                  \
+            T t = a[0];                                                                     \
+            a[0] = a[end];                                                                  \
+            a[end] = t;                                                                     \
+            sift_##name(a, 0, end);                                                         \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    /* Hoare partition around the median of first, middle and last. Returns p  \
+     * with 0 < p < n such that a[0..p) <= a[p..n). */                                       \
+    static size_t partition_##name(T *a, size_t n)                                          \
+    {                                                                                       \
+        size_t mid = (n - 1) / 2;                                                           \
+        T t;                                                                                \
+        if (LESS(a[mid], a[0])) { t = a[mid]; a[mid] = a[0]; a[0] = t; }                    \
+        if (LESS(a[n - 1], a[mid])) {                                                       \
+            t = a[mid]; a[mid] = a[n - 1]; a[n - 1] = t;                                    \
+            if (LESS(a[mid], a[0])) { t = a[mid]; a[mid] = a[0]; a[0] = t; }                \
+        }                                                                                   \
+        T pivot = a[mid];                                                                   \
+        size_t i = 0, j = n - 1;                                                            \
+        for (;;) {                                                                          \
+            while (LESS(a[i], pivot)) i++;                                                  \
+            while (LESS(pivot, a[j])) j--;                                                  \
+            if (i >= j) return j + 1;                                                       \
+            t = a[i]; a[i] = a[j]; a[j] = t;                                                \
+            i++;                                                                            \
+            j--;                                                                            \
+        }                                                                                   \
+    }                                                                                       \
+                                                                                            \
+    static void introsort_##name(T *a, size_t n, int depth)                                 \
+    {                                                                                       \
+        while (n > INSERTION_SORT_MAX) {                                                    \
+            if (depth-- == 0) {                                                             \
+                heapsort_##name(a, n);                                                      \
+                return;                                                                     \
+            }                                                                               \
+            size_t p = partition_##name(a, n);                                              \
+            /* recurse into the smaller side, loop on the larger one */                     \
+            if (p < n - p) {                                                                \
+                introsort_##name(a, p, depth);                                              \
+                a += p;                                                                     \
+                n -= p;                                                                     \
+            } else {                                                                        \
+                introsort_##name(a + p, n - p, depth);                                      \
+                n = p;                                                                      \
+            }                                                                               \
+        }                                                                                   \
+        insertion_##name(a, n);                                                             \
+    }                                                                                       \
+                                                                                            \
+    /* Leaves the k-th smallest element at a[k], smaller ones before it and    \
+     * larger ones after it */                                                               \
+    static void nth_##name(T *a, size_t n, size_t k)                                        \
+    {                                                                                       \
+        int depth = depth_limit(n);                                                         \
+        while (n > INSERTION_SORT_MAX) {                                                    \
+            if (depth-- == 0) {                                                             \
+                heapsort_##name(a, n);                                                      \
+                return;                                                                     \
+            }                                                                               \
+            size_t p = partition_##name(a, n);                                              \
+            if (k < p) {                                                                    \
+                n = p;                                                                      \
+            } else {                                                                        \
+                a += p;                                                                     \
+                n -= p;                                                                     \
+                k -= p;                                                                     \
+            }                                                                               \
+        }                                                                                   \
+        insertion_##name(a, n);                                                             \
+    }                                                                                       \
+                                                                                            \
+    /* First index whose element is not less than v (upper: greater than v).                \
+     * Compares in double, so a fractional or out-of-range v is not rounded                 \
+     * into T first */                                                                      \
+    static size_t bound_##name(const T *a, size_t n, double v, bool upper)                  \
+    {                                                                                       \
+        size_t lo = 0, hi = n;                                                              \
+        while (lo < hi) {                                                                   \
+            size_t mid = lo + (hi - lo) / 2;                                                \
+            double x = a[mid];                                                              \
+            bool go_right = upper ? !LESS_FLOAT(v, x) : LESS_FLOAT(x, v);                   \
+            if (go_right) lo = mid + 1;                                                     \
+            else hi = mid;                                                                  \
+        }                                                                                   \
+        return lo;                                                                          \
+    }                                                                                       \
+                                                                                            \
+    static void merge_##name(const void *left, size_t nl, const void *right, size_t nr,     \
+                             void *out)                                                     \
+    {                                                                                       \
+        const T *l = left, *r = right;                                                      \
+        T *o = out;                                                                         \
+        size_t i = 0, j = 0;                                                                \
+        while (i < nl && j < nr) *o++ = LESS(r[j], l[i]) ? r[j++] : l[i++];                 \
+        while (i < nl) *o++ = l[i++];                                                       \
+        while (j < nr) *o++ = r[j++];                                                       \
+    }
+
+DEFINE_SORT(int, int, LESS_PLAIN)
+DEFINE_SORT(short, short, LESS_PLAIN)
+DEFINE_SORT(char, char, LESS_PLAIN)
+DEFINE_SORT(float, float, LESS_FLOAT)
+DEFINE_SORT(double, double, LESS_FLOAT)
+
+/* ── Radix and counting sort ─────────────────────────────────────────────── */
+
+/* LSD radix sort on BYTES 8-bit digits. Keys get their sign bit flipped so
+ * that they order as unsigned. */
+#define DEFINE_RADIX_SORT(name, T, U, BYTES)                                                \
+    static void radix_##name(T *a, size_t n)                                                \
+    {                                                                                       \
+        T *tmp = malloc(n * sizeof(T));                                                     \
+        if (!tmp) {                                                                         \
+            introsort_##name(a, n, depth_limit(n));                                         \
+            return;                                                                         \
+        }                                                                                   \
+        size_t counts[BYTES][256];                                                          \
+        const U flip = (U)1 << (BYTES * 8 - 1);                                             \
+        memset(counts, 0, sizeof(counts));                                                  \
+        for (size_t i = 0; i < n; i++) {                                                    \
+            U key = (U)a[i] ^ flip;                                                         \
+            for (int d = 0; d < BYTES; d++) counts[d][(key >> (8 * d)) & 0xff]++;           \
+        }                                                                                   \
+        T *src = a, *dst = tmp;                                                             \
+        for (int d = 0; d < BYTES; d++) {                                                   \
+            U first = (((U)src[0] ^ flip) >> (8 * d)) & 0xff;                               \
+            if (counts[d][first] == n) continue; /* every key has this digit */             \
+            size_t offset = 0;                                                              \
+            for (int b = 0; b < 256; b++) {                                                 \
+                size_t c = counts[d][b];                                                    \
+                counts[d][b] = offset;                                                      \
+                offset += c;                                                                \
+            }                                                                               \
+            for (size_t i = 0; i < n; i++) {                                                \
+                U key = (U)src[i] ^ flip;                                                   \
+                dst[counts[d][(key >> (8 * d)) & 0xff]++] = src[i];                         \
+            }                                                                               \
+            T *t = src;                                                                     \
+            src = dst;                                                                      \
+            dst = t;                                                                        \
+        }                                                                                   \
+        if (src != a) memcpy(a, src, n * sizeof(T));                                        \
+        free(tmp);                                                                          \
+    }
+
+DEFINE_RADIX_SORT(int, int, unsigned int, 4)
+DEFINE_RADIX_SORT(short, short, unsigned short, 2)
+
+static void counting_sort_char(char *a, size_t n)
+{
+    size_t counts[256] = {0};
+    for (size_t i = 0; i < n; i++) counts[(unsigned char)a[i]]++;
+
+    /* plain char may be signed: start from CHAR_MIN either way */
+    size_t pos = 0;
+    for (int c = CHAR_MIN; c <= CHAR_MAX; c++) {
+        size_t k = counts[(unsigned char)c];
+        memset(a + pos, c, k);
+        pos += k;
+    }
+}
+
+/* ── Dispatch ────────────────────────────────────────────────────────────── */
+
+static void sort_int(void *a, size_t n)
+{
+    if (n >= RADIX_SORT_MIN) radix_int(a, n);
+    else introsort_int(a, n, depth_limit(n));
+}
+
+static void sort_short(void *a, size_t n)
+{
+    if (n >= RADIX_SORT_MIN) radix_short(a, n);
+    else introsort_short(a, n, depth_limit(n));
+}
+
+static void sort_char(void *a, size_t n)
+{
+    if (n >= RADIX_SORT_MIN) counting_sort_char(a, n);
+    else introsort_char(a, n, depth_limit(n));
+}
+
+static void sort_float(void *a, size_t n)
+{
+    introsort_float(a, n, depth_limit(n));
+}
+
+static void sort_double(void *a, size_t n)
+{
+    introsort_double(a, n, depth_limit(n));
+}
+
+typedef struct {
+    void (*sort)(void *, size_t);
+    void (*merge)(const void *, size_t, const void *, size_t, void *);
+} SortOps;
+
+static SortOps sort_ops(StdrotArray arr)
+{
+    switch (arr.elem_type) {
+    case STDROT_INT:
+        if (arr.elem_size == sizeof(int)) return (SortOps){ sort_int, merge_int };
+        break;
+    case STDROT_SHORT:
+        if (arr.elem_size == sizeof(short)) return (SortOps){ sort_short, merge_short };
+        break;
+    case STDROT_CHAR:
+        return (SortOps){ sort_char, merge_char };
+    case STDROT_FLOAT:
+        return (SortOps){ sort_float, merge_float };
+    case STDROT_DOUBLE:
+        return (SortOps){ sort_double, merge_double };
+    default:
+        break;
+    }
+    stdrot_arg_error("only rizz, smol, chad, gigachad and yap arrays are supported");
+}
+
+typedef struct {
+    void (*sort)(void *, size_t);
+    char *base;
+    size_t n;
+} SortTask;
+
+static void *sort_thread(void *arg)
+{
+    SortTask *task = arg;
+    task->sort(task->base, task->n);
+    return NULL;
+}
+
+/* Sorts one chunk per thread, then merges neighbouring runs in rounds.
+ * Returns false (leaving `a` unsorted) when the scratch buffer or threads
+ * are unavailable. */
+static bool parallel_sort(char *a, size_t n, size_t size, SortOps ops, int thread_count)
+{
+    char *scratch = malloc(n * size);
+    if (!scratch) return false;
+
+    size_t run = (n + (size_t)thread_count - 1) / (size_t)thread_count;
+    SortTask tasks[STDROT_MAX_THREADS];
+    pthread_t threads[STDROT_MAX_THREADS];
+    int started = 0;
+
+    for (int t = 0; t < thread_count; t++) {
+        size_t begin = (size_t)t * run;
+        size_t count = begin >= n ? 0 : (n - begin < run ? n - begin : run);
+        tasks[t] = (SortTask){ ops.sort, a + begin * size, count };
+        if (count == 0) continue;
+        if (pthread_create(&threads[started], NULL, sort_thread, &tasks[t]) == 0) {
+            started++;
+        } else {
+            ops.sort(tasks[t].base, count);
+        }
+    }
+    for (int t = 0; t < started; t++) pthread_join(threads[t], NULL);
+
+    char *src = a, *dst = scratch;
+    for (; run < n; run *= 2) {
+        for (size_t begin = 0; begin < n; begin += 2 * run) {
+            size_t nl = n - begin < run ? n - begin : run;
+            size_t nr = n - begin - nl < run ? n - begin - nl : run;
+            ops.merge(src + begin * size, nl, src + (begin + nl) * size, nr, dst + begin * size);
+        }
+        char *t = src;
+        src = dst;
+        dst = t;
+    }
+    if (src != a) memcpy(a, src, n * size);
+    free(scratch);
+    return true;
+}
+
+/* ── Builtins ────────────────────────────────────────────────────────────── */
+
+/* array_sort(a[, start, count]) */
+static StdrotValue stdrot_array_sort(StdrotValue *args, int argc)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, 0);
+    SortOps ops = sort_ops(arr);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 1, arr.length, arr.length, &start, &count);
+
+    char *base = (char *)arr.data + start * arr.elem_size;
+    int threads = count >= PARALLEL_SORT_MIN ? stdrot_thread_count() : 1;
+    if (threads < 2 || !parallel_sort(base, count, arr.elem_size, ops, threads)) {
+        ops.sort(base, count);
+    }
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+static StdrotValue element_at(StdrotArray arr, size_t index)
+{
+    StdrotValue out = {arr.elem_type, {0}};
+    switch (arr.elem_type) {
+    case STDROT_INT:    out.val.i = ((const int *)arr.data)[index];    break;
+    case STDROT_SHORT:  out.val.s = ((const short *)arr.data)[index];  break;
+    case STDROT_CHAR:   out.val.c = ((const char *)arr.data)[index];   break;
+    case STDROT_FLOAT:  out.val.f = ((const float *)arr.data)[index];  break;
+    case STDROT_DOUBLE: out.val.d = ((const double *)arr.data)[index]; break;
+    default:            out.type = STDROT_NONE;                        break;
+    }
+    return out;
+}
+
+/* array_nth(a, k[, start, count]): partially sorts the range so that a[k]
+ * holds the value it would hold if the range were sorted, and returns it */
+static StdrotValue stdrot_array_nth(StdrotValue *args, int argc)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, 0);
+    sort_ops(arr); /* type check */
+    long k = stdrot_arg_integer(args, argc, 1);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 2, arr.length, arr.length, &start, &count);
+    if (k < (long)start || (size_t)k >= start + count) stdrot_arg_error("index is outside the range");
+
+    size_t rel = (size_t)k - start;
+    switch (arr.elem_type) {
+    case STDROT_INT:    nth_int((int *)arr.data + start, count, rel);       break;
+    case STDROT_SHORT:  nth_short((short *)arr.data + start, count, rel);   break;
+    case STDROT_CHAR:   nth_char((char *)arr.data + start, count, rel);     break;
+    case STDROT_FLOAT:  nth_float((float *)arr.data + start, count, rel);   break;
+    default:            nth_double((double *)arr.data + start, count, rel); break;
+    }
+    return element_at(arr, (size_t)k);
+}
+
+/* Index (into the whole array) of the first element in a sorted range that
+ * is not less than (upper: greater than) the value */
+static StdrotValue array_bound(StdrotValue *args, int argc, bool upper)
+{
+    StdrotArray arr = stdrot_arg_array(args, argc, 0);
+    sort_ops(arr); /* type check */
+    double v = stdrot_arg_number(args, argc, 1);
+    size_t start, count;
+    stdrot_arg_range(args, argc, 2, arr.length, arr.length, &start, &count);
+
+    size_t index;
+    switch (arr.elem_type) {
+    case STDROT_INT:
+        index = bound_int((const int *)arr.data + start, count, v, upper);
+        break;
+    case STDROT_SHORT:
+        index = bound_short((const short *)arr.data + start, count, v, upper);
+        break;
+    case STDROT_CHAR:
+        index = bound_char((const char *)arr.data + start, count, v, upper);
+        break;
+    case STDROT_FLOAT:
+        index = bound_float((const float *)arr.data + start, count, v, upper);
+        break;
+    default:
+        index = bound_double((const double *)arr.data + start, count, v, upper);
+        break;
+    }
+    return (StdrotValue){STDROT_INT, {.i = (int)(start + index)}};
+}
+
+/* array_lower_bound(a, value[, start, count]) */
+static StdrotValue stdrot_array_lower_bound(StdrotValue *args, int argc)
+{
+    return array_bound(args, argc, false);
+}
+
+/* array_upper_bound(a, value[, start, count]) */
+static StdrotValue stdrot_array_upper_bound(StdrotValue *args, int argc)
+{
+    return array_bound(args, argc, true);
+}
+
+STDROT_EXPORT("array_sort", stdrot_array_sort);
+STDROT_EXPORT_FLAGS("array_nth", stdrot_array_nth, STDROT_RETURNS_ELEM);
+STDROT_EXPORT_FLAGS("array_lower_bound", stdrot_array_lower_bound, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("array_upper_bound", stdrot_array_upper_bound, STDROT_RETURNS(STDROT_INT));
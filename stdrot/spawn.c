@@ -0,0 +1,57 @@
+/* stdrot/spawn.c – Task and channel builtins for libstdrot.so
+ *
+ *     task_spawn("fn", args...)  runs fn(args...) as a task, returns its handle
+ *     task_join(task)            waits for the task, returns fn's bussin value
+ *     chan_new(capacity)         a channel holding up to capacity rizz
+ *     chan_send(chan, value)     waits while the channel is full
+ *     chan_recv(chan)            waits while the channel is empty
+ *
+ * The scheduler lives in the main binary (tasks.c); these only check their
+ * arguments and hand over.
+ */
+
+#include "stdrot_api.h"
+#include "args.h"
+#include <string.h>
+
+static int arg_int(const StdrotValue *args, int argc, int index)
+{
+    return (int)stdrot_arg_integer(args, argc, index);
+}
+
+static StdrotValue stdrot_task_spawn_builtin(StdrotValue *args, int argc)
+{
+    String name;
+    if (argc < 1 || !stdrot_as_string(&args[0], &name)) {
+        stdrot_arg_error("expected the name of a function");
+    }
+    if (args[0].type == STDROT_ARRAY) name.len = strnlen(name.data, name.len);
+    return (StdrotValue){STDROT_INT, {.i = stdrot_task_spawn(name, args + 1, argc - 1)}};
+}
+
+static StdrotValue stdrot_task_join_builtin(StdrotValue *args, int argc)
+{
+    return (StdrotValue){STDROT_INT, {.i = stdrot_task_join(arg_int(args, argc, 0))}};
+}
+
+static StdrotValue stdrot_chan_new(StdrotValue *args, int argc)
+{
+    return (StdrotValue){STDROT_INT, {.i = stdrot_channel_new(arg_int(args, argc, 0))}};
+}
+
+static StdrotValue stdrot_chan_send(StdrotValue *args, int argc)
+{
+    stdrot_channel_send(arg_int(args, argc, 0), arg_int(args, argc, 1));
+    return (StdrotValue){STDROT_NONE, {0}};
+}
+
+static StdrotValue stdrot_chan_recv(StdrotValue *args, int argc)
+{
+    return (StdrotValue){STDROT_INT, {.i = stdrot_channel_recv(arg_int(args, argc, 0))}};
+}
+
+STDROT_EXPORT_FLAGS("task_spawn", stdrot_task_spawn_builtin, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("task_join", stdrot_task_join_builtin, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT_FLAGS("chan_new", stdrot_chan_new, STDROT_RETURNS(STDROT_INT));
+STDROT_EXPORT("chan_send", stdrot_chan_send);
+STDROT_EXPORT_FLAGS("chan_recv", stdrot_chan_recv, STDROT_TAKES_HANDLE | STDROT_RETURNS(STDROT_INT));
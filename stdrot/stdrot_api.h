@@ -20,6 +20,10 @@
  *   The interpreter discovers it automatically on the next run.
  *   No changes to stdrot.c, stdrot.h, or any other main-binary file needed.
  *
+ *   Functions whose first argument is a yapping-style format string use
+ *   STDROT_EXPORT_FLAGS("myfunc", stdrot_myfunc, STDROT_TAKES_FORMAT) so the
+ *   host hands them a precompiled STDROT_FORMAT when the format is a literal.
+ *
  * Builtins and extensions are all exposed through the same generic
  * StdrotFn signature, so the host does not hardcode function names.
  */
@@ -30,18 +34,47 @@
 #include "../lib/string_value.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
 
-/* ── Global execution context ──────────────────────────────────────────── *
+/* ── Execution context ─────────────────────────────────────────────────── *
  * Set by the main binary before calling stdlib functions
  * Allows functions to report line numbers and context
+ *
+ * Every running program has its own context, and g_exec_context names the
+ * one of the program running on the calling thread. Builtins that keep
+ * objects alive between calls hang them off `handles`, so programs running
+ * side by side never see each other's objects.
+ *
+ * Builtins print to `out`, report errors to `err` and read through `read`,
+ * never to stdout or stderr or from stdin directly: a program embedded with
+ * br_run() may have its own I/O.
  */
 typedef struct {
     int line_number;
     String function_name;
     String condition_text;
+    void *handles; /* owned by the library, see stdrot_release() */
+    FILE *out;     /* program output */
+    FILE *err;     /* diagnostics: errors, failed bets, baka */
+    /* Program input, NULL for fd 0: fills buf with up to size bytes and
+     * returns how many, 0 at the end of the input */
+    size_t (*read)(void *data, char *buf, size_t size);
+    void *read_data;
+    void *input;   /* owned by the library, see stdrot_release() */
 } ExecutionContext;
 
-extern ExecutionContext g_exec_context;
+ExecutionContext *stdrot_exec_context(void);
+#define g_exec_context (*stdrot_exec_context())
+
+/* Implemented by the library: destroys what it keeps in ctx (the objects
+ * behind handles, the input buffer). The main binary calls it when a
+ * program finishes. */
+void stdrot_release(ExecutionContext *ctx);
+
+/* Implemented by the main binary: ends the running program with status.
+ * Builtins call it instead of exit(), so a host that embeds the
+ * interpreter gets control back. */
+__attribute__((noreturn)) void stdrot_exit(int status);
 
 /* ── Pre-evaluated argument / return value ──────────────────────────────── */
 
@@ -53,9 +86,39 @@ typedef enum {
     STDROT_BOOL,
     STDROT_CHAR,
     STDROT_STRING,
+    STDROT_FORMAT, /* precompiled format string, see below */
+    STDROT_ARRAY,  /* borrowed brainrot array, see StdrotArray */
     STDROT_NONE   /* void return */
 } StdrotType;
 
+struct StdrotFormat;
+
+/* A brainrot array passed by reference: `data` points at the variable's own
+ * storage, so writes are visible to the program. elem_size is the real
+ * element width (e.g. 8 for a `long rizz` array); check it before treating
+ * the data as elem_type. Multi-dimensional arrays are row-major, with
+ * dims[0] the outermost extent. `data` is aligned to 64 bytes. `data` and
+ * `dims` are borrowed from the variable and only valid for the duration of
+ * the call.
+ *
+ * Char arrays are passed this way too; use stdrot_as_string() to accept
+ * either one or a string literal wherever text is expected.
+ *
+ * Cap arrays are bit-packed: elem_type is STDROT_BOOL and elem_size is 0,
+ * and `data` is an array of uint64_t words holding element i in bit i % 64
+ * of word i / 64. Bits past `length` in the last word are always zero.
+ *
+ * Builtins exported with STDROT_TAKES_REF may also get a single variable or
+ * array element this way: rank 0, length 1 and no dims. */
+typedef struct {
+    StdrotType elem_type;
+    size_t elem_size;
+    void *data;
+    size_t length;     /* total number of elements */
+    const int *dims;   /* extent of each dimension */
+    int rank;          /* number of dimensions, >= 1 (0 for a reference) */
+} StdrotArray;
+
 typedef struct {
     StdrotType type;
     union {
@@ -66,9 +129,120 @@ typedef struct {
         bool   b;
         char   c;
         String str;
+        const struct StdrotFormat *fmt;
+        StdrotArray arr;
     } val;
 } StdrotValue;
 
+/* Views a STDROT_STRING or a char STDROT_ARRAY as a String. For arrays, len
+ * is the array length rather than the text length. Returns false otherwise. */
+static inline bool stdrot_as_string(const StdrotValue *v, String *out)
+{
+    if (v->type == STDROT_STRING && v->val.str.data) {
+        *out = v->val.str;
+        return true;
+    }
+    if (v->type == STDROT_ARRAY && v->val.arr.elem_type == STDROT_CHAR && v->val.arr.data) {
+        out->data = (char *)v->val.arr.data;
+        out->len = v->val.arr.length;
+        return true;
+    }
+    return false;
+}
+
+/* ── Tasks ───────────────────────────────────────────────────────────────── *
+ * Implemented by the main binary (tasks.c): tasks are green threads running
+ * a brainrot function, and channels are bounded queues of rizz between
+ * them. Handles start at 1 and work in every task of the program. A call
+ * that has to wait parks the calling task and lets others run; called
+ * outside of a task it blocks the thread. Misuse is reported and ends the
+ * program like a bad builtin argument.
+ */
+int stdrot_task_spawn(String function, const StdrotValue *args, int argc);
+int stdrot_task_join(int task);
+int stdrot_channel_new(int capacity);
+void stdrot_channel_send(int channel, int value);
+int stdrot_channel_recv(int channel);
+
+/* Waits for seconds */
+void stdrot_sleep(unsigned int seconds);
+
+/* Returns once fd has input, or is at its end */
+void stdrot_wait_readable(int fd);
+
+/* Every read of program input goes between these: the tasks of a program
+ * share its input, one reader at a time. begin returns the context whose
+ * read, read_data and input to use. Calls nest. */
+ExecutionContext *stdrot_input_begin(void);
+void stdrot_input_end(void);
+
+/* ── Calling brainrot functions ──────────────────────────────────────────── *
+ * Implemented by the main binary (parallel.c), for builtins that apply a
+ * brainrot function to many values. stdrot_parallel() runs chunk(data, i)
+ * for every i below chunks on the interpreter's thread pool, in no
+ * particular order, and returns once all of them have. Inside a chunk,
+ * stdrot_call() runs a function on that thread's own interpreter state.
+ * An error in a call ends the program once the chunks have stopped.
+ */
+typedef struct StdrotFunction StdrotFunction;
+
+/* The function called name. It must take argc numbers and return one, and
+ * be pure: no printing, builtins, salty variables or local arrays, in it or
+ * in the functions it calls. Misuse ends the program. */
+const StdrotFunction *stdrot_function(String name, int argc);
+
+/* Calls function with argc numbers, converted to its parameter types.
+ * Only valid inside a stdrot_parallel() chunk. */
+double stdrot_call(const StdrotFunction *function, const double *args, int argc);
+
+void stdrot_parallel(size_t chunks, void (*chunk)(void *data, size_t chunk), void *data);
+
+/* ── Precompiled format strings ──────────────────────────────────────────── *
+ * A yapping-style format string split into literal spans and typed
+ * conversions. The host compiles string-literal formats once, during
+ * semantic analysis, and passes them as a STDROT_FORMAT first argument to
+ * functions exported with STDROT_TAKES_FORMAT. Those functions must also
+ * accept a plain STDROT_STRING and compile it on the spot.
+ */
+typedef enum {
+    STDROT_FMT_LITERAL, /* copy text verbatim */
+    STDROT_FMT_INT,     /* d i o u x X */
+    STDROT_FMT_FLOAT,   /* f F e E g G a A */
+    STDROT_FMT_CHAR,    /* c */
+    STDROT_FMT_STRING,  /* s */
+    STDROT_FMT_BOOL,    /* b, prints W or L */
+    STDROT_FMT_SKIP     /* unknown conversion, consumes an argument */
+} StdrotFormatKind;
+
+/* StdrotFormatOp.flags */
+#define STDROT_FMT_LEFT    0x01 /* '-' */
+#define STDROT_FMT_ZERO    0x02 /* '0' */
+#define STDROT_FMT_SIGN    0x04 /* '+' or ' ' */
+#define STDROT_FMT_ALT     0x08 /* '#' */
+#define STDROT_FMT_COMPLEX 0x10 /* '*' or flags out of order: printf only */
+
+typedef struct {
+    StdrotFormatKind kind;
+    const char *text;   /* literal span, or the conversion as written */
+    size_t len;
+    char spec[24];      /* normalized printf conversion, e.g. "%.2f" */
+    char conv;          /* conversion character, 0 for literals */
+    unsigned char flags;
+    short width;        /* -1 when absent */
+    short precision;    /* -1 when absent */
+} StdrotFormatOp;
+
+typedef struct StdrotFormat {
+    const StdrotFormatOp *ops;
+    int op_count;
+    int arg_count;      /* conversions that consume an argument */
+} StdrotFormat;
+
+/* Compiles fmt into at most `capacity` ops and returns how many it needs;
+ * call again with a larger array if that exceeds capacity. Literal ops
+ * point into fmt, so it must outlive the result. */
+int stdrot_format_compile(String fmt, StdrotFormatOp *ops, int capacity, int *arg_count);
+
 /* ── Generic extensible function signature ──────────────────────────────── *
  * The main binary evaluates every AST argument into a StdrotValue before
  * calling this, so the .so never needs to touch ASTNode or interpreter types.
@@ -86,8 +260,34 @@ typedef StdrotValue (*StdrotFn)(StdrotValue *args, int argc);
 typedef struct {
     const char *name;
     StdrotFn    fn;
+    unsigned    flags;  /* STDROT_TAKES_FORMAT, STDROT_RETURNS(...), ... */
 } StdrotEntry;
 
+#define STDROT_TAKES_FORMAT 0x1u /* first argument is a yapping-style format */
+
+/* STDROT_TAKES_REF: when the first argument is a plain variable or an array
+ * element, the builtin gets it by reference, as a StdrotArray of rank 0
+ * and length 1 whose data points at the variable (a whole array is still
+ * passed as usual). The host never writes the result back into it.
+ *
+ * STDROT_THREAD_SAFE: the builtin may run on several threads at once on
+ * the same objects, so squad flex bodies may call it. */
+#define STDROT_TAKES_REF    0x4u
+#define STDROT_THREAD_SAFE  0x8u
+
+/* STDROT_TAKES_HANDLE: the first argument is a handle (a map, deque, task
+ * ...) that the builtin only uses, so the host never writes the result back
+ * into it when the call is a statement, as in `map_remove(m, k);`. */
+#define STDROT_TAKES_HANDLE 0x10u
+
+/* Builtins that yield a value usable inside expressions declare its type,
+ * e.g. STDROT_EXPORT_FLAGS("array_argmax", fn, STDROT_RETURNS(STDROT_INT)).
+ * STDROT_RETURNS_ELEM yields an element of the first argument's array.
+ * Builtins without either flag can only be called as statements. */
+#define STDROT_RETURNS_ELEM       0x2u
+#define STDROT_RETURNS(type)      (((unsigned)(type) + 1u) << 8)
+#define STDROT_RETURN_TYPE(flags) ((int)(((flags) >> 8) & 0xffu) - 1) /* -1 if none */
+
 /* ── Self-registration via linker section ────────────────────────────────── *
  * STDROT_EXPORT(name, fn) places the function descriptor into a special
  * linker section. The library startup code collects all entries automatically.
@@ -99,9 +299,11 @@ typedef struct {
 #if defined(__GNUC__) || defined(__clang__)
     #define STDROT_CONCAT_IMPL(x, y) x##y
     #define STDROT_CONCAT(x, y) STDROT_CONCAT_IMPL(x, y)
-    #define STDROT_EXPORT(name_str, func_ptr) \
-        __attribute__((used, section("stdrot_exports"))) \
-        static const StdrotEntry STDROT_CONCAT(__stdrot_export_, __LINE__) = { name_str, func_ptr }
+    /* aligned() keeps the compiler from padding entries apart in the section */
+    #define STDROT_EXPORT_FLAGS(name_str, func_ptr, entry_flags) \
+        __attribute__((used, section("stdrot_exports"), aligned(__alignof__(StdrotEntry)))) \
+        static const StdrotEntry STDROT_CONCAT(__stdrot_export_, __LINE__) = { name_str, func_ptr, entry_flags }
+    #define STDROT_EXPORT(name_str, func_ptr) STDROT_EXPORT_FLAGS(name_str, func_ptr, 0)
 #else
     #error "Linker sections not supported on this compiler. Add registry.c fallback."
 #endif
@@ -0,0 +1,831 @@
+/* tasks.c – Green-thread tasks and channels, see tasks.h */
+
+#include "tasks.h"
+#include "interpreter.h"
+#include "stdrot.h"
+#include "lib/coro.h"
+#include "lib/pool.h"
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* How often a task waiting in slorp looks for input again */
+#define INPUT_POLL_NS 5000000L
+/* Stack a task must have left to call a function: more than the deepest
+ * the interpreter goes between two calls */
+#define TASK_STACK_MARGIN ((size_t)256 << 10)
+
+typedef struct Task Task;
+
+/* Someone waiting in wait_on(): a task, which parks, or a thread that is
+ * not a task (main), which sleeps on the group's condition variable */
+typedef struct Waiter {
+    Task *task;
+    bool woken;
+    struct Waiter *next;
+} Waiter;
+
+typedef struct {
+    Waiter *head;
+} WaitQueue;
+
+struct Task {
+    TaskGroup *group;
+    Function *function;
+    Runtime *runtime;
+    Coro *coro;                 /* NULL until a worker starts the task */
+    bool done;
+    int result;                 /* bussin value, as a rizz */
+    WaitQueue joiners;
+    struct timespec wake_at;    /* while in chill */
+    Task *next;                 /* in a worker's queue or sleeping list */
+    int worker;                 /* the one that started it */
+    int argc;
+    Value args[];
+};
+
+typedef struct {
+    int *values;
+    int capacity, head, count;
+    WaitQueue senders, receivers;
+} Channel;
+
+/* The tasks and channels of one program. A single lock guards all of it. */
+struct TaskGroup {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;   /* threads in wait_on() */
+    Runtime *root;         /* main's runtime; its input is every task's */
+    Task **tasks;          /* by handle - 1 */
+    int task_count, task_capacity;
+    Channel **channels;    /* by handle - 1 */
+    int channel_count, channel_capacity;
+    int live;              /* tasks that have not finished */
+    int waiting;           /* main and tasks in wait_on() */
+    WaitQueue finished;    /* main, in tasks_finish() */
+    WaitQueue input;       /* readers waiting for the input */
+    Task *input_owner;     /* the reader, NULL for main */
+    int input_depth;       /* its nested stdrot_input_begin() calls */
+    bool cancelled;        /* set atomically: workers also read it unlocked */
+    int status;            /* exit status, once cancelled */
+};
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    Task *fresh_head, *fresh_tail; /* not started yet: any worker may take these */
+    Task *ready_head, *ready_tail; /* started here and runnable again */
+    bool idle;                     /* waiting on wake */
+    Task *sleeping;                /* in chill, by wake_at; only the worker touches it */
+} Worker;
+
+static struct {
+    pthread_mutex_t lock; /* guards starting the workers */
+    atomic_int count;
+    atomic_uint next;     /* where the next spawn from outside a task goes */
+    atomic_int fresh;     /* tasks waiting to be started, on any worker */
+    Worker workers[POOL_MAX_THREADS];
+} scheduler = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static _Thread_local Worker *this_worker;
+static _Thread_local Task *this_task;
+
+/* Reports a misused task builtin the way stdrot/args.c does */
+__attribute__((noreturn)) static void task_error(const char *message)
+{
+    ExecutionContext *ctx = &current_runtime->exec_context;
+    fprintf(ctx->err, "Error: %s: %s at line %d\n",
+            ctx->function_name.data ? ctx->function_name.data : "builtin",
+            message, ctx->line_number);
+    runtime_exit(EXIT_FAILURE);
+}
+
+/* Same, with group->lock held */
+__attribute__((noreturn)) static void group_error(TaskGroup *group, const char *message)
+{
+    pthread_mutex_unlock(&group->lock);
+    task_error(message);
+}
+
+/* ── Workers ─────────────────────────────────────────────────────────────── */
+
+static void push(Task **head, Task **tail, Task *task)
+{
+    task->next = NULL;
+    if (*tail)
+        (*tail)->next = task;
+    else
+        *head = task;
+    *tail = task;
+}
+
+static Task *pop(Task **head, Task **tail)
+{
+    Task *task = *head;
+    if (task) {
+        *head = task->next;
+        if (!*head)
+            *tail = NULL;
+    }
+    return task;
+}
+
+/* Queues a started task on its worker again; callers hold its group's lock */
+static void make_ready(Task *task)
+{
+    Worker *worker = &scheduler.workers[task->worker];
+    pthread_mutex_lock(&worker->lock);
+    push(&worker->ready_head, &worker->ready_tail, task);
+    if (worker->idle)
+        pthread_cond_signal(&worker->wake);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+/* Wakes idle workers, starting with first: all of them, or just one */
+static void wake_idle(Worker *first, bool all)
+{
+    int count = atomic_load(&scheduler.count);
+    int start = first ? (int)(first - scheduler.workers) : 0;
+    for (int i = 0; i < count; i++) {
+        Worker *worker = &scheduler.workers[(start + i) % count];
+        pthread_mutex_lock(&worker->lock);
+        bool idle = worker->idle;
+        if (idle)
+            pthread_cond_signal(&worker->wake);
+        pthread_mutex_unlock(&worker->lock);
+        if (idle && !all)
+            return;
+    }
+}
+
+static void schedule_fresh(Task *task)
+{
+    Worker *worker = this_worker;
+    if (!worker)
+        worker = &scheduler.workers[atomic_fetch_add(&scheduler.next, 1) % (unsigned)atomic_load(&scheduler.count)];
+    pthread_mutex_lock(&worker->lock);
+    push(&worker->fresh_head, &worker->fresh_tail, task);
+    pthread_mutex_unlock(&worker->lock);
+    atomic_fetch_add(&scheduler.fresh, 1);
+    /* Its worker may be busy for a while, so any idle one will do */
+    wake_idle(worker, false);
+}
+
+static Task *steal(Worker *thief)
+{
+    int count = atomic_load(&scheduler.count);
+    for (int i = 0; i < count; i++) {
+        Worker *victim = &scheduler.workers[i];
+        if (victim == thief)
+            continue;
+        pthread_mutex_lock(&victim->lock);
+        Task *task = pop(&victim->fresh_head, &victim->fresh_tail);
+        pthread_mutex_unlock(&victim->lock);
+        if (task)
+            return task;
+    }
+    return NULL;
+}
+
+static bool before(const struct timespec *a, const struct timespec *b)
+{
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+/* The next task for worker to run, waiting for one if need be */
+static Task *next_task(Worker *worker)
+{
+    for (;;) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        for (Task **link = &worker->sleeping; *link; link = &(*link)->next) {
+            Task *sleeper = *link;
+            if (!before(&now, &sleeper->wake_at) || __atomic_load_n(&sleeper->group->cancelled, __ATOMIC_RELAXED)) {
+                *link = sleeper->next;
+                return sleeper;
+            }
+        }
+
+        pthread_mutex_lock(&worker->lock);
+        Task *task = pop(&worker->ready_head, &worker->ready_tail);
+        if (!task) {
+            task = pop(&worker->fresh_head, &worker->fresh_tail);
+            if (task)
+                atomic_fetch_sub(&scheduler.fresh, 1);
+        }
+        pthread_mutex_unlock(&worker->lock);
+        if (task)
+            return task;
+
+        task = steal(worker);
+        if (task) {
+            atomic_fetch_sub(&scheduler.fresh, 1);
+            return task;
+        }
+
+        pthread_mutex_lock(&worker->lock);
+        worker->idle = true;
+        /* A spawn that missed us while we were stealing left fresh above 0 */
+        if (!worker->ready_head && !worker->fresh_head && atomic_load(&scheduler.fresh) == 0) {
+            if (worker->sleeping)
+                pthread_cond_timedwait(&worker->wake, &worker->lock, &worker->sleeping->wake_at);
+            else
+                pthread_cond_wait(&worker->wake, &worker->lock);
+        }
+        worker->idle = false;
+        pthread_mutex_unlock(&worker->lock);
+    }
+}
+
+static void task_main(void *arg);
+static void finish_task(Task *task);
+static void cancel(TaskGroup *group, int status);
+
+static void run_task(Worker *worker, Task *task)
+{
+    if (!task->coro) {
+        task->worker = (int)(worker - scheduler.workers);
+        task->coro = coro_new(task_main, task);
+        if (!task->coro) {
+            fprintf(stderr, "Error: Failed to allocate memory for task\n");
+            pthread_mutex_lock(&task->group->lock);
+            cancel(task->group, EXIT_FAILURE);
+            pthread_mutex_unlock(&task->group->lock);
+            runtime_task_free(task->runtime);
+            finish_task(task);
+            return;
+        }
+    }
+
+    this_task = task;
+    current_runtime = task->runtime;
+    bool running = coro_resume(task->coro);
+    current_runtime = NULL;
+    this_task = NULL;
+
+    if (!running) {
+        coro_free(task->coro);
+        finish_task(task);
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    Worker *worker = arg;
+    this_worker = worker;
+    for (;;) {
+        run_task(worker, next_task(worker));
+    }
+    return NULL;
+}
+
+static void fork_prepare(void)
+{
+    pthread_mutex_lock(&scheduler.lock);
+}
+
+static void fork_parent(void)
+{
+    pthread_mutex_unlock(&scheduler.lock);
+}
+
+/* The workers are not copied into a child process: forget them, and the
+ * parent's tasks queued on them, so the child starts workers of its own */
+static void fork_child(void)
+{
+    atomic_store(&scheduler.count, 0);
+    atomic_store(&scheduler.next, 0);
+    atomic_store(&scheduler.fresh, 0);
+    memset(scheduler.workers, 0, sizeof scheduler.workers);
+    this_worker = NULL;
+    this_task = NULL;
+    pthread_mutex_init(&scheduler.lock, NULL);
+}
+
+/* Starts the workers the first time a task is spawned; they then stay for
+ * the rest of the process */
+static void start_workers(void)
+{
+    static bool forks_handled;
+    pthread_mutex_lock(&scheduler.lock);
+    if (!forks_handled) {
+        pthread_atfork(fork_prepare, fork_parent, fork_child);
+        forks_handled = true;
+    }
+    if (atomic_load(&scheduler.count) == 0) {
+        int wanted = pool_size();
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        for (int i = 0; i < wanted; i++) {
+            pthread_mutex_init(&scheduler.workers[i].lock, NULL);
+            pthread_cond_init(&scheduler.workers[i].wake, &attr);
+        }
+        pthread_condattr_destroy(&attr);
+
+        /* Workers look at the others as soon as they start; one that could
+         * not be started is simply never given anything */
+        atomic_store(&scheduler.count, wanted);
+        for (int i = 0; i < wanted; i++) {
+            pthread_t thread;
+            pthread_attr_t thread_attr;
+            pthread_attr_init(&thread_attr);
+            pthread_attr_setdetachstate(&thread_attr, PTHREAD_CREATE_DETACHED);
+            int failed = pthread_create(&thread, &thread_attr, worker_main, &scheduler.workers[i]);
+            pthread_attr_destroy(&thread_attr);
+            if (failed) {
+                atomic_store(&scheduler.count, i);
+                break;
+            }
+        }
+    }
+    int count = atomic_load(&scheduler.count);
+    pthread_mutex_unlock(&scheduler.lock);
+    if (count == 0)
+        task_error("cannot start the task workers");
+}
+
+/* ── Waiting ─────────────────────────────────────────────────────────────── */
+
+/* Wakes everyone waiting on q; group->lock is held */
+static void wake_all(TaskGroup *group, WaitQueue *q)
+{
+    bool threads = false;
+    for (Waiter *waiter = q->head; waiter; waiter = waiter->next) {
+        waiter->woken = true;
+        group->waiting--;
+        if (waiter->task && waiter->task != this_task) /* not us, from check_deadlock() */
+            make_ready(waiter->task);
+        else
+            threads = true;
+    }
+    q->head = NULL;
+    if (threads)
+        pthread_cond_broadcast(&group->wake);
+}
+
+/* Every party is waiting, so none of them will wake another */
+static void check_deadlock(TaskGroup *group)
+{
+    if (group->waiting > 0 && group->waiting == group->live + 1 && !group->cancelled) {
+        fprintf(runtime_stderr(), "Error: deadlock: main and every task are waiting on each other\n");
+        cancel(group, EXIT_FAILURE);
+    }
+}
+
+/* Waits on q until woken, with group->lock held throughout except while
+ * waiting. The caller checks again for whatever it waited for. */
+static void wait_on(TaskGroup *group, WaitQueue *q)
+{
+    Waiter waiter = { this_task, false, q->head };
+    q->head = &waiter;
+    group->waiting++;
+    check_deadlock(group);
+    if (waiter.woken)
+        return;
+
+    if (this_task) {
+        /* Whoever wakes us queues us on this worker, which cannot resume us
+         * before we have yielded, so the lock can go first */
+        pthread_mutex_unlock(&group->lock);
+        coro_yield();
+        pthread_mutex_lock(&group->lock);
+    } else {
+        while (!waiter.woken)
+            pthread_cond_wait(&group->wake, &group->lock);
+    }
+}
+
+/* Ends the calling task, or main, once the program has been cancelled;
+ * group->lock is held */
+static void check_cancelled(TaskGroup *group)
+{
+    if (group->cancelled) {
+        int status = group->status;
+        pthread_mutex_unlock(&group->lock);
+        runtime_exit(status);
+    }
+}
+
+/* Stops the program with status; group->lock is held */
+static void cancel(TaskGroup *group, int status)
+{
+    if (group->cancelled)
+        return;
+    group->status = status;
+    __atomic_store_n(&group->cancelled, true, __ATOMIC_RELAXED);
+    for (int i = 0; i < group->task_count; i++)
+        wake_all(group, &group->tasks[i]->joiners);
+    for (int i = 0; i < group->channel_count; i++) {
+        wake_all(group, &group->channels[i]->senders);
+        wake_all(group, &group->channels[i]->receivers);
+    }
+    wake_all(group, &group->input);
+    wake_all(group, &group->finished);
+    /* and the tasks in chill */
+    wake_idle(NULL, true);
+}
+
+/* Parks the running task until deadline, or until the program is cancelled */
+static void park_until(const struct timespec *deadline)
+{
+    Task *task = this_task;
+    Worker *worker = this_worker;
+    task->wake_at = *deadline;
+    Task **link = &worker->sleeping;
+    while (*link && !before(deadline, &(*link)->wake_at))
+        link = &(*link)->next;
+    task->next = *link;
+    *link = task;
+    coro_yield();
+}
+
+/* ── Tasks ───────────────────────────────────────────────────────────────── */
+
+static TaskGroup *current_group(void)
+{
+    if (!current_runtime->tasks) {
+        TaskGroup *group = calloc(1, sizeof(TaskGroup));
+        if (!group)
+            task_error("out of memory");
+        pthread_mutex_init(&group->lock, NULL);
+        pthread_cond_init(&group->wake, NULL);
+        group->root = current_runtime;
+        current_runtime->tasks = group;
+    }
+    return current_runtime->tasks;
+}
+
+static int return_as_rizz(const ReturnValue *ret)
+{
+    if (!ret->has_value || ret->pointer_level > 0)
+        return 0;
+    switch (ret->type) {
+    case VAR_INT:
+    case VAR_CHAR:
+        return ret->value.ivalue;
+    case VAR_SHORT:
+        return ret->value.svalue;
+    case VAR_BOOL:
+        return ret->value.bvalue;
+    case VAR_FLOAT:
+        return (int)ret->value.fvalue;
+    case VAR_DOUBLE:
+        return (int)ret->value.dvalue;
+    default:
+        return 0;
+    }
+}
+
+static void task_main(void *arg)
+{
+    Task *task = arg;
+    Runtime *runtime = task->runtime;
+    jmp_buf exit_jump;
+    Interpreter *volatile interp = NULL;
+    runtime->exit_jump = &exit_jump;
+    if (__atomic_load_n(&task->group->cancelled, __ATOMIC_RELAXED)) {
+        /* never got going */
+    } else if (setjmp(exit_jump) == 0) {
+        interp = interpreter_new();
+        runtime->interpreter = interp;
+        call_function_values(task->function, task->args, task->argc);
+        task->result = return_as_rizz(&runtime->return_value);
+    } else {
+        /* An error or a ragequit: the whole program stops */
+        pthread_mutex_lock(&task->group->lock);
+        cancel(task->group, runtime->exit_status);
+        pthread_mutex_unlock(&task->group->lock);
+    }
+    runtime->exit_jump = NULL;
+    runtime->interpreter = NULL;
+    interpreter_free(interp);
+    runtime_task_free(runtime);
+    task->runtime = NULL;
+}
+
+static void finish_task(Task *task)
+{
+    TaskGroup *group = task->group;
+    pthread_mutex_lock(&group->lock);
+    task->done = true;
+    task->coro = NULL;
+    group->live--;
+    wake_all(group, &task->joiners);
+    if (group->live == 0)
+        wake_all(group, &group->finished);
+    check_deadlock(group);
+    pthread_mutex_unlock(&group->lock);
+}
+
+/* Converts a task_spawn() argument for a parameter of type */
+static bool to_parameter(const StdrotValue *arg, const Parameter *param, Value *out)
+{
+    double number;
+    switch (arg->type) {
+    case STDROT_INT:    number = arg->val.i; break;
+    case STDROT_SHORT:  number = arg->val.s; break;
+    case STDROT_FLOAT:  number = arg->val.f; break;
+    case STDROT_DOUBLE: number = arg->val.d; break;
+    case STDROT_BOOL:   number = arg->val.b; break;
+    case STDROT_CHAR:   number = arg->val.c; break;
+    default:            return false;
+    }
+    if (param->pointer_level > 0)
+        return false;
+    switch (param->type) {
+    case VAR_INT:
+    case VAR_CHAR:
+        out->ivalue = arg->type == STDROT_INT ? arg->val.i : (int)number;
+        return true;
+    case VAR_SHORT:
+        out->svalue = (short)number;
+        return true;
+    case VAR_FLOAT:
+        out->fvalue = (float)number;
+        return true;
+    case VAR_DOUBLE:
+        out->dvalue = number;
+        return true;
+    case VAR_BOOL:
+        out->bvalue = number != 0;
+        return true;
+    default:
+        return false;
+    }
+}
+
+int stdrot_task_spawn(String function, const StdrotValue *args, int argc)
+{
+    Function *func = get_function(function);
+    if (!func)
+        task_error("no such function");
+    Parameter *params[MAX_ARGUMENTS];
+    if (function_parameters(func, params) != argc)
+        task_error("wrong number of arguments for the function");
+
+    Task *task = calloc(1, sizeof(Task) + (size_t)argc * sizeof(Value));
+    if (!task)
+        task_error("out of memory");
+    for (int i = 0; i < argc; i++) {
+        if (!to_parameter(&args[i], params[i], &task->args[i])) {
+            free(task);
+            task_error("task arguments must be numbers");
+        }
+    }
+    task->function = func;
+    task->argc = argc;
+
+    start_workers();
+    TaskGroup *group = current_group();
+    task->group = group;
+    task->runtime = runtime_task(current_runtime);
+    pthread_mutex_lock(&group->lock);
+    check_cancelled(group);
+    if (group->task_count == group->task_capacity) {
+        int capacity = group->task_capacity ? group->task_capacity * 2 : 16;
+        Task **grown = realloc(group->tasks, (size_t)capacity * sizeof(Task *));
+        if (!grown) {
+            runtime_task_free(task->runtime);
+            free(task);
+            group_error(group, "out of memory");
+        }
+        group->tasks = grown;
+        group->task_capacity = capacity;
+    }
+    group->tasks[group->task_count++] = task;
+    int handle = group->task_count;
+    group->live++;
+    pthread_mutex_unlock(&group->lock);
+
+    schedule_fresh(task);
+    return handle;
+}
+
+static Task *lookup_task(TaskGroup *group, int handle)
+{
+    if (handle < 1 || handle > group->task_count)
+        group_error(group, "invalid task handle");
+    return group->tasks[handle - 1];
+}
+
+int stdrot_task_join(int handle)
+{
+    TaskGroup *group = current_group();
+    pthread_mutex_lock(&group->lock);
+    Task *task = lookup_task(group, handle);
+    if (task == this_task)
+        group_error(group, "a task cannot join itself");
+    for (;;) {
+        check_cancelled(group);
+        if (task->done)
+            break;
+        wait_on(group, &task->joiners);
+    }
+    int result = task->result;
+    pthread_mutex_unlock(&group->lock);
+    return result;
+}
+
+int tasks_finish(Runtime *runtime, bool cancelled, int status)
+{
+    TaskGroup *group = runtime->tasks;
+    if (!group)
+        return status;
+
+    pthread_mutex_lock(&group->lock);
+    if (cancelled)
+        cancel(group, status);
+    while (group->live > 0)
+        wait_on(group, &group->finished);
+    if (group->cancelled)
+        status = group->status;
+    pthread_mutex_unlock(&group->lock);
+
+    for (int i = 0; i < group->task_count; i++)
+        free(group->tasks[i]);
+    for (int i = 0; i < group->channel_count; i++) {
+        free(group->channels[i]->values);
+        free(group->channels[i]);
+    }
+    free(group->tasks);
+    free(group->channels);
+    pthread_cond_destroy(&group->wake);
+    pthread_mutex_destroy(&group->lock);
+    free(group);
+    runtime->tasks = NULL;
+    return status;
+}
+
+/* ── Channels ────────────────────────────────────────────────────────────── */
+
+int stdrot_channel_new(int capacity)
+{
+    if (capacity < 1)
+        task_error("channel capacity must be at least 1");
+    Channel *channel = calloc(1, sizeof(Channel));
+    int *values = malloc((size_t)capacity * sizeof(int));
+    if (!channel || !values) {
+        free(channel);
+        free(values);
+        task_error("out of memory");
+    }
+    channel->values = values;
+    channel->capacity = capacity;
+
+    TaskGroup *group = current_group();
+    pthread_mutex_lock(&group->lock);
+    if (group->channel_count == group->channel_capacity) {
+        int grown_capacity = group->channel_capacity ? group->channel_capacity * 2 : 16;
+        Channel **grown = realloc(group->channels, (size_t)grown_capacity * sizeof(Channel *));
+        if (!grown) {
+            free(values);
+            free(channel);
+            group_error(group, "out of memory");
+        }
+        group->channels = grown;
+        group->channel_capacity = grown_capacity;
+    }
+    group->channels[group->channel_count++] = channel;
+    int handle = group->channel_count;
+    pthread_mutex_unlock(&group->lock);
+    return handle;
+}
+
+static Channel *lookup_channel(TaskGroup *group, int handle)
+{
+    if (handle < 1 || handle > group->channel_count)
+        group_error(group, "invalid channel handle");
+    return group->channels[handle - 1];
+}
+
+void stdrot_channel_send(int handle, int value)
+{
+    TaskGroup *group = current_group();
+    pthread_mutex_lock(&group->lock);
+    Channel *channel = lookup_channel(group, handle);
+    for (;;) {
+        check_cancelled(group);
+        if (channel->count < channel->capacity)
+            break;
+        wait_on(group, &channel->senders);
+    }
+    channel->values[(channel->head + channel->count++) % channel->capacity] = value;
+    wake_all(group, &channel->receivers);
+    pthread_mutex_unlock(&group->lock);
+}
+
+int stdrot_channel_recv(int handle)
+{
+    TaskGroup *group = current_group();
+    pthread_mutex_lock(&group->lock);
+    Channel *channel = lookup_channel(group, handle);
+    for (;;) {
+        check_cancelled(group);
+        if (channel->count > 0)
+            break;
+        wait_on(group, &channel->receivers);
+    }
+    int value = channel->values[channel->head];
+    channel->head = (channel->head + 1) % channel->capacity;
+    channel->count--;
+    wake_all(group, &channel->senders);
+    pthread_mutex_unlock(&group->lock);
+    return value;
+}
+
+void tasks_check_cancelled(void)
+{
+    TaskGroup *group = current_runtime->tasks;
+    if (group && __atomic_load_n(&group->cancelled, __ATOMIC_RELAXED)) {
+        pthread_mutex_lock(&group->lock);
+        check_cancelled(group);
+        pthread_mutex_unlock(&group->lock);
+    }
+}
+
+void tasks_check_call(const char *function)
+{
+    tasks_check_cancelled();
+    if (this_task && coro_stack_left() < TASK_STACK_MARGIN) {
+        fprintf(current_runtime->exec_context.err,
+                "Error: %s: task stack overflow (raise BRAINROT_TASK_STACK)\n", function);
+        runtime_exit(EXIT_FAILURE);
+    }
+}
+
+/* ── chill and slorp ─────────────────────────────────────────────────────── */
+
+static void check_task_cancelled(void)
+{
+    TaskGroup *group = current_runtime->tasks;
+    pthread_mutex_lock(&group->lock);
+    check_cancelled(group);
+    pthread_mutex_unlock(&group->lock);
+}
+
+void stdrot_sleep(unsigned int seconds)
+{
+    if (!this_task) {
+        sleep(seconds);
+        return;
+    }
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += seconds;
+    park_until(&deadline);
+    check_task_cancelled();
+}
+
+void stdrot_wait_readable(int fd)
+{
+    if (!this_task)
+        return;
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    while (poll(&pfd, 1, 0) == 0) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += INPUT_POLL_NS;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        park_until(&deadline);
+        check_task_cancelled();
+    }
+}
+
+ExecutionContext *stdrot_input_begin(void)
+{
+    TaskGroup *group = current_runtime->tasks;
+    if (!group)
+        return &current_runtime->exec_context;
+
+    pthread_mutex_lock(&group->lock);
+    for (;;) {
+        check_cancelled(group);
+        if (group->input_depth == 0 || group->input_owner == this_task)
+            break;
+        wait_on(group, &group->input);
+    }
+    group->input_owner = this_task;
+    group->input_depth++;
+    pthread_mutex_unlock(&group->lock);
+    return &group->root->exec_context;
+}
+
+void stdrot_input_end(void)
+{
+    TaskGroup *group = current_runtime->tasks;
+    if (!group)
+        return;
+
+    pthread_mutex_lock(&group->lock);
+    if (group->input_depth > 0 && --group->input_depth == 0)
+        wake_all(group, &group->input);
+    pthread_mutex_unlock(&group->lock);
+}
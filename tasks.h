@@ -0,0 +1,73 @@
+/* tasks.h – Green-thread tasks and channels
+ *
+ *     rizz ch = chan_new(16);
+ *     rizz t = task_spawn("producer", ch, 1000);
+ *     rizz total = 0;
+ *     flex (rizz i = 0; i < 1000; i++) {
+ *         total = total + chan_recv(ch);
+ *     }
+ *     rizz sent = task_join(t);
+ *
+ * task_spawn() runs a function as a task: a coroutine with its own stack
+ * (as large as the main thread's, or BRAINROT_TASK_STACK MiB),
+ * scheduled in user space on a few worker threads (BRAINROT_THREADS, or one
+ * per CPU). A task that has to wait (task_join, chan_send on a full channel,
+ * chan_recv on an empty one, chill, slorp with no input yet) parks, and its
+ * worker runs another task meanwhile. main is not a task: it waits on a
+ * condition variable and the workers carry on without it.
+ *
+ * Every worker has its own queues. Tasks that have not started yet can be
+ * stolen by an idle worker; once a task has run it stays on its worker,
+ * since the interpreter keeps per-thread state that a task may hold on to
+ * across a switch.
+ *
+ * A task runs in a runtime of its own (see runtime_task()): salty
+ * variables, maps, deques and heaps belong to the task that made them.
+ * Task and channel handles belong to the program and work in any of its
+ * tasks. Values passed to a task, returned by task_join() and carried by
+ * channels are rizz; arguments are converted to the parameter types.
+ *
+ * An error or a ragequit in a task ends the program: every other task, and
+ * main, stops at its next task operation, loop iteration or function call. So does a deadlock, when main and
+ * every task are waiting on each other. The program finishes once main and
+ * all of its tasks have.
+ *
+ * The builtins live in stdrot/spawn.c and reach the scheduler through the
+ * stdrot_task_*() and stdrot_channel_*() functions of stdrot_api.h.
+ */
+
+#ifndef TASKS_H
+#define TASKS_H
+
+#include "ast.h"
+
+typedef struct TaskGroup TaskGroup;
+
+/* Called by br_run() once main has returned, or ended early when
+ * cancelled: waits for the program's tasks, stopping them first if
+ * cancelled, and frees them. Returns the exit status a failed task left,
+ * or status. */
+int tasks_finish(Runtime *runtime, bool cancelled, int status);
+
+/* Ends the calling task, or main, if its program has been cancelled. The
+ * interpreter checks at loop back-edges and function entry, so that a task
+ * that computes without ever waiting still stops. */
+void tasks_check_cancelled(void);
+
+#define TASKS_CHECK_CANCELLED()         \
+    do {                                \
+        if (current_runtime->tasks)     \
+            tasks_check_cancelled();    \
+    } while (0)
+
+/* tasks_check_cancelled(), and a runtime error if the calling task is
+ * about to run out of stack. Called on entry to function. */
+void tasks_check_call(const char *function);
+
+#define TASKS_CHECK_CALL(function)          \
+    do {                                    \
+        if (current_runtime->tasks)         \
+            tasks_check_call(function);     \
+    } while (0)
+
+#endif /* TASKS_H */
@@ -1,6 +1,7 @@
 import subprocess
 import json
 import os
+import time
 import pytest
 
 # Get the absolute path to the directory containing the script
@@ -13,25 +14,17 @@ file_path = os.path.join(script_dir, "expected_results.json")
 with open(file_path, "r") as file:
     expected_results = json.load(file)
 
+def input_command(example):
+    """Redirects test_cases/<example>.input, if there is one, to the command's stdin"""
+    input_path = os.path.abspath(os.path.join(script_dir, f"../test_cases/{example}.input"))
+    return f"< {input_path} " if os.path.exists(input_path) else ""
+
 @pytest.mark.parametrize("example,expected_output", expected_results.items())
 def test_brainrot_examples(example, expected_output):
     brainrot_path = os.path.abspath(os.path.join(script_dir, "../brainrot"))
     example_file_path = os.path.abspath(os.path.join(script_dir, f"../test_cases/{example}.brainrot"))
 
-    if example.startswith("slorp_int"):
-        command = f"echo '42' | {brainrot_path} {example_file_path}"
-    elif example.startswith("slorp_short"):
-        command = f"echo '69' | {brainrot_path} {example_file_path}"
-    elif example.startswith("slorp_float"):
-        command = f"echo '3.14' | {brainrot_path} {example_file_path}"
-    elif example.startswith("slorp_double"):
-        command = f"echo '3.141592' | {brainrot_path} {example_file_path}"
-    elif example.startswith("slorp_char"):
-        command = f"echo 'c' | {brainrot_path} {example_file_path}"
-    elif example.startswith("slorp_string"):
-        command = f"echo 'skibidi bop bop yes yes' | {brainrot_path} {example_file_path}"
-    else:
-        command = f"{brainrot_path} {example_file_path}"
+    command = f"{input_command(example)}{brainrot_path} {example_file_path}"
 
     result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, shell=True)
     actual_output = result.stdout.strip() if result.stdout.strip() else result.stderr.strip()
@@ -51,5 +44,88 @@ def test_brainrot_examples(example, expected_output):
             f"Stderr:\n{result.stderr}"
         )
 
+@pytest.fixture(scope="module")
+def server(tmp_path_factory):
+    brainrot_path = os.path.abspath(os.path.join(script_dir, "../brainrot"))
+    socket_path = str(tmp_path_factory.mktemp("serve") / "brainrot.sock")
+    process = subprocess.Popen([brainrot_path, "--serve", socket_path])
+    for _ in range(100):
+        if os.path.exists(socket_path):
+            break
+        time.sleep(0.05)
+    yield socket_path
+    process.terminate()
+    process.wait()
+    assert not os.path.exists(socket_path)
+
+# An example listed twice runs the program the server cached the first time;
+# tasks_channels runs isolated after the server has started its task workers
+@pytest.mark.parametrize("example,isolate", [
+    ("hello_world", False), ("hello_world", False), ("slorp_tokens", False),
+    ("tasks_channels", False), ("tasks_channels", True), ("slorp_tasks", True), ("squad_flex", False), ("bet_fail", True),
+    ("semantic_error_scope", False), ("semantic_error_scope", False),
+])
+def test_brainrot_server(server, example, isolate):
+    brainrot_path = os.path.abspath(os.path.join(script_dir, "../brainrot"))
+    example_file_path = os.path.abspath(os.path.join(script_dir, f"../test_cases/{example}.brainrot"))
+    client = f"{brainrot_path} --client {server}{' --isolate' if isolate else ''}"
+    command = f"{input_command(example)}{client} {example_file_path}"
+
+    result = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, shell=True)
+    actual_output = result.stdout.strip() if result.stdout.strip() else result.stderr.strip()
+    expected_output = expected_results[example]
+
+    assert actual_output == expected_output.strip()
+    assert (result.returncode != 0) == ("Error:" in expected_output)
+
+def test_brainrot_fork_server(tmp_path):
+    brainrot_path = os.path.abspath(os.path.join(script_dir, "../brainrot"))
+    example_file_path = os.path.abspath(os.path.join(script_dir, "../test_cases/slorp_int.brainrot"))
+    jobs = ""
+    for value in ["42", "-7", "1337"]:
+        (tmp_path / value).write_text(f"{value}\n")
+        jobs += f"{tmp_path / value}\t{tmp_path / value}.out\n"
+    jobs += f"{tmp_path / 'missing'}\t{tmp_path / 'missing'}.out\n"
+
+    result = subprocess.run([brainrot_path, "--fork-server", example_file_path], input=jobs,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+
+    assert result.returncode == 1
+    assert sorted(result.stdout.splitlines()) == sorted(
+        f"{0 if value != 'missing' else 1}\t{tmp_path / value}" for value in ["42", "-7", "1337", "missing"])
+    for value in ["42", "-7", "1337"]:
+        assert (tmp_path / f"{value}.out").read_text().strip() == f"You typed: {value}"
+
+def test_brainrot_batch(tmp_path):
+    brainrot_path = os.path.abspath(os.path.join(script_dir, "../brainrot"))
+
+    result = subprocess.run([brainrot_path, "--batch", file_path, "--threads=4"],
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    report = json.loads(result.stdout)
+    assert [case["name"] for case in report["cases"] if not case["passed"]] == []
+    assert report["tests"] == len(expected_results)
+    assert result.returncode == 0
+
+    manifest = tmp_path / "manifest.json"
+    manifest.write_text(json.dumps({"hello_world": "Hello, World!", "fib": "not fib", "slorp_int": "You typed: 42"}))
+    cases_dir = os.path.abspath(os.path.join(script_dir, "../test_cases"))
+    result = subprocess.run([brainrot_path, "--batch", str(manifest), f"--cases={cases_dir}", "--report=junit"],
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    assert result.returncode == 1
+    assert 'tests="3" failures="1"' in result.stdout
+    assert '<failure message="output did not match">' in result.stdout
+
+    # A case that never ends is killed and fails, and the others still run
+    (tmp_path / "spin.brainrot").write_text("skibidi main {\n    goon (1) {\n    }\n}\n")
+    (tmp_path / "hello_world.brainrot").write_text(
+        open(os.path.join(cases_dir, "hello_world.brainrot")).read())
+    manifest.write_text(json.dumps({"hello_world": "Hello, World!", "spin": ""}))
+    result = subprocess.run([brainrot_path, "--batch", str(manifest), f"--cases={tmp_path}", "--timeout=0.5"],
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    report = json.loads(result.stdout)
+    assert result.returncode == 1
+    assert [(case["name"], case["passed"], case.get("timed_out", False)) for case in report["cases"]] == [
+        ("hello_world", True, False), ("spin", False, True)]
+
 if __name__ == "__main__":
     pytest.main(["-v", os.path.abspath(__file__)])
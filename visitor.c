@@ -97,7 +97,7 @@ void ast_accept(ASTNode *node, Visitor *visitor) {
             
         case NODE_DECLARATION:
             // For declarations with side-effect operations on the right, skip auto-visit to prevent double evaluation
-            bool skip_decl_right_visit = false;
+            bool skip_decl_right_visit = visitor->evaluates_initializers;
             if (node->data.op.right && node->data.op.right->type == NODE_UNARY_OPERATION) {
                 OperatorType op = node->data.op.right->data.unary.op;
                 if (op == OP_POST_INC || op == OP_PRE_INC || op == OP_POST_DEC || op == OP_PRE_DEC) {
@@ -114,7 +114,7 @@ void ast_accept(ASTNode *node, Visitor *visitor) {
             
         case NODE_ASSIGNMENT:
             // For assignments with side-effect operations on the right, skip auto-visit to prevent double evaluation
-            bool skip_right_visit = false;
+            bool skip_right_visit = visitor->evaluates_initializers;
             if (node->data.op.right && node->data.op.right->type == NODE_UNARY_OPERATION) {
                 OperatorType op = node->data.op.right->data.unary.op;
                 if (op == OP_POST_INC || op == OP_PRE_INC || op == OP_POST_DEC || op == OP_PRE_DEC) {
@@ -167,7 +167,7 @@ void ast_accept(ASTNode *node, Visitor *visitor) {
             break;
             
         case NODE_RETURN:
-            if (node->data.op.left)
+            if (!visitor->evaluates_initializers && node->data.op.left)
                 ast_accept(node->data.op.left, visitor);
             if (visitor->visit_return_statement)
                 visitor->visit_return_statement(visitor, node);
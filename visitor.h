@@ -39,6 +39,11 @@ struct Visitor {
     void (*visit_statement_list)(Visitor *self, ASTNode *node);
     void (*visit_print_statement)(Visitor *self, ASTNode *node);
     void (*visit_error_statement)(Visitor *self, ASTNode *node);
+
+    /* visit_declaration/visit_assignment evaluate the right-hand side, and
+     * visit_return_statement its expression, themselves, so ast_accept must
+     * not visit it first (a call there would run twice) */
+    bool evaluates_initializers;
 };
 
 /* Generic AST traversal function */